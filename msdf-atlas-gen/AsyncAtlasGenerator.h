@@ -0,0 +1,97 @@
+
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include "GlyphBox.h"
+#include "GlyphGeometry.h"
+#include "AtlasGenerator.h"
+
+namespace msdf_atlas {
+
+/**
+ * An implementation of AtlasGenerator that uses the specified generator function
+ * and AtlasStorage class and generates glyph bitmaps asynchronously on a pool of background threads.
+ * The glyph boxes are registered in the layout immediately and generate returns without waiting
+ * for the bitmaps, whose completion can be observed via isReady, takeReadyGlyphs, or a ready callback.
+ * Intended to be used as the underlying generator of DynamicAtlas.
+ * The area of a glyph in the atlas storage must not be accessed before it is reported as ready.
+ * Resizing or rearranging the atlas waits for all pending glyphs to be finished first.
+ */
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+class AsyncAtlasGenerator {
+
+public:
+    /// A function called from a background thread when a glyph is finished, with its index in the layout
+    typedef std::function<void(int index, const GlyphBox &box)> ReadyCallback;
+
+    AsyncAtlasGenerator();
+    AsyncAtlasGenerator(int width, int height);
+    template <typename... ARGS>
+    AsyncAtlasGenerator(int width, int height, ARGS... storageArgs);
+    AsyncAtlasGenerator(AsyncAtlasGenerator &&orig);
+    ~AsyncAtlasGenerator();
+    AsyncAtlasGenerator &operator=(AsyncAtlasGenerator &&orig);
+    /// Adds the glyphs to the layout and schedules their bitmaps to be generated, does not wait for completion
+    void generate(const GlyphGeometry *glyphs, int count);
+    void rearrange(int width, int height, const Remap *remapping, int count);
+    void resize(int width, int height);
+    /// Waits until all scheduled glyphs are generated
+    void finish();
+    /// Sets attributes for the generator function, affects subsequently scheduled glyphs
+    void setAttributes(const GeneratorAttributes &attributes);
+    /// Sets the number of background threads
+    void setThreadCount(int threadCount);
+    /// Sets the function to be called when a glyph is finished. It is invoked from a background thread
+    void setReadyCallback(const ReadyCallback &callback);
+    /// Returns true if the glyph with the given index in the layout has been generated
+    bool isReady(int index) const;
+    /// Returns the number of glyphs that are scheduled but not yet generated
+    int getPendingCount() const;
+    /// Outputs the ready state of each glyph in the layout
+    void getReadyMask(std::vector<bool> &readyMask) const;
+    /// Appends the indices of glyphs finished since the previous call to output, returns their number
+    int takeReadyGlyphs(std::vector<int> &output);
+    /// Allows access to the underlying AtlasStorage
+    const AtlasStorage &atlasStorage() const;
+    /// Returns the layout of the contained glyphs as a list of GlyphBoxes
+    const std::vector<GlyphBox> &getLayout() const;
+
+private:
+    struct Job {
+        int index;
+        GlyphGeometry glyph;
+        GeneratorAttributes attributes;
+    };
+
+    AtlasStorage storage;
+    std::vector<GlyphBox> layout;
+    std::vector<bool> ready;
+    std::vector<int> readyQueue;
+    std::deque<Job> jobs;
+    int pending;
+    bool stopping;
+    GeneratorAttributes attributes;
+    ReadyCallback readyCallback;
+    int threadCount;
+    std::vector<std::thread> workers;
+    mutable std::mutex mutex;
+    std::condition_variable jobAvailable;
+    std::condition_variable jobsFinished;
+
+    void startWorkers();
+    void stopWorkers();
+    void workerMain();
+
+    AsyncAtlasGenerator(const AsyncAtlasGenerator &);
+    AsyncAtlasGenerator &operator=(const AsyncAtlasGenerator &);
+
+};
+
+}
+
+#include "AsyncAtlasGenerator.hpp"
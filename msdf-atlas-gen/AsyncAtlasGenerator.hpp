@@ -0,0 +1,235 @@
+
+#include "AsyncAtlasGenerator.h"
+
+#include <algorithm>
+#include "bitmap-blit.h"
+
+namespace msdf_atlas {
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage>::AsyncAtlasGenerator() : pending(0), stopping(false), threadCount(1) { }
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage>::AsyncAtlasGenerator(int width, int height) : storage(width, height), pending(0), stopping(false), threadCount(1) { }
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+template <typename... ARGS>
+AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage>::AsyncAtlasGenerator(int width, int height, ARGS... storageArgs) : storage(width, height, storageArgs...), pending(0), stopping(false), threadCount(1) { }
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage>::AsyncAtlasGenerator(AsyncAtlasGenerator &&orig) : pending(0), stopping(false), threadCount(orig.threadCount) {
+    orig.finish();
+    orig.stopWorkers();
+    storage = (AtlasStorage &&) orig.storage;
+    layout = (std::vector<GlyphBox> &&) orig.layout;
+    ready = (std::vector<bool> &&) orig.ready;
+    readyQueue = (std::vector<int> &&) orig.readyQueue;
+    attributes = orig.attributes;
+    readyCallback = (ReadyCallback &&) orig.readyCallback;
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage>::~AsyncAtlasGenerator() {
+    stopWorkers();
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage> &AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage>::operator=(AsyncAtlasGenerator &&orig) {
+    if (this != &orig) {
+        finish();
+        stopWorkers();
+        orig.finish();
+        orig.stopWorkers();
+        storage = (AtlasStorage &&) orig.storage;
+        layout = (std::vector<GlyphBox> &&) orig.layout;
+        ready = (std::vector<bool> &&) orig.ready;
+        readyQueue = (std::vector<int> &&) orig.readyQueue;
+        attributes = orig.attributes;
+        readyCallback = (ReadyCallback &&) orig.readyCallback;
+        threadCount = orig.threadCount;
+    }
+    return *this;
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage>::generate(const GlyphGeometry *glyphs, int count) {
+    if (count <= 0)
+        return;
+    if (workers.empty())
+        startWorkers();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        int index = (int) layout.size();
+        for (int i = 0; i < count; ++i, ++index) {
+            layout.push_back((GlyphBox) glyphs[i]);
+            if (glyphs[i].isWhitespace()) {
+                ready.push_back(true);
+                readyQueue.push_back(index);
+            } else {
+                ready.push_back(false);
+                Job job = { index, glyphs[i], attributes };
+                jobs.push_back((Job &&) job);
+                ++pending;
+            }
+        }
+    }
+    jobAvailable.notify_all();
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage>::rearrange(int width, int height, const Remap *remapping, int count) {
+    finish();
+    for (int i = 0; i < count; ++i) {
+        layout[remapping[i].index].rect.x = remapping[i].target.x;
+        layout[remapping[i].index].rect.y = remapping[i].target.y;
+    }
+    AtlasStorage newStorage((AtlasStorage &&) storage, width, height, remapping, count);
+    storage = (AtlasStorage &&) newStorage;
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage>::resize(int width, int height) {
+    finish();
+    AtlasStorage newStorage((AtlasStorage &&) storage, width, height);
+    storage = (AtlasStorage &&) newStorage;
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage>::finish() {
+    std::unique_lock<std::mutex> lock(mutex);
+    jobsFinished.wait(lock, [this]() -> bool {
+        return !pending;
+    });
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage>::setAttributes(const GeneratorAttributes &attributes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->attributes = attributes;
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage>::setThreadCount(int threadCount) {
+    if (threadCount != this->threadCount) {
+        finish();
+        stopWorkers();
+        this->threadCount = threadCount;
+    }
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage>::setReadyCallback(const ReadyCallback &callback) {
+    std::lock_guard<std::mutex> lock(mutex);
+    readyCallback = callback;
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+bool AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage>::isReady(int index) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return index >= 0 && index < (int) ready.size() && ready[index];
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+int AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage>::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending;
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage>::getReadyMask(std::vector<bool> &readyMask) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    readyMask = ready;
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+int AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage>::takeReadyGlyphs(std::vector<int> &output) {
+    std::lock_guard<std::mutex> lock(mutex);
+    int count = (int) readyQueue.size();
+    output.insert(output.end(), readyQueue.begin(), readyQueue.end());
+    readyQueue.clear();
+    return count;
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+const AtlasStorage &AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage>::atlasStorage() const {
+    return storage;
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+const std::vector<GlyphBox> &AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage>::getLayout() const {
+    return layout;
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage>::startWorkers() {
+    stopping = false;
+    int count = std::max(threadCount, 1);
+    workers.reserve(count);
+    for (int i = 0; i < count; ++i)
+        workers.emplace_back(&AsyncAtlasGenerator::workerMain, this);
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage>::stopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    jobAvailable.notify_all();
+    for (std::thread &worker : workers)
+        worker.join();
+    workers.clear();
+    // Abandon glyphs that have not been started
+    std::lock_guard<std::mutex> lock(mutex);
+    pending -= (int) jobs.size();
+    jobs.clear();
+    jobsFinished.notify_all();
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage>::workerMain() {
+    std::vector<T> glyphBuffer;
+    std::vector<byte> errorCorrectionBuffer;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        jobAvailable.wait(lock, [this]() -> bool {
+            return stopping || !jobs.empty();
+        });
+        if (stopping)
+            break;
+        Job job = (Job &&) jobs.front();
+        jobs.pop_front();
+        lock.unlock();
+
+        int l, b, w, h;
+        job.glyph.getBoxRect(l, b, w, h);
+        int bufferSize = (job.glyph.isBoxRotated() ? 2 : 1)*N*w*h;
+        if ((int) glyphBuffer.size() < bufferSize)
+            glyphBuffer.resize(bufferSize);
+        if ((int) errorCorrectionBuffer.size() < w*h)
+            errorCorrectionBuffer.resize(w*h);
+        job.attributes.config.errorCorrection.buffer = errorCorrectionBuffer.data();
+        msdfgen::BitmapRef<T, N> glyphBitmap(glyphBuffer.data(), w, h);
+        GEN_FN(glyphBitmap, job.glyph, job.attributes);
+        if (job.glyph.isBoxRotated()) {
+            msdfgen::BitmapRef<T, N> rotatedBitmap(glyphBuffer.data()+N*w*h, h, w);
+            blitRotated(rotatedBitmap, glyphBitmap);
+            storage.put(l, b, msdfgen::BitmapConstSection<T, N>(rotatedBitmap));
+        } else
+            storage.put(l, b, msdfgen::BitmapConstSection<T, N>(glyphBitmap));
+
+        lock.lock();
+        ready[job.index] = true;
+        readyQueue.push_back(job.index);
+        ReadyCallback callback = readyCallback;
+        GlyphBox box = layout[job.index];
+        lock.unlock();
+        if (callback)
+            callback(job.index, box);
+        lock.lock();
+        if (!--pending)
+            jobsFinished.notify_all();
+    }
+}
+
+}
@@ -33,6 +33,31 @@ public:
 struct GeneratorAttributes {
     msdfgen::MSDFGeneratorConfig config;
     bool scanlinePass = false;
+    /// Reduces post-processing (scanline pass, error correction) of each glyph according to its complexity (see classifyGlyphComplexity)
+    bool adaptiveQuality = false;
+    /// Computes distances only in tiles of the glyph's box which may be within range of its edges, others are filled with the saturated value (pseudo-distances there may differ from dense generation)
+    bool sparse = false;
+    /// Generates each tile of glyphs with many edges from only the edges that may affect it (see GlyphEdgeIndex), requires overlap support to be disabled
+    bool edgeIndex = false;
+    /// If not null, the generator function stores the time spent on error correction of the glyph (in seconds) into it
+    double *errorCorrectionTime = nullptr;
+    /// If not null and adaptiveQuality is enabled, the generator function stores the glyph's determined complexity into it
+    GlyphComplexity *complexity = nullptr;
+};
+
+/// Measurements of the generation of a single glyph (see ImmediateAtlasGenerator::setProfiling)
+struct GlyphProfile {
+    int index;
+    unicode_t codepoint;
+    int edgeCount;
+    /// Number of pixels of the glyph's box
+    int pixelCount;
+    /// Time spent generating the glyph in seconds, including error correction
+    double time;
+    /// Time spent on error correction in seconds (zero for types without error correction)
+    double errorCorrectionTime;
+    /// Complexity the glyph was generated with (always COMPLEX without adaptive quality)
+    GlyphComplexity complexity;
 };
 
 /// A function that generates the bitmap for a single glyph
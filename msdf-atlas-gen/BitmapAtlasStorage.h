@@ -12,6 +12,8 @@ class BitmapAtlasStorage {
 public:
     BitmapAtlasStorage();
     BitmapAtlasStorage(int width, int height);
+    /// Creates a storage of the given dimensions initialized with the contents of bitmap (cropped or padded with zeros)
+    BitmapAtlasStorage(int width, int height, const msdfgen::BitmapConstSection<T, N> &bitmap);
     explicit BitmapAtlasStorage(const msdfgen::BitmapConstSection<T, N> &bitmap);
     explicit BitmapAtlasStorage(msdfgen::Bitmap<T, N> &&bitmap);
     BitmapAtlasStorage(const BitmapAtlasStorage<T, N> &orig, int width, int height);
@@ -15,6 +15,12 @@ BitmapAtlasStorage<T, N>::BitmapAtlasStorage(int width, int height) : bitmap(wid
     memset((T *) bitmap, 0, sizeof(T)*N*width*height);
 }
 
+template <typename T, int N>
+BitmapAtlasStorage<T, N>::BitmapAtlasStorage(int width, int height, const msdfgen::BitmapConstSection<T, N> &bitmap) : bitmap(width, height) {
+    memset((T *) this->bitmap, 0, sizeof(T)*N*width*height);
+    blit(this->bitmap, bitmap, 0, 0, 0, 0, std::min(width, bitmap.width), std::min(height, bitmap.height));
+}
+
 template <typename T, int N>
 BitmapAtlasStorage<T, N>::BitmapAtlasStorage(const msdfgen::BitmapConstSection<T, N> &bitmap) : bitmap(bitmap) { }
 
@@ -29,8 +29,14 @@ public:
     explicit DynamicAtlas(int minSide, ARGS... args);
     /// Creates with a configured generator. The generator must not contain any prior glyphs!
     explicit DynamicAtlas(AtlasGenerator &&generator);
+    /// Sets the algorithm used to pack glyph boxes. If glyphs have already been added, it takes effect on the next rearrangement
+    void setPackingAlgorithm(PackingAlgorithm packingAlgorithm);
     /// Adds a batch of glyphs. Adding more than one glyph at a time may improve packing efficiency
     ChangeFlags add(GlyphGeometry *glyphs, int count, bool allowRearrange = false);
+    /// Returns the number of glyphs added so far, which is also the index of the next added glyph within the layout
+    int getGlyphCount() const;
+    /// Returns the current placement of every non-whitespace glyph added so far. Remap::index is the glyph's position in the order of addition and Remap::target its box's position
+    const std::vector<Remap> &getLayout() const;
     /// Allows access to generator. Do not add glyphs to the generator directly!
     AtlasGenerator &atlasGenerator();
     const AtlasGenerator &atlasGenerator() const;
@@ -40,6 +46,7 @@ private:
     int spacing;
     int glyphCount;
     int totalArea;
+    PackingAlgorithm packingAlgorithm;
     RectanglePacker packer;
     AtlasGenerator generator;
     std::vector<Rectangle> rectangles;
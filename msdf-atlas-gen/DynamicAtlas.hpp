@@ -1,19 +1,27 @@
 
 #include "DynamicAtlas.h"
 
+#include <utility>
 #include "utils.hpp"
 
 namespace msdf_atlas {
 
 template <class AtlasGenerator>
-DynamicAtlas<AtlasGenerator>::DynamicAtlas() : side(0), spacing(0), glyphCount(0), totalArea(0) { }
+DynamicAtlas<AtlasGenerator>::DynamicAtlas() : side(0), spacing(0), glyphCount(0), totalArea(0), packingAlgorithm(PackingAlgorithm::GUILLOTINE) { }
 
 template <class AtlasGenerator>
 template <typename... ARGS>
-DynamicAtlas<AtlasGenerator>::DynamicAtlas(int minSide, ARGS... args) : side(minSide > 0 ? ceilToPOT(minSide) : 0), spacing(0), glyphCount(0), totalArea(0), packer(side+spacing, side+spacing), generator(side, side, args...) { }
+DynamicAtlas<AtlasGenerator>::DynamicAtlas(int minSide, ARGS... args) : side(minSide > 0 ? ceilToPOT(minSide) : 0), spacing(0), glyphCount(0), totalArea(0), packingAlgorithm(PackingAlgorithm::GUILLOTINE), packer(side+spacing, side+spacing), generator(side, side, args...) { }
 
 template <class AtlasGenerator>
-DynamicAtlas<AtlasGenerator>::DynamicAtlas(AtlasGenerator &&generator) : side(0), spacing(0), glyphCount(0), totalArea(0), generator((AtlasGenerator &&) generator) { }
+DynamicAtlas<AtlasGenerator>::DynamicAtlas(AtlasGenerator &&generator) : side(0), spacing(0), glyphCount(0), totalArea(0), packingAlgorithm(PackingAlgorithm::GUILLOTINE), generator((AtlasGenerator &&) generator) { }
+
+template <class AtlasGenerator>
+void DynamicAtlas<AtlasGenerator>::setPackingAlgorithm(PackingAlgorithm packingAlgorithm) {
+    this->packingAlgorithm = packingAlgorithm;
+    if (rectangles.empty())
+        packer = RectanglePacker(side+spacing, side+spacing, packingAlgorithm);
+}
 
 template <class AtlasGenerator>
 typename DynamicAtlas<AtlasGenerator>::ChangeFlags DynamicAtlas<AtlasGenerator>::add(GlyphGeometry *glyphs, int count, bool allowRearrange) {
@@ -23,7 +31,7 @@ typename DynamicAtlas<AtlasGenerator>::ChangeFlags DynamicAtlas<AtlasGenerator>:
         if (!glyphs[i].isWhitespace()) {
             int w, h;
             glyphs[i].getBoxSize(w, h);
-            Rectangle rect = { 0, 0, w+spacing, h+spacing };
+            Rectangle rect = { -1, -1, w+spacing, h+spacing };
             rectangles.push_back(rect);
             Remap remapEntry = { };
             remapEntry.index = glyphCount+i;
@@ -41,9 +49,18 @@ typename DynamicAtlas<AtlasGenerator>::ChangeFlags DynamicAtlas<AtlasGenerator>:
             while (side*side < totalArea)
                 side <<= 1;
             if (allowRearrange) {
-                packer = RectanglePacker(side+spacing, side+spacing);
+                packer = RectanglePacker(side+spacing, side+spacing, packingAlgorithm);
                 packerStart = 0;
             } else {
+                // Move the rectangles that didn't fit to the end
+                for (int i = packerStart, end = (int) rectangles.size(); i < end;) {
+                    if (rectangles[i].x < 0) {
+                        --end;
+                        std::swap(rectangles[i], rectangles[end]);
+                        std::swap(remapBuffer[i], remapBuffer[end]);
+                    } else
+                        ++i;
+                }
                 packer.expand(side+spacing, side+spacing);
                 packerStart = rectangles.size()-remaining;
             }
@@ -71,6 +88,16 @@ typename DynamicAtlas<AtlasGenerator>::ChangeFlags DynamicAtlas<AtlasGenerator>:
     return changeFlags;
 }
 
+template <class AtlasGenerator>
+int DynamicAtlas<AtlasGenerator>::getGlyphCount() const {
+    return glyphCount;
+}
+
+template <class AtlasGenerator>
+const std::vector<Remap> &DynamicAtlas<AtlasGenerator>::getLayout() const {
+    return remapBuffer;
+}
+
 template <class AtlasGenerator>
 AtlasGenerator &DynamicAtlas<AtlasGenerator>::atlasGenerator() {
     return generator;
@@ -0,0 +1,84 @@
+
+#pragma once
+
+#include <utility>
+#include <vector>
+#include <deque>
+#include <map>
+#include <chrono>
+#include "GlyphGeometry.h"
+#include "DynamicAtlas.h"
+
+namespace msdf_atlas {
+
+/**
+ * A request queue front-end for DynamicAtlas. Glyphs requested over time are deduplicated
+ * and coalesced into batches, each of which is added to the atlas in a single call,
+ * which amortizes the cost of packing and starting the generator.
+ * A batch is submitted once the number of queued glyphs reaches the count window
+ * or the oldest queued request is older than the time window (checked by update).
+ * Glyphs are identified by a user-defined font ID and their glyph index.
+ */
+template <class AtlasGenerator>
+class DynamicAtlasBatcher {
+
+public:
+    typedef typename DynamicAtlas<AtlasGenerator>::ChangeFlags ChangeFlags;
+
+    /// Statistics of submitted batches, latency is measured from the first request of a batch to its submission
+    struct Statistics {
+        int requests;
+        int duplicateRequests;
+        int batches;
+        int glyphsAdded;
+        int maxBatchSize;
+        double totalLatency, maxLatency;
+        double totalAddTime, maxAddTime;
+    };
+
+    explicit DynamicAtlasBatcher(DynamicAtlas<AtlasGenerator> &atlas);
+    /// Sets the maximum number of queued glyphs and maximum delay in seconds before a batch is submitted
+    void setWindow(int maxCount, double maxDelay);
+    /// Sets whether rearranging the atlas is allowed when adding batches, in which case the boxes of previously submitted glyphs are updated
+    void setAllowRearrange(bool allowRearrange);
+    /// Queues a glyph to be added unless it has already been requested, returns false for duplicates
+    bool request(int fontId, const GlyphGeometry &glyph);
+    bool request(int fontId, GlyphGeometry &&glyph);
+    /// Submits the queued glyphs if the count or time window has been exceeded
+    ChangeFlags update();
+    /// Submits the queued glyphs immediately
+    ChangeFlags flush();
+    /// Returns the glyph as placed in the atlas or null if it hasn't been submitted yet
+    const GlyphGeometry *getGlyph(int fontId, int glyphIndex) const;
+    /// Returns true if the glyph has been requested (submitted or still queued)
+    bool isRequested(int fontId, int glyphIndex) const;
+    /// Returns the number of glyphs waiting to be submitted
+    int getQueuedCount() const;
+    /// Returns the batch statistics
+    const Statistics &getStatistics() const;
+    /// Resets the batch statistics
+    void resetStatistics();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    DynamicAtlas<AtlasGenerator> &atlas;
+    int maxCount;
+    double maxDelay;
+    bool allowRearrange;
+    std::vector<GlyphGeometry> queue;
+    std::vector<int> queueFontIds;
+    Clock::time_point queueStart;
+    std::deque<GlyphGeometry> glyphs;
+    std::map<std::pair<int, int>, int> glyphMap;
+    /// Maps the glyphs' indices within the atlas' layout to their positions in glyphs
+    std::map<int, int> glyphsByAtlasIndex;
+    Statistics stats;
+
+    bool enqueue(int fontId, int glyphIndex);
+
+};
+
+}
+
+#include "DynamicAtlasBatcher.hpp"
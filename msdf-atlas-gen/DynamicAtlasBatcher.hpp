@@ -0,0 +1,149 @@
+
+#include "DynamicAtlasBatcher.h"
+
+#include <algorithm>
+
+namespace msdf_atlas {
+
+template <class AtlasGenerator>
+DynamicAtlasBatcher<AtlasGenerator>::DynamicAtlasBatcher(DynamicAtlas<AtlasGenerator> &atlas) : atlas(atlas), maxCount(64), maxDelay(.004), allowRearrange(false), stats() { }
+
+template <class AtlasGenerator>
+void DynamicAtlasBatcher<AtlasGenerator>::setWindow(int maxCount, double maxDelay) {
+    this->maxCount = maxCount;
+    this->maxDelay = maxDelay;
+}
+
+template <class AtlasGenerator>
+void DynamicAtlasBatcher<AtlasGenerator>::setAllowRearrange(bool allowRearrange) {
+    this->allowRearrange = allowRearrange;
+}
+
+template <class AtlasGenerator>
+bool DynamicAtlasBatcher<AtlasGenerator>::enqueue(int fontId, int glyphIndex) {
+    ++stats.requests;
+    // Queued glyphs are mapped to -1-(position in queue)
+    if (!glyphMap.insert(std::make_pair(std::make_pair(fontId, glyphIndex), -1-(int) queue.size())).second) {
+        ++stats.duplicateRequests;
+        return false;
+    }
+    if (queue.empty())
+        queueStart = Clock::now();
+    queueFontIds.push_back(fontId);
+    return true;
+}
+
+template <class AtlasGenerator>
+bool DynamicAtlasBatcher<AtlasGenerator>::request(int fontId, const GlyphGeometry &glyph) {
+    if (!enqueue(fontId, glyph.getIndex()))
+        return false;
+    queue.push_back(glyph);
+    return true;
+}
+
+template <class AtlasGenerator>
+bool DynamicAtlasBatcher<AtlasGenerator>::request(int fontId, GlyphGeometry &&glyph) {
+    if (!enqueue(fontId, glyph.getIndex()))
+        return false;
+    queue.push_back((GlyphGeometry &&) glyph);
+    return true;
+}
+
+template <class AtlasGenerator>
+typename DynamicAtlasBatcher<AtlasGenerator>::ChangeFlags DynamicAtlasBatcher<AtlasGenerator>::update() {
+    if (queue.empty())
+        return DynamicAtlas<AtlasGenerator>::NO_CHANGE;
+    if ((maxCount > 0 && (int) queue.size() >= maxCount) || std::chrono::duration<double>(Clock::now()-queueStart).count() >= maxDelay)
+        return flush();
+    return DynamicAtlas<AtlasGenerator>::NO_CHANGE;
+}
+
+template <class AtlasGenerator>
+typename DynamicAtlasBatcher<AtlasGenerator>::ChangeFlags DynamicAtlasBatcher<AtlasGenerator>::flush() {
+    if (queue.empty())
+        return DynamicAtlas<AtlasGenerator>::NO_CHANGE;
+    int count = (int) queue.size();
+
+    // Sort by descending box height for better packing
+    std::vector<int> order(count);
+    std::vector<int> heights(count);
+    for (int i = 0; i < count; ++i) {
+        int w, h;
+        queue[i].getBoxSize(w, h);
+        order[i] = i;
+        heights[i] = h;
+    }
+    std::stable_sort(order.begin(), order.end(), [&heights](int a, int b) -> bool {
+        return heights[a] > heights[b];
+    });
+    std::vector<GlyphGeometry> batch;
+    std::vector<int> batchFontIds;
+    batch.reserve(count);
+    batchFontIds.reserve(count);
+    for (int i : order) {
+        batch.push_back((GlyphGeometry &&) queue[i]);
+        batchFontIds.push_back(queueFontIds[i]);
+    }
+    queue.clear();
+    queueFontIds.clear();
+
+    int firstAtlasIndex = atlas.getGlyphCount();
+    Clock::time_point addStart = Clock::now();
+    ChangeFlags changeFlags = atlas.add(batch.data(), count, allowRearrange);
+    Clock::time_point addEnd = Clock::now();
+
+    for (int i = 0; i < count; ++i) {
+        glyphMap[std::make_pair(batchFontIds[i], batch[i].getIndex())] = (int) glyphs.size();
+        glyphsByAtlasIndex[firstAtlasIndex+i] = (int) glyphs.size();
+        glyphs.push_back((GlyphGeometry &&) batch[i]);
+    }
+    // Previously submitted glyphs may have been moved
+    if (changeFlags&DynamicAtlas<AtlasGenerator>::REARRANGED) {
+        for (const Remap &remap : atlas.getLayout()) {
+            std::map<int, int>::const_iterator it = glyphsByAtlasIndex.find(remap.index);
+            if (it != glyphsByAtlasIndex.end())
+                glyphs[it->second].placeBox(remap.target.x, remap.target.y);
+        }
+    }
+
+    double latency = std::chrono::duration<double>(addEnd-queueStart).count();
+    double addTime = std::chrono::duration<double>(addEnd-addStart).count();
+    ++stats.batches;
+    stats.glyphsAdded += count;
+    stats.maxBatchSize = std::max(stats.maxBatchSize, count);
+    stats.totalLatency += latency;
+    stats.maxLatency = std::max(stats.maxLatency, latency);
+    stats.totalAddTime += addTime;
+    stats.maxAddTime = std::max(stats.maxAddTime, addTime);
+    return changeFlags;
+}
+
+template <class AtlasGenerator>
+const GlyphGeometry *DynamicAtlasBatcher<AtlasGenerator>::getGlyph(int fontId, int glyphIndex) const {
+    std::map<std::pair<int, int>, int>::const_iterator it = glyphMap.find(std::make_pair(fontId, glyphIndex));
+    if (it != glyphMap.end() && it->second >= 0)
+        return &glyphs[it->second];
+    return nullptr;
+}
+
+template <class AtlasGenerator>
+bool DynamicAtlasBatcher<AtlasGenerator>::isRequested(int fontId, int glyphIndex) const {
+    return glyphMap.find(std::make_pair(fontId, glyphIndex)) != glyphMap.end();
+}
+
+template <class AtlasGenerator>
+int DynamicAtlasBatcher<AtlasGenerator>::getQueuedCount() const {
+    return (int) queue.size();
+}
+
+template <class AtlasGenerator>
+const typename DynamicAtlasBatcher<AtlasGenerator>::Statistics &DynamicAtlasBatcher<AtlasGenerator>::getStatistics() const {
+    return stats;
+}
+
+template <class AtlasGenerator>
+void DynamicAtlasBatcher<AtlasGenerator>::resetStatistics() {
+    stats = Statistics();
+}
+
+}
@@ -1,6 +1,8 @@
 
 #include "FontGeometry.h"
 
+#include "Instrumentation.h"
+
 #define DEFAULT_FONT_UNITS_PER_EM 2048.0
 
 namespace msdf_atlas {
@@ -38,6 +40,15 @@ FontGeometry::FontGeometry(FontGeometry &&orig) : geometryScale(orig.geometrySca
         glyphs = &ownGlyphs;
 }
 
+FontGeometry::FontGeometry(const FontGeometry &orig, std::vector<GlyphGeometry> *glyphStorage) : geometryScale(orig.geometryScale), metrics(orig.metrics), preferredIdentifierType(orig.preferredIdentifierType), rangeStart(orig.rangeStart), rangeEnd(orig.rangeEnd), glyphsByIndex(orig.glyphsByIndex), glyphsByCodepoint(orig.glyphsByCodepoint), kerning(orig.kerning), name(orig.name) {
+    if (glyphStorage)
+        glyphs = glyphStorage;
+    else {
+        ownGlyphs = *orig.glyphs;
+        glyphs = &ownGlyphs;
+    }
+}
+
 FontGeometry &FontGeometry::operator=(FontGeometry &&orig) {
     if (this != &orig) {
         geometryScale = orig.geometryScale;
@@ -146,6 +157,7 @@ bool FontGeometry::addGlyph(GlyphGeometry &&glyph) {
 }
 
 int FontGeometry::loadKerning(msdfgen::FontHandle *font) {
+    Instrumentation::Scope scope(Instrumentation::FONT_LOADING);
     int loaded = 0;
     for (size_t i = rangeStart; i < rangeEnd; ++i)
         for (size_t j = rangeStart; j < rangeEnd; ++j) {
@@ -195,6 +207,21 @@ const GlyphGeometry *FontGeometry::getGlyph(unicode_t codepoint) const {
     return nullptr;
 }
 
+std::vector<unicode_t> FontGeometry::getCodepointTable() const {
+    std::vector<unicode_t> codepoints;
+    GlyphRange glyphRange = getGlyphs();
+    for (const GlyphGeometry &glyph : glyphRange) {
+        if (glyph.getIndex() >= (int) codepoints.size())
+            codepoints.resize(glyph.getIndex()+1);
+    }
+    // Iterate backwards so that the first glyph with each index prevails
+    for (const GlyphGeometry *glyph = glyphRange.end(); glyph > glyphRange.begin();) {
+        --glyph;
+        codepoints[glyph->getIndex()] = glyph->getCodepoint();
+    }
+    return codepoints;
+}
+
 bool FontGeometry::getAdvance(double &advance, msdfgen::GlyphIndex index1, msdfgen::GlyphIndex index2) const {
     const GlyphGeometry *glyph1 = getGlyph(index1);
     if (!glyph1)
@@ -32,6 +32,8 @@ public:
 
     FontGeometry();
     explicit FontGeometry(std::vector<GlyphGeometry> *glyphStorage);
+    /// Creates a copy of orig whose glyphs are instead at the same positions in glyphStorage (e.g. a copy of orig's storage), or in its own copy if null
+    FontGeometry(const FontGeometry &orig, std::vector<GlyphGeometry> *glyphStorage);
     FontGeometry(FontGeometry &&orig);
     FontGeometry &operator=(FontGeometry &&orig);
 
@@ -63,6 +65,8 @@ public:
     /// Finds a glyph by glyph index or Unicode codepoint, returns null if not found
     const GlyphGeometry *getGlyph(msdfgen::GlyphIndex index) const;
     const GlyphGeometry *getGlyph(unicode_t codepoint) const;
+    /// Returns the codepoint of the glyph found by getGlyph for each glyph index (zero if none) as a table indexed by glyph index
+    std::vector<unicode_t> getCodepointTable() const;
     /// Outputs the advance between two glyphs with kerning taken into consideration, returns false on failure
     bool getAdvance(double &advance, msdfgen::GlyphIndex index1, msdfgen::GlyphIndex index2) const;
     bool getAdvance(double &advance, unicode_t codepoint1, unicode_t codepoint2) const;
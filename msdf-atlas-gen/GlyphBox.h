@@ -13,6 +13,8 @@ struct GlyphBox {
         double l, b, r, t;
     } bounds;
     Rectangle rect;
+    /// If true, the glyph is rotated by 90 degrees counter-clockwise in the atlas and occupies rect.h x rect.w pixels
+    bool rotated;
 
 };
 
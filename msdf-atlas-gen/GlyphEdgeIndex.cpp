@@ -0,0 +1,134 @@
+
+#include "GlyphEdgeIndex.h"
+
+#include <cmath>
+#include <algorithm>
+
+namespace msdf_atlas {
+
+static double squaredBoxDistance(double l, double b, double r, double t, double el, double eb, double er, double et) {
+    double dx = std::max(0., std::max(el-r, l-er));
+    double dy = std::max(0., std::max(eb-t, b-et));
+    return dx*dx+dy*dy;
+}
+
+static double squaredPointDistance(msdfgen::Point2 p, double x, double y) {
+    return (p.x-x)*(p.x-x)+(p.y-y)*(p.y-y);
+}
+
+/// Returns the maximum squared distance of the point from the rectangle's corners, which bounds the distance from any point of the rectangle
+static double squaredMaxDistance(double l, double b, double r, double t, msdfgen::Point2 p) {
+    double dx = std::max(fabs(p.x-l), fabs(p.x-r));
+    double dy = std::max(fabs(p.y-b), fabs(p.y-t));
+    return dx*dx+dy*dy;
+}
+
+/// Returns the squared distance between the rectangle and the ray from origin in direction (normalized or zero)
+static double squaredRayDistance(double l, double b, double r, double t, msdfgen::Point2 origin, msdfgen::Vector2 direction) {
+    // Slab intersection test
+    double tMin = 0, tMax = HUGE_VAL;
+    const double lower[2] = { l, b }, upper[2] = { r, t };
+    const double o[2] = { origin.x, origin.y }, d[2] = { direction.x, direction.y };
+    bool intersects = true;
+    for (int i = 0; i < 2 && intersects; ++i) {
+        if (d[i] == 0)
+            intersects = o[i] >= lower[i] && o[i] <= upper[i];
+        else {
+            double t0 = (lower[i]-o[i])/d[i], t1 = (upper[i]-o[i])/d[i];
+            tMin = std::max(tMin, std::min(t0, t1));
+            tMax = std::min(tMax, std::max(t0, t1));
+            intersects = tMin <= tMax;
+        }
+    }
+    if (intersects)
+        return 0;
+    // Otherwise, the closest points are the ray's origin or a corner of the rectangle
+    double distance = squaredBoxDistance(l, b, r, t, origin.x, origin.y, origin.x, origin.y);
+    const msdfgen::Point2 corners[4] = { msdfgen::Point2(l, b), msdfgen::Point2(r, b), msdfgen::Point2(l, t), msdfgen::Point2(r, t) };
+    for (const msdfgen::Point2 &corner : corners) {
+        msdfgen::Vector2 v = corner-origin;
+        double param = std::max(0., msdfgen::dotProduct(v, direction));
+        msdfgen::Vector2 w = v-param*direction;
+        distance = std::min(distance, msdfgen::dotProduct(w, w));
+    }
+    return distance;
+}
+
+GlyphEdgeIndex::GlyphEdgeIndex(const msdfgen::Shape &shape) : shape(shape) {
+    for (const msdfgen::Contour &contour : shape.contours) {
+        for (const msdfgen::EdgeHolder &edge : contour.edges) {
+            Edge indexed;
+            indexed.l = +HUGE_VAL, indexed.b = +HUGE_VAL, indexed.r = -HUGE_VAL, indexed.t = -HUGE_VAL;
+            edge->bound(indexed.l, indexed.b, indexed.r, indexed.t);
+            indexed.start = edge->point(0);
+            indexed.middle = edge->point(.5);
+            indexed.end = edge->point(1);
+            indexed.startRay = -edge->direction(0).normalize(true);
+            indexed.endRay = edge->direction(1).normalize(true);
+            indexed.color = edge->color;
+            edges.push_back(indexed);
+        }
+    }
+    lowerBounds.resize(edges.size());
+    culled.resize(edges.size());
+}
+
+bool GlyphEdgeIndex::anyEdgeWithin(double l, double b, double r, double t, double distance) const {
+    for (const Edge &edge : edges) {
+        if (squaredBoxDistance(l, b, r, t, edge.l, edge.b, edge.r, edge.t) < distance*distance)
+            return true;
+    }
+    return false;
+}
+
+void GlyphEdgeIndex::cullShape(msdfgen::Shape &output, double l, double b, double r, double t) {
+    // Upper bounds of the minimum distance among edges of each color channel (and all edges) - the distance to any edge is at most its distance to its start or middle point
+    double upperBounds[4] = { HUGE_VAL, HUGE_VAL, HUGE_VAL, HUGE_VAL };
+    for (size_t i = 0; i < edges.size(); ++i) {
+        const Edge &edge = edges[i];
+        double upperBound = std::min(squaredMaxDistance(l, b, r, t, edge.start), squaredMaxDistance(l, b, r, t, edge.middle));
+        for (int channel = 0; channel < 3; ++channel) {
+            if (edge.color&(1<<channel))
+                upperBounds[channel] = std::min(upperBounds[channel], upperBound);
+        }
+        upperBounds[3] = std::min(upperBounds[3], upperBound);
+        // An edge affects the distance through its true distance and the perpendicular distance to the rays that extend it
+        lowerBounds[i] = std::min(squaredBoxDistance(l, b, r, t, edge.l, edge.b, edge.r, edge.t), std::min(
+            squaredRayDistance(l, b, r, t, edge.start, edge.startRay),
+            squaredRayDistance(l, b, r, t, edge.end, edge.endRay)
+        ));
+    }
+    for (size_t i = 0; i < edges.size(); ++i) {
+        double upperBound = upperBounds[3];
+        for (int channel = 0; channel < 3; ++channel) {
+            if (edges[i].color&(1<<channel))
+                upperBound = std::max(upperBound, upperBounds[channel]);
+        }
+        culled[i] = lowerBounds[i] > upperBound;
+    }
+
+    output.contours.clear();
+    output.setYAxisOrientation(shape.getYAxisOrientation());
+    std::vector<int> included;
+    int offset = 0;
+    for (const msdfgen::Contour &contour : shape.contours) {
+        int size = (int) contour.edges.size();
+        included.clear();
+        // Edges which are not culled must keep their neighbors, which determine the domains of their perpendicular distances
+        for (int i = 0; i < size; ++i) {
+            if (!(culled[offset+i] && culled[offset+(i+size-1)%size] && culled[offset+(i+1)%size]))
+                included.push_back(i);
+        }
+        offset += size;
+        if (included.empty())
+            continue;
+        // The distance finder starts with the last edge of each contour, so the rotation keeps the original order of evaluation
+        if (included.back() != size-1)
+            std::rotate(included.begin(), included.begin()+1, included.end());
+        msdfgen::Contour &culledContour = output.addContour();
+        for (int i : included)
+            culledContour.edges.push_back(contour.edges[i]);
+    }
+}
+
+}
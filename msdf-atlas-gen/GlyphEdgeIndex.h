@@ -0,0 +1,42 @@
+
+#pragma once
+
+#include <vector>
+#include <msdfgen.h>
+
+namespace msdf_atlas {
+
+/**
+ * Conservative bounds of a shape's edges, which determine the edges that may affect its distance field within a rectangle.
+ * Only valid for distance fields generated without overlap support, which evaluates each edge independently of its contour.
+ */
+class GlyphEdgeIndex {
+
+public:
+    /// Indexes the edges of the shape, which must outlive the index
+    explicit GlyphEdgeIndex(const msdfgen::Shape &shape);
+    /// Returns false if all edges are at least distance away from the rectangle
+    bool anyEdgeWithin(double l, double b, double r, double t, double distance) const;
+    /**
+     * Outputs the shape reduced to the edges which may determine the SDF, PSDF, MSDF, or MTSDF value at any point of the rectangle,
+     * together with their neighbors, ordered so that the distances are evaluated identically to the full shape
+     */
+    void cullShape(msdfgen::Shape &output, double l, double b, double r, double t);
+
+private:
+    struct Edge {
+        double l, b, r, t;
+        msdfgen::Point2 start, middle, end;
+        /// Normalized directions of the rays that extend the edge beyond its endpoints
+        msdfgen::Vector2 startRay, endRay;
+        int color;
+    };
+
+    const msdfgen::Shape &shape;
+    std::vector<Edge> edges;
+    std::vector<double> lowerBounds;
+    std::vector<bool> culled;
+
+};
+
+}
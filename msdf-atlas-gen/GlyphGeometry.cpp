@@ -3,37 +3,49 @@
 
 #include <cmath>
 #include <core/ShapeDistanceFinder.h>
+#include "Instrumentation.h"
 
 namespace msdf_atlas {
 
 GlyphGeometry::GlyphGeometry() : index(), codepoint(), geometryScale(), bounds(), advance(), box() { }
 
 bool GlyphGeometry::load(msdfgen::FontHandle *font, double geometryScale, msdfgen::GlyphIndex index, bool preprocessGeometry) {
-    if (font && msdfgen::loadGlyph(shape, font, index, msdfgen::FONT_SCALING_NONE, &advance) && shape.validate()) {
-        this->index = index.getIndex();
-        this->geometryScale = geometryScale;
-        codepoint = 0;
-        advance *= geometryScale;
-        #ifdef MSDFGEN_USE_SKIA
-            if (preprocessGeometry)
-                msdfgen::resolveShapeGeometry(shape);
-        #endif
-        shape.normalize();
-        bounds = shape.getBounds();
-        #ifdef MSDFGEN_USE_SKIA
-            if (!preprocessGeometry)
-        #endif
-        {
-            // Determine if shape is winded incorrectly and reverse it in that case
-            msdfgen::Point2 outerPoint(bounds.l-(bounds.r-bounds.l)-1, bounds.b-(bounds.t-bounds.b)-1);
-            if (msdfgen::SimpleTrueShapeDistanceFinder::oneShotDistance(shape, outerPoint) > 0) {
-                for (msdfgen::Contour &contour : shape.contours)
-                    contour.reverse();
-            }
+    {
+        Instrumentation::Scope loading(Instrumentation::FONT_LOADING);
+        if (!(font && msdfgen::loadGlyph(shape, font, index, msdfgen::FONT_SCALING_NONE, &advance) && shape.validate()))
+            return false;
+        loading.addGlyphs(1);
+        loading.addEdges(shape.edgeCount());
+    }
+    this->index = index.getIndex();
+    this->geometryScale = geometryScale;
+    codepoint = 0;
+    advance *= geometryScale;
+    preprocess(preprocessGeometry);
+    return true;
+}
+
+void GlyphGeometry::preprocess(bool preprocessGeometry) {
+    Instrumentation::Scope scope(Instrumentation::GEOMETRY_PREPROCESSING);
+    #ifdef MSDFGEN_USE_SKIA
+        if (preprocessGeometry)
+            msdfgen::resolveShapeGeometry(shape);
+    #endif
+    shape.normalize();
+    bounds = shape.getBounds();
+    #ifdef MSDFGEN_USE_SKIA
+        if (!preprocessGeometry)
+    #endif
+    {
+        // Determine if shape is winded incorrectly and reverse it in that case
+        msdfgen::Point2 outerPoint(bounds.l-(bounds.r-bounds.l)-1, bounds.b-(bounds.t-bounds.b)-1);
+        if (msdfgen::SimpleTrueShapeDistanceFinder::oneShotDistance(shape, outerPoint) > 0) {
+            for (msdfgen::Contour &contour : shape.contours)
+                contour.reverse();
         }
-        return true;
     }
-    return false;
+    scope.addGlyphs(1);
+    scope.addEdges(shape.edgeCount());
 }
 
 bool GlyphGeometry::load(msdfgen::FontHandle *font, double geometryScale, unicode_t codepoint, bool preprocessGeometry) {
@@ -47,8 +59,33 @@ bool GlyphGeometry::load(msdfgen::FontHandle *font, double geometryScale, unicod
     return false;
 }
 
+bool GlyphGeometry::load(const msdfgen::Shape &shape, double geometryScale, double advance, bool preprocessGeometry) {
+    if (!shape.validate())
+        return false;
+    this->shape = shape;
+    index = 0;
+    codepoint = 0;
+    this->geometryScale = geometryScale;
+    this->advance = geometryScale*advance;
+    preprocess(preprocessGeometry);
+    return true;
+}
+
 void GlyphGeometry::edgeColoring(void (*fn)(msdfgen::Shape &, double, unsigned long long), double angleThreshold, unsigned long long seed) {
+    Instrumentation::Scope scope(Instrumentation::EDGE_COLORING);
     fn(shape, angleThreshold, seed);
+    scope.addGlyphs(1);
+    scope.addEdges(shape.edgeCount());
+}
+
+bool GlyphGeometry::setEdgeColors(const byte *colors, int count) {
+    if (count != shape.edgeCount())
+        return false;
+    for (msdfgen::Contour &contour : shape.contours) {
+        for (msdfgen::EdgeHolder &edge : contour.edges)
+            edge->color = msdfgen::EdgeColor(*colors++);
+    }
+    return true;
 }
 
 void GlyphGeometry::wrapBox(const GlyphAttributes &glyphAttributes) {
@@ -175,8 +212,9 @@ void GlyphGeometry::frameBox(double scale, double range, double miterLimit, int
     frameBox(attribs, width, height, fixedX, fixedY);
 }
 
-void GlyphGeometry::placeBox(int x, int y) {
+void GlyphGeometry::placeBox(int x, int y, bool rotated) {
     box.rect.x = x, box.rect.y = y;
+    box.rotated = rotated;
 }
 
 void GlyphGeometry::setBoxRect(const Rectangle &rect) {
@@ -234,6 +272,10 @@ void GlyphGeometry::getBoxSize(int &w, int &h) const {
     w = box.rect.w, h = box.rect.h;
 }
 
+bool GlyphGeometry::isBoxRotated() const {
+    return box.rotated;
+}
+
 msdfgen::Range GlyphGeometry::getBoxRange() const {
     return box.range;
 }
@@ -262,7 +304,13 @@ void GlyphGeometry::getQuadPlaneBounds(double &l, double &b, double &r, double &
 }
 
 void GlyphGeometry::getQuadAtlasBounds(double &l, double &b, double &r, double &t) const {
-    if (box.rect.w > 0 && box.rect.h > 0) {
+    if (box.rotated && box.rect.w > 0 && box.rect.h > 0) {
+        // The glyph's left side faces down and its bottom side faces right
+        l = box.rect.x+box.outerPadding.t+.5;
+        b = box.rect.y+box.outerPadding.l+.5;
+        r = box.rect.x-box.outerPadding.b+box.rect.h-.5;
+        t = box.rect.y-box.outerPadding.r+box.rect.w-.5;
+    } else if (box.rect.w > 0 && box.rect.h > 0) {
         l = box.rect.x+box.outerPadding.l+.5;
         b = box.rect.y+box.outerPadding.b+.5;
         r = box.rect.x-box.outerPadding.r+box.rect.w-.5;
@@ -281,6 +329,7 @@ GlyphGeometry::operator GlyphBox() const {
     box.advance = advance;
     getQuadPlaneBounds(box.bounds.l, box.bounds.b, box.bounds.r, box.bounds.t);
     box.rect.x = this->box.rect.x, box.rect.y = this->box.rect.y, box.rect.w = this->box.rect.w, box.rect.h = this->box.rect.h;
+    box.rotated = this->box.rotated;
     return box;
 }
 
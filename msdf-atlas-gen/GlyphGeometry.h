@@ -26,8 +26,12 @@ public:
     /// Loads glyph geometry from font
     bool load(msdfgen::FontHandle *font, double geometryScale, msdfgen::GlyphIndex index, bool preprocessGeometry = true);
     bool load(msdfgen::FontHandle *font, double geometryScale, unicode_t codepoint, bool preprocessGeometry = true);
+    /// Loads glyph geometry from a shape in font units (e.g. not originating from a font file), which is then processed in the same way
+    bool load(const msdfgen::Shape &shape, double geometryScale, double advance, bool preprocessGeometry = true);
     /// Applies edge coloring to glyph shape
     void edgeColoring(void (*fn)(msdfgen::Shape &, double, unsigned long long), double angleThreshold, unsigned long long seed);
+    /// Applies previously computed edge colors, one per edge in contour order, returns false if their count doesn't match the shape
+    bool setEdgeColors(const byte *colors, int count);
     /// Computes the dimensions of the glyph's box as well as the transformation for the generator function
     void wrapBox(const GlyphAttributes &glyphAttributes);
     void wrapBox(double scale, double range, double miterLimit, bool pxAlignOrigin = false);
@@ -36,8 +40,8 @@ public:
     void frameBox(const GlyphAttributes &glyphAttributes, int width, int height, const double *fixedX, const double *fixedY);
     void frameBox(double scale, double range, double miterLimit, int width, int height, const double *fixedX, const double *fixedY, bool pxAlignOrigin = false);
     void frameBox(double scale, double range, double miterLimit, int width, int height, const double *fixedX, const double *fixedY, bool pxAlignOriginX, bool pxAlignOriginY);
-    /// Sets the glyph's box's position in the atlas
-    void placeBox(int x, int y);
+    /// Sets the glyph's box's position in the atlas and whether it is rotated by 90 degrees counter-clockwise
+    void placeBox(int x, int y, bool rotated = false);
     /// Sets the glyph's box's rectangle in the atlas
     void setBoxRect(const Rectangle &rect);
     /// Returns the glyph's index within the font
@@ -62,6 +66,8 @@ public:
     void getBoxRect(int &x, int &y, int &w, int &h) const;
     /// Outputs the dimensions of the glyph's box in the atlas
     void getBoxSize(int &w, int &h) const;
+    /// Returns true if the glyph's box is rotated by 90 degrees counter-clockwise in the atlas, in which case it occupies h x w pixels
+    bool isBoxRotated() const;
     /// Returns the range needed to generate the glyph's SDF
     msdfgen::Range getBoxRange() const;
     /// Returns the projection needed to generate the glyph's bitmap
@@ -72,7 +78,7 @@ public:
     msdfgen::Vector2 getBoxTranslate() const;
     /// Outputs the bounding box of the glyph as it should be placed on the baseline
     void getQuadPlaneBounds(double &l, double &b, double &r, double &t) const;
-    /// Outputs the bounding box of the glyph in the atlas
+    /// Outputs the bounding box of the glyph in the atlas (of its rotated image if the box is rotated)
     void getQuadAtlasBounds(double &l, double &b, double &r, double &t) const;
     /// Returns true if the glyph is a whitespace and has no geometry
     bool isWhitespace() const;
@@ -88,12 +94,16 @@ private:
     double advance;
     struct {
         Rectangle rect;
+        bool rotated;
         msdfgen::Range range;
         double scale;
         msdfgen::Vector2 translate;
         Padding outerPadding;
     } box;
 
+    /// Resolves, normalizes and orients the loaded shape and computes its bounds
+    void preprocess(bool preprocessGeometry);
+
 };
 
 msdfgen::Range operator+(msdfgen::Range a, msdfgen::Range b);
@@ -1,8 +1,11 @@
 
 #include "GridAtlasPacker.h"
 
+#include <vector>
 #include <algorithm>
 #include "utils.hpp"
+#include "Workload.h"
+#include "Instrumentation.h"
 
 namespace msdf_atlas {
 
@@ -91,33 +94,195 @@ GridAtlasPacker::GridAtlasPacker() :
     pxAlignOriginX(false), pxAlignOriginY(false),
     scaleMaximizationTolerance(.001),
     alignedColumnsBias(.125),
-    cutoff(false)
+    cutoff(false),
+    threadCount(1)
 { }
 
-msdfgen::Shape::Bounds GridAtlasPacker::getMaxBounds(double &maxWidth, double &maxHeight, GlyphGeometry *glyphs, int count, double scale, double outerRange) const {
-    static const double LARGE_VALUE = 1e240;
-    msdfgen::Shape::Bounds maxBounds = { +LARGE_VALUE, +LARGE_VALUE, -LARGE_VALUE, -LARGE_VALUE };
-    for (GlyphGeometry *glyph = glyphs, *end = glyphs+count; glyph < end; ++glyph) {
+/// Upper envelope of a set of lines y = a+k*x, which is a convex piecewise linear function
+class LineEnvelope {
+
+public:
+    struct Line {
+        double a, k;
+    };
+
+    /// Constructs the envelope of lines, which may be reordered in the process
+    void build(std::vector<Line> &lines) {
+        std::sort(lines.begin(), lines.end(), [](const Line &p, const Line &q) -> bool {
+            return p.k < q.k || (p.k == q.k && p.a > q.a);
+        });
+        this->lines.clear();
+        breaks.clear();
+        for (const Line &line : lines) {
+            if (!this->lines.empty() && this->lines.back().k == line.k)
+                continue;
+            while (!this->lines.empty()) {
+                const Line &prev = this->lines.back();
+                double x = (prev.a-line.a)/(line.k-prev.k);
+                if (breaks.empty() || x > breaks.back()) {
+                    breaks.push_back(x);
+                    break;
+                }
+                this->lines.pop_back();
+                breaks.pop_back();
+            }
+            this->lines.push_back(line);
+        }
+    }
+
+    /// Evaluates the envelope at x
+    double operator()(double x) const {
+        const Line &line = lines[std::upper_bound(breaks.begin(), breaks.end(), x)-breaks.begin()];
+        return line.a+line.k*x;
+    }
+
+    bool empty() const {
+        return lines.empty();
+    }
+
+    /// Appends the envelope's lines to output
+    void appendLines(std::vector<Line> &output) const {
+        output.insert(output.end(), lines.begin(), lines.end());
+    }
+
+    /// Appends the lines of the sum of two envelopes to output
+    static void appendSumLines(std::vector<Line> &output, const LineEnvelope &p, const LineEnvelope &q) {
+        size_t i = 0, j = 0;
+        while (true) {
+            Line line = { p.lines[i].a+q.lines[j].a, p.lines[i].k+q.lines[j].k };
+            output.push_back(line);
+            if (i < p.breaks.size() && (j >= q.breaks.size() || p.breaks[i] <= q.breaks[j])) {
+                if (j < q.breaks.size() && p.breaks[i] == q.breaks[j])
+                    ++j;
+                ++i;
+            } else if (j < q.breaks.size())
+                ++j;
+            else
+                break;
+        }
+    }
+
+private:
+    std::vector<Line> lines;
+    /// breaks[i] is the position where lines[i+1] overtakes lines[i]
+    std::vector<double> breaks;
+
+};
+
+/**
+ * Glyph bounds expanded by the outer range o (including miters) are linear in o for each bound and miter point.
+ * The maximum bounds are therefore upper envelopes of these lines (with left and bottom bounds negated).
+ */
+struct GridAtlasPacker::MaxBoundsFunction {
+    LineEnvelope negL, negB, r, t;
+    LineEnvelope width, height;
+};
+
+/// Same miter points as Shape::boundMiters, each miter is at origin+border*direction
+static void getMiters(std::vector<std::pair<msdfgen::Point2, msdfgen::Vector2> > &miters, const msdfgen::Shape &shape, double miterLimit) {
+    for (const msdfgen::Contour &contour : shape.contours) {
+        if (contour.edges.empty())
+            continue;
+        msdfgen::Vector2 prevDir = contour.edges.back()->direction(1).normalize(true);
+        for (const msdfgen::EdgeHolder &edge : contour.edges) {
+            msdfgen::Vector2 dir = -edge->direction(0).normalize(true);
+            if (msdfgen::crossProduct(prevDir, dir) >= 0) {
+                double miterLength = miterLimit;
+                double q = .5*(1-msdfgen::dotProduct(prevDir, dir));
+                if (q > 0)
+                    miterLength = std::min(1/sqrt(q), miterLimit);
+                miters.push_back(std::make_pair(edge->point(0), miterLength*(prevDir+dir).normalize(true)));
+            }
+            prevDir = edge->direction(1).normalize(true);
+        }
+    }
+}
+
+void GridAtlasPacker::computeMaxBoundsFunction(MaxBoundsFunction &maxBoundsFunction, const GlyphGeometry *glyphs, int count, double miterLimit) {
+    typedef LineEnvelope::Line Line;
+    std::vector<Line> negLLines, negBLines, rLines, tLines, widthLines, heightLines;
+    std::vector<Line> lines;
+    std::vector<std::pair<msdfgen::Point2, msdfgen::Vector2> > miters;
+    LineEnvelope negL, negB, r, t;
+    for (const GlyphGeometry *glyph = glyphs, *end = glyphs+count; glyph < end; ++glyph) {
         if (!glyph->isWhitespace()) {
+            // Lines are expressed in terms of the outer range in em units, shape border = outerRange/geometryScale
             double geometryScale = glyph->getGeometryScale();
-            double shapeOuterRange = outerRange/geometryScale;
-            geometryScale *= scale;
             const msdfgen::Shape::Bounds &shapeBounds = glyph->getShapeBounds();
-            double l = shapeBounds.l, b = shapeBounds.b, r = shapeBounds.r, t = shapeBounds.t;
-            l -= shapeOuterRange, b -= shapeOuterRange;
-            r += shapeOuterRange, t += shapeOuterRange;
+            miters.clear();
             if (miterLimit > 0)
-                glyph->getShape().boundMiters(l, b, r, t, shapeOuterRange, miterLimit, 1);
-            l *= geometryScale, b *= geometryScale;
-            r *= geometryScale, t *= geometryScale;
-            maxBounds.l = std::min(maxBounds.l, l);
-            maxBounds.b = std::min(maxBounds.b, b);
-            maxBounds.r = std::max(maxBounds.r, r);
-            maxBounds.t = std::max(maxBounds.t, t);
-            maxWidth = std::max(maxWidth, r-l);
-            maxHeight = std::max(maxHeight, t-b);
+                getMiters(miters, glyph->getShape(), miterLimit);
+            #define BUILD_BOUND_ENVELOPE(envelope, base, coord, sign) { \
+                lines.clear(); \
+                Line line = { sign geometryScale*(base), 1 }; \
+                lines.push_back(line); \
+                for (const std::pair<msdfgen::Point2, msdfgen::Vector2> &miter : miters) { \
+                    Line miterLine = { sign geometryScale*miter.first.coord, sign miter.second.coord }; \
+                    lines.push_back(miterLine); \
+                } \
+                envelope.build(lines); \
+            }
+            BUILD_BOUND_ENVELOPE(negL, shapeBounds.l, x, -);
+            BUILD_BOUND_ENVELOPE(negB, shapeBounds.b, y, -);
+            BUILD_BOUND_ENVELOPE(r, shapeBounds.r, x, +);
+            BUILD_BOUND_ENVELOPE(t, shapeBounds.t, y, +);
+            #undef BUILD_BOUND_ENVELOPE
+            negL.appendLines(negLLines);
+            negB.appendLines(negBLines);
+            r.appendLines(rLines);
+            t.appendLines(tLines);
+            LineEnvelope::appendSumLines(widthLines, r, negL);
+            LineEnvelope::appendSumLines(heightLines, t, negB);
         }
     }
+    maxBoundsFunction.negL.build(negLLines);
+    maxBoundsFunction.negB.build(negBLines);
+    maxBoundsFunction.r.build(rLines);
+    maxBoundsFunction.t.build(tLines);
+    maxBoundsFunction.width.build(widthLines);
+    maxBoundsFunction.height.build(heightLines);
+}
+
+void GridAtlasPacker::computeMaxBoundsFunction(MaxBoundsFunction &maxBoundsFunction, const GlyphGeometry *glyphs, int count) const {
+    static const int MIN_CHUNK_SIZE = 64;
+    int chunks = std::max(std::min(threadCount, count/MIN_CHUNK_SIZE), 1);
+    if (chunks == 1)
+        return computeMaxBoundsFunction(maxBoundsFunction, glyphs, count, miterLimit);
+    // Each chunk of glyphs is reduced to its own envelopes in parallel, which are then merged
+    std::vector<MaxBoundsFunction> chunkFunctions(chunks);
+    double miterLimit = this->miterLimit;
+    Workload([&chunkFunctions, glyphs, count, chunks, miterLimit](int chunk, int) -> bool {
+        int start = (int) ((long long) count*chunk/chunks);
+        int end = (int) ((long long) count*(chunk+1)/chunks);
+        computeMaxBoundsFunction(chunkFunctions[chunk], glyphs+start, end-start, miterLimit);
+        return true;
+    }, chunks).finish(threadCount);
+    std::vector<LineEnvelope::Line> lines;
+    #define MERGE_ENVELOPES(envelope) { \
+        lines.clear(); \
+        for (const MaxBoundsFunction &chunkFunction : chunkFunctions) \
+            chunkFunction.envelope.appendLines(lines); \
+        maxBoundsFunction.envelope.build(lines); \
+    }
+    MERGE_ENVELOPES(negL);
+    MERGE_ENVELOPES(negB);
+    MERGE_ENVELOPES(r);
+    MERGE_ENVELOPES(t);
+    MERGE_ENVELOPES(width);
+    MERGE_ENVELOPES(height);
+    #undef MERGE_ENVELOPES
+}
+
+msdfgen::Shape::Bounds GridAtlasPacker::getMaxBounds(double &maxWidth, double &maxHeight, const MaxBoundsFunction &maxBoundsFunction, double scale, double outerRange) const {
+    msdfgen::Shape::Bounds maxBounds = { };
+    if (!maxBoundsFunction.width.empty()) {
+        maxBounds.l = -scale*maxBoundsFunction.negL(outerRange);
+        maxBounds.b = -scale*maxBoundsFunction.negB(outerRange);
+        maxBounds.r = scale*maxBoundsFunction.r(outerRange);
+        maxBounds.t = scale*maxBoundsFunction.t(outerRange);
+        maxWidth = std::max(maxWidth, scale*maxBoundsFunction.width(outerRange));
+        maxHeight = std::max(maxHeight, scale*maxBoundsFunction.height(outerRange));
+    }
     if (maxBounds.l >= maxBounds.r || maxBounds.b >= maxBounds.t)
         maxBounds = msdfgen::Shape::Bounds();
     Padding fullPadding = scale*(innerUnitPadding+outerUnitPadding)+innerPxPadding+outerPxPadding;
@@ -136,7 +301,7 @@ msdfgen::Shape::Bounds GridAtlasPacker::getMaxBounds(double &maxWidth, double &m
     return maxBounds;
 }
 
-double GridAtlasPacker::scaleToFit(GlyphGeometry *glyphs, int count, int cellWidth, int cellHeight, msdfgen::Shape::Bounds &maxBounds, double &maxWidth, double &maxHeight) const {
+double GridAtlasPacker::scaleToFit(const MaxBoundsFunction &maxBoundsFunction, int cellWidth, int cellHeight, msdfgen::Shape::Bounds &maxBounds, double &maxWidth, double &maxHeight) const {
     static const int BIG_VALUE = 1<<28;
     if (cellWidth <= 0)
         cellWidth = BIG_VALUE;
@@ -145,7 +310,7 @@ double GridAtlasPacker::scaleToFit(GlyphGeometry *glyphs, int count, int cellWid
     --cellWidth, --cellHeight; // Implicit half-pixel padding from each side to make sure that no representable values are beyond outermost pixel centers
     cellWidth -= spacing, cellHeight -= spacing;
     bool lastResult = false;
-    #define TRY_FIT(scale) (maxWidth = 0, maxHeight = 0, maxBounds = getMaxBounds(maxWidth, maxHeight, glyphs, count, (scale), -(unitRange.lower+pxRange.lower/(scale))), lastResult = maxWidth <= cellWidth && maxHeight <= cellHeight)
+    #define TRY_FIT(scale) (maxWidth = 0, maxHeight = 0, maxBounds = getMaxBounds(maxWidth, maxHeight, maxBoundsFunction, (scale), -(unitRange.lower+pxRange.lower/(scale))), lastResult = maxWidth <= cellWidth && maxHeight <= cellHeight)
     double minScale = 1, maxScale = 1;
     if (TRY_FIT(1)) {
         while (maxScale < 1e+32 && ((maxScale = 2*minScale), TRY_FIT(maxScale)))
@@ -168,11 +333,19 @@ double GridAtlasPacker::scaleToFit(GlyphGeometry *glyphs, int count, int cellWid
     return minScale;
 }
 
-// Can this spaghetti code be simplified?
-// Idea: Maybe it could be rewritten into a while (not all properties deduced) cycle, and compute one value in each iteration
 int GridAtlasPacker::pack(GlyphGeometry *glyphs, int count) {
     if (!count)
         return 0;
+    Instrumentation::Scope scope(Instrumentation::PACKING);
+    scope.addGlyphs(count);
+    MaxBoundsFunction maxBoundsFunction;
+    computeMaxBoundsFunction(maxBoundsFunction, glyphs, count);
+    return pack(glyphs, count, maxBoundsFunction);
+}
+
+// Can this spaghetti code be simplified?
+// Idea: Maybe it could be rewritten into a while (not all properties deduced) cycle, and compute one value in each iteration
+int GridAtlasPacker::pack(GlyphGeometry *glyphs, int count, const MaxBoundsFunction &maxBoundsFunction) {
     GridAtlasPacker initial(*this);
     int cellCount = 0;
     if (columns > 0 && rows > 0)
@@ -223,11 +396,11 @@ int GridAtlasPacker::pack(GlyphGeometry *glyphs, int count) {
         if (pxRange.lower != pxRange.upper && miterLimit > 0) {
 
             if (cellWidth > 0 || cellHeight > 0) {
-                scale = scaleToFit(glyphs, count, cellWidth, cellHeight, maxBounds, maxWidth, maxHeight);
+                scale = scaleToFit(maxBoundsFunction, cellWidth, cellHeight, maxBounds, maxWidth, maxHeight);
                 if (scale < minScale) {
                     scale = minScale;
                     cutoff = true;
-                    maxBounds = getMaxBounds(maxWidth, maxHeight, glyphs, count, scale, -(unitRange.lower+pxRange.lower/scale));
+                    maxBounds = getMaxBounds(maxWidth, maxHeight, maxBoundsFunction, scale, -(unitRange.lower+pxRange.lower/scale));
                 }
             }
 
@@ -241,7 +414,7 @@ int GridAtlasPacker::pack(GlyphGeometry *glyphs, int count) {
                     int tHeight = (height+spacing)/rows;
                     lowerToConstraint(tWidth, tHeight, cellDimensionsConstraint);
                     if (tWidth > 0 && tHeight > 0) {
-                        double curScale = scaleToFit(glyphs, count, tWidth, tHeight, maxBounds, maxWidth, maxHeight);
+                        double curScale = scaleToFit(maxBoundsFunction, tWidth, tHeight, maxBounds, maxWidth, maxHeight);
                         if (curScale > scale) {
                             scale = curScale;
                             bestCols = cols;
@@ -257,7 +430,7 @@ int GridAtlasPacker::pack(GlyphGeometry *glyphs, int count) {
                     tHeight = (height+spacing)/rows;
                     lowerToConstraint(tWidth, tHeight, cellDimensionsConstraint);
                     if (tWidth > 0 && tHeight > 0) {
-                        double curScale = scaleToFit(glyphs, count, tWidth, tHeight, maxBounds, maxWidth, maxHeight);
+                        double curScale = scaleToFit(maxBoundsFunction, tWidth, tHeight, maxBounds, maxWidth, maxHeight);
                         if (curScale > scale) {
                             scale = curScale;
                             bestCols = cols;
@@ -281,19 +454,19 @@ int GridAtlasPacker::pack(GlyphGeometry *glyphs, int count) {
                 cellWidth = (width+spacing)/columns;
                 cellHeight = (height+spacing)/rows;
                 lowerToConstraint(cellWidth, cellHeight, cellDimensionsConstraint);
-                scale = scaleToFit(glyphs, count, cellWidth, cellHeight, maxBounds, maxWidth, maxHeight);
+                scale = scaleToFit(maxBoundsFunction, cellWidth, cellHeight, maxBounds, maxWidth, maxHeight);
                 if (scale < minScale)
                     scale = -1;
             }
 
             if (scale <= 0) {
-                maxBounds = getMaxBounds(maxWidth, maxHeight, glyphs, count, minScale, -(unitRange.lower+pxRange.lower/minScale));
+                maxBounds = getMaxBounds(maxWidth, maxHeight, maxBoundsFunction, minScale, -(unitRange.lower+pxRange.lower/minScale));
                 cellWidth = (int) ceil(maxWidth)+spacing+1;
                 cellHeight = (int) ceil(maxHeight)+spacing+1;
                 raiseToConstraint(cellWidth, cellHeight, cellDimensionsConstraint);
-                scale = scaleToFit(glyphs, count, cellWidth, cellHeight, maxBounds, maxWidth, maxHeight);
+                scale = scaleToFit(maxBoundsFunction, cellWidth, cellHeight, maxBounds, maxWidth, maxHeight);
                 if (scale < minScale)
-                    maxBounds = getMaxBounds(maxWidth, maxHeight, glyphs, count, scale = minScale, -(unitRange.lower+pxRange.lower/minScale));
+                    maxBounds = getMaxBounds(maxWidth, maxHeight, maxBoundsFunction, scale = minScale, -(unitRange.lower+pxRange.lower/minScale));
             }
 
             if (initial.rows < 0 && initial.cellHeight < 0) {
@@ -308,7 +481,7 @@ int GridAtlasPacker::pack(GlyphGeometry *glyphs, int count) {
         } else {
 
             Padding pxPadding = innerPxPadding+outerPxPadding;
-            maxBounds = getMaxBounds(maxWidth, maxHeight, glyphs, count, 1, -unitRange.lower);
+            maxBounds = getMaxBounds(maxWidth, maxHeight, maxBoundsFunction, 1, -unitRange.lower);
             // Undo pxPadding added by getMaxBounds before pixel scale is known
             pad(maxBounds, -pxPadding);
             maxWidth -= pxPadding.l+pxPadding.r;
@@ -409,7 +582,7 @@ int GridAtlasPacker::pack(GlyphGeometry *glyphs, int count) {
         }
 
     } else {
-        maxBounds = getMaxBounds(maxWidth, maxHeight, glyphs, count, scale, -(unitRange.lower+pxRange.lower/scale));
+        maxBounds = getMaxBounds(maxWidth, maxHeight, maxBoundsFunction, scale, -(unitRange.lower+pxRange.lower/scale));
         int optimalCellWidth = (int) ceil(maxWidth)+spacing+1;
         int optimalCellHeight = (int) ceil(maxHeight)+spacing+1;
         if (cellWidth < 0 || cellHeight < 0) {
@@ -472,7 +645,7 @@ int GridAtlasPacker::pack(GlyphGeometry *glyphs, int count) {
             columns = initial.columns;
             rows = initial.rows;
             scale = initial.scale;
-            return pack(glyphs, count);
+            return pack(glyphs, count, maxBoundsFunction);
         }
     }
 
@@ -600,6 +773,10 @@ void GridAtlasPacker::setOuterPixelPadding(const Padding &padding) {
     outerPxPadding = padding;
 }
 
+void GridAtlasPacker::setThreadCount(int threadCount) {
+    this->threadCount = threadCount;
+}
+
 void GridAtlasPacker::getDimensions(int &width, int &height) const {
     width = this->width, height = this->height;
 }
@@ -57,6 +57,8 @@ public:
     void setInnerPixelPadding(const Padding &padding);
     /// Sets the pixel component of width of additional padding around each glyph quad
     void setOuterPixelPadding(const Padding &padding);
+    /// Sets the number of threads to be used to compute the bounds of glyphs
+    void setThreadCount(int threadCount);
 
     /// Outputs the atlas's final dimensions
     void getDimensions(int &width, int &height) const;
@@ -76,6 +78,9 @@ public:
     bool hasCutoff() const;
 
 private:
+    /// Maximum glyph bounds as piecewise linear functions of the outer range, so that they can be evaluated for any scale without iterating over the glyphs
+    struct MaxBoundsFunction;
+
     int columns, rows;
     int width, height;
     int cellWidth, cellHeight;
@@ -95,13 +100,18 @@ private:
     double scaleMaximizationTolerance;
     double alignedColumnsBias;
     bool cutoff;
+    int threadCount;
 
     static void lowerToConstraint(int &width, int &height, DimensionsConstraint constraint);
     static void raiseToConstraint(int &width, int &height, DimensionsConstraint constraint);
 
     double dimensionsRating(int width, int height, bool aligned) const;
-    msdfgen::Shape::Bounds getMaxBounds(double &maxWidth, double &maxHeight, GlyphGeometry *glyphs, int count, double scale, double outerRange) const;
-    double scaleToFit(GlyphGeometry *glyphs, int count, int cellWidth, int cellHeight, msdfgen::Shape::Bounds &maxBounds, double &maxWidth, double &maxHeight) const;
+    static void computeMaxBoundsFunction(MaxBoundsFunction &maxBoundsFunction, const GlyphGeometry *glyphs, int count, double miterLimit);
+
+    void computeMaxBoundsFunction(MaxBoundsFunction &maxBoundsFunction, const GlyphGeometry *glyphs, int count) const;
+    msdfgen::Shape::Bounds getMaxBounds(double &maxWidth, double &maxHeight, const MaxBoundsFunction &maxBoundsFunction, double scale, double outerRange) const;
+    double scaleToFit(const MaxBoundsFunction &maxBoundsFunction, int cellWidth, int cellHeight, msdfgen::Shape::Bounds &maxBounds, double &maxWidth, double &maxHeight) const;
+    int pack(GlyphGeometry *glyphs, int count, const MaxBoundsFunction &maxBoundsFunction);
 
 };
 
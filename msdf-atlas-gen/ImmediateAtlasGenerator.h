@@ -29,10 +29,14 @@ public:
     void setAttributes(const GeneratorAttributes &attributes);
     /// Sets the number of threads to be run by generate
     void setThreadCount(int threadCount);
+    /// Enables recording of the generation time, edge count and box size of each glyph by generate
+    void setProfiling(bool enabled);
     /// Allows access to the underlying AtlasStorage
     const AtlasStorage &atlasStorage() const;
     /// Returns the layout of the contained glyphs as a list of GlyphBoxes
     const std::vector<GlyphBox> &getLayout() const;
+    /// Returns the measurements of glyphs generated while profiling was enabled
+    const std::vector<GlyphProfile> &getProfile() const;
 
 private:
     AtlasStorage storage;
@@ -41,6 +45,8 @@ private:
     std::vector<byte> errorCorrectionBuffer;
     GeneratorAttributes attributes;
     int threadCount;
+    bool profiling;
+    std::vector<GlyphProfile> profile;
 
 };
 
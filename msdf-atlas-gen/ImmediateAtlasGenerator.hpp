@@ -2,49 +2,115 @@
 #include "ImmediateAtlasGenerator.h"
 
 #include <algorithm>
+#include <set>
+#include <chrono>
+#include "bitmap-blit.h"
+#include "Instrumentation.h"
 
 namespace msdf_atlas {
 
 template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
-ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::ImmediateAtlasGenerator() : threadCount(1) { }
+ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::ImmediateAtlasGenerator() : threadCount(1), profiling(false) { }
 
 template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
-ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::ImmediateAtlasGenerator(int width, int height) : storage(width, height), threadCount(1) { }
+ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::ImmediateAtlasGenerator(int width, int height) : storage(width, height), threadCount(1), profiling(false) { }
 
 template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
 template <typename... ARGS>
-ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::ImmediateAtlasGenerator(int width, int height, ARGS... storageArgs) : storage(width, height, storageArgs...), threadCount(1) { }
+ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::ImmediateAtlasGenerator(int width, int height, ARGS... storageArgs) : storage(width, height, storageArgs...), threadCount(1), profiling(false) { }
 
 template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
 void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::generate(const GlyphGeometry *glyphs, int count) {
     int maxBoxArea = 0;
+    bool anyRotated = false;
     for (int i = 0; i < count; ++i) {
         GlyphBox box = glyphs[i];
         maxBoxArea = std::max(maxBoxArea, box.rect.w*box.rect.h);
+        anyRotated |= box.rotated;
         layout.push_back((GlyphBox &&) box);
     }
-    int threadBufferSize = N*maxBoxArea;
+    // Rotated glyphs need a second buffer for the rotated bitmap
+    int threadBufferSize = (anyRotated ? 2 : 1)*N*maxBoxArea;
     if (threadCount*threadBufferSize > (int) glyphBuffer.size())
         glyphBuffer.resize(threadCount*threadBufferSize);
     if (threadCount*maxBoxArea > (int) errorCorrectionBuffer.size())
         errorCorrectionBuffer.resize(threadCount*maxBoxArea);
+    // Glyphs sharing a box with a preceding glyph (deduplicated) are only generated once
+    std::vector<bool> sharedBox(count, false);
+    {
+        std::set<std::pair<int, int> > boxPositions;
+        for (int i = 0; i < count; ++i) {
+            if (!glyphs[i].isWhitespace()) {
+                Rectangle rect = glyphs[i].getBoxRect();
+                if (rect.w > 0 && rect.h > 0)
+                    sharedBox[i] = !boxPositions.insert(std::make_pair(rect.x, rect.y)).second;
+            }
+        }
+    }
     std::vector<GeneratorAttributes> threadAttributes(threadCount);
+    std::vector<double> threadErrorCorrectionTimes(profiling ? threadCount : 0);
+    std::vector<GlyphComplexity> threadComplexities(profiling ? threadCount : 0);
     for (int i = 0; i < threadCount; ++i) {
         threadAttributes[i] = attributes;
         threadAttributes[i].config.errorCorrection.buffer = errorCorrectionBuffer.data()+i*maxBoxArea;
+        if (profiling) {
+            threadAttributes[i].errorCorrectionTime = &threadErrorCorrectionTimes[i];
+            threadAttributes[i].complexity = &threadComplexities[i];
+        }
+    }
+    // Records of glyphs that are not generated keep index -1
+    std::vector<GlyphProfile> glyphProfiles;
+    if (profiling) {
+        GlyphProfile notGenerated = { };
+        notGenerated.index = -1;
+        glyphProfiles.resize(count, notGenerated);
     }
 
-    Workload([this, glyphs, &threadAttributes, threadBufferSize](int i, int threadNo) -> bool {
+    Workload([this, glyphs, &sharedBox, &threadAttributes, &threadErrorCorrectionTimes, &threadComplexities, &glyphProfiles, threadBufferSize](int i, int threadNo) -> bool {
         const GlyphGeometry &glyph = glyphs[i];
-        if (!glyph.isWhitespace()) {
+        if (!glyph.isWhitespace() && !sharedBox[i]) {
             int l, b, w, h;
             glyph.getBoxRect(l, b, w, h);
             msdfgen::BitmapRef<T, N> glyphBitmap(glyphBuffer.data()+threadNo*threadBufferSize, w, h);
-            GEN_FN(glyphBitmap, glyph, threadAttributes[threadNo]);
-            storage.put(l, b, msdfgen::BitmapConstSection<T, N>(glyphBitmap));
+            {
+                Instrumentation::Scope generation(Instrumentation::GENERATION);
+                std::chrono::steady_clock::time_point start;
+                if (profiling) {
+                    threadErrorCorrectionTimes[threadNo] = 0;
+                    threadComplexities[threadNo] = GlyphComplexity::COMPLEX;
+                    start = std::chrono::steady_clock::now();
+                }
+                GEN_FN(glyphBitmap, glyph, threadAttributes[threadNo]);
+                if (profiling) {
+                    GlyphProfile &glyphProfile = glyphProfiles[i];
+                    glyphProfile.time = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+                    glyphProfile.index = glyph.getIndex();
+                    glyphProfile.codepoint = glyph.getCodepoint();
+                    glyphProfile.edgeCount = glyph.getShape().edgeCount();
+                    glyphProfile.pixelCount = w*h;
+                    glyphProfile.errorCorrectionTime = threadErrorCorrectionTimes[threadNo];
+                    glyphProfile.complexity = threadComplexities[threadNo];
+                }
+                generation.addGlyphs(1);
+                generation.addEdges(glyph.getShape().edgeCount());
+                generation.addPixels((unsigned long long) w*h);
+            }
+            Instrumentation::Scope blit(Instrumentation::BLIT);
+            if (glyph.isBoxRotated()) {
+                msdfgen::BitmapRef<T, N> rotatedBitmap(glyphBuffer.data()+threadNo*threadBufferSize+N*w*h, h, w);
+                blitRotated(rotatedBitmap, glyphBitmap);
+                storage.put(l, b, msdfgen::BitmapConstSection<T, N>(rotatedBitmap));
+            } else
+                storage.put(l, b, msdfgen::BitmapConstSection<T, N>(glyphBitmap));
+            blit.addPixels((unsigned long long) w*h);
+            blit.addBytes((unsigned long long) sizeof(T)*N*w*h);
         }
         return true;
     }, count).finish(threadCount);
+    for (const GlyphProfile &glyphProfile : glyphProfiles) {
+        if (glyphProfile.index >= 0)
+            profile.push_back(glyphProfile);
+    }
 }
 
 template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
@@ -73,6 +139,11 @@ void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::setThreadCount(int thr
     this->threadCount = threadCount;
 }
 
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::setProfiling(bool enabled) {
+    profiling = enabled;
+}
+
 template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
 const AtlasStorage &ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::atlasStorage() const {
     return storage;
@@ -83,4 +154,9 @@ const std::vector<GlyphBox> &ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>
     return layout;
 }
 
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+const std::vector<GlyphProfile> &ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::getProfile() const {
+    return profile;
+}
+
 }
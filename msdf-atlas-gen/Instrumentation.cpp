@@ -0,0 +1,136 @@
+
+#include "Instrumentation.h"
+
+#include <cstdio>
+#include <atomic>
+#include "TextFileWriter.h"
+
+namespace msdf_atlas {
+
+namespace {
+
+struct StageCounters {
+    std::atomic<unsigned long long> nanoseconds;
+    std::atomic<unsigned long long> calls;
+    std::atomic<unsigned long long> glyphs, edges, pixels, bytes;
+};
+
+}
+
+static std::atomic<bool> instrumentationEnabled(false);
+static StageCounters stageCounters[Instrumentation::STAGE_COUNT];
+
+Instrumentation::Scope::Scope(Stage stage) : stage(stage), active(instrumentationEnabled.load(std::memory_order_relaxed)), glyphs(), edges(), pixels(), bytes() {
+    if (active)
+        start = std::chrono::steady_clock::now();
+}
+
+Instrumentation::Scope::~Scope() {
+    if (active) {
+        StageCounters &counters = stageCounters[stage];
+        counters.nanoseconds.fetch_add((unsigned long long) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-start).count(), std::memory_order_relaxed);
+        counters.calls.fetch_add(1, std::memory_order_relaxed);
+        counters.glyphs.fetch_add(glyphs, std::memory_order_relaxed);
+        counters.edges.fetch_add(edges, std::memory_order_relaxed);
+        counters.pixels.fetch_add(pixels, std::memory_order_relaxed);
+        counters.bytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+}
+
+void Instrumentation::Scope::addGlyphs(unsigned long long count) {
+    glyphs += count;
+}
+
+void Instrumentation::Scope::addEdges(unsigned long long count) {
+    edges += count;
+}
+
+void Instrumentation::Scope::addPixels(unsigned long long count) {
+    pixels += count;
+}
+
+void Instrumentation::Scope::addBytes(unsigned long long count) {
+    bytes += count;
+}
+
+void Instrumentation::setEnabled(bool enabled) {
+    instrumentationEnabled.store(enabled);
+}
+
+bool Instrumentation::isEnabled() {
+    return instrumentationEnabled.load(std::memory_order_relaxed);
+}
+
+void Instrumentation::reset() {
+    for (StageCounters &counters : stageCounters) {
+        counters.nanoseconds.store(0);
+        counters.calls.store(0);
+        counters.glyphs.store(0);
+        counters.edges.store(0);
+        counters.pixels.store(0);
+        counters.bytes.store(0);
+    }
+}
+
+Instrumentation::Statistics Instrumentation::getStatistics(Stage stage) {
+    const StageCounters &counters = stageCounters[stage];
+    Statistics statistics;
+    statistics.time = 1e-9*(double) counters.nanoseconds.load();
+    statistics.calls = counters.calls.load();
+    statistics.glyphs = counters.glyphs.load();
+    statistics.edges = counters.edges.load();
+    statistics.pixels = counters.pixels.load();
+    statistics.bytes = counters.bytes.load();
+    return statistics;
+}
+
+const char *Instrumentation::getStageName(Stage stage) {
+    switch (stage) {
+        case FONT_LOADING: return "fontLoading";
+        case GEOMETRY_PREPROCESSING: return "geometryPreprocessing";
+        case EDGE_COLORING: return "edgeColoring";
+        case PACKING: return "packing";
+        case GENERATION: return "generation";
+        case ERROR_CORRECTION: return "errorCorrection";
+        case BLIT: return "blit";
+        case ENCODING: return "encoding";
+        case IMAGE_SAVE: return "imageSave";
+        default:;
+    }
+    return nullptr;
+}
+
+bool Instrumentation::exportJSON(const char *filename, double wallTime) {
+    FILE *f = fopen(filename, "w");
+    if (!f)
+        return false;
+    TextFileWriter writer(f);
+    writer.writeString("{\"wallTime\":");
+    writer.writeReal(wallTime);
+    writer.writeString(",\"stages\":{");
+    for (int i = 0; i < STAGE_COUNT; ++i) {
+        Statistics statistics = getStatistics(Stage(i));
+        if (i)
+            writer.writeChar(',');
+        writer.writeChar('"');
+        writer.writeString(getStageName(Stage(i)));
+        writer.writeString("\":{\"time\":");
+        writer.writeReal(statistics.time);
+        writer.writeString(",\"calls\":");
+        writer.writeInteger((long long) statistics.calls);
+        writer.writeString(",\"glyphs\":");
+        writer.writeInteger((long long) statistics.glyphs);
+        writer.writeString(",\"edges\":");
+        writer.writeInteger((long long) statistics.edges);
+        writer.writeString(",\"pixels\":");
+        writer.writeInteger((long long) statistics.pixels);
+        writer.writeString(",\"bytes\":");
+        writer.writeInteger((long long) statistics.bytes);
+        writer.writeChar('}');
+    }
+    writer.writeString("}}\n");
+    bool success = writer.flush();
+    return fclose(f) == 0 && success;
+}
+
+}
@@ -0,0 +1,79 @@
+
+#pragma once
+
+#include <chrono>
+
+namespace msdf_atlas {
+
+/**
+ * Process-wide per-stage timers and counters of atlas generation. Disabled by default, in which case the scopes cost a single flag check.
+ * Statistics are accumulated atomically, so they are valid when stages run in multiple threads, but stage times are then summed over all threads.
+ */
+class Instrumentation {
+
+public:
+    enum Stage {
+        /// Loading of glyph outlines and kerning from the font file
+        FONT_LOADING,
+        /// Resolution of self-intersections and overlaps, normalization and orientation of the glyph geometry
+        GEOMETRY_PREPROCESSING,
+        EDGE_COLORING,
+        PACKING,
+        /// Generation of the glyphs' distance fields, includes ERROR_CORRECTION
+        GENERATION,
+        /// MSDF / MTSDF error correction, which is part of GENERATION
+        ERROR_CORRECTION,
+        /// Copying of generated glyphs into the atlas storage
+        BLIT,
+        /// Encoding of the atlas into an image format in memory
+        ENCODING,
+        /// Encoding and writing of atlas image files
+        IMAGE_SAVE,
+
+        STAGE_COUNT
+    };
+
+    struct Statistics {
+        /// Total time spent in the stage in seconds
+        double time;
+        /// Number of scopes of the stage
+        unsigned long long calls;
+        unsigned long long glyphs, edges, pixels, bytes;
+    };
+
+    /// Times a single invocation of a stage from its construction to its destruction and adds its counters to the stage's statistics
+    class Scope {
+
+    public:
+        explicit Scope(Stage stage);
+        ~Scope();
+        void addGlyphs(unsigned long long count);
+        void addEdges(unsigned long long count);
+        void addPixels(unsigned long long count);
+        void addBytes(unsigned long long count);
+
+    private:
+        Stage stage;
+        bool active;
+        std::chrono::steady_clock::time_point start;
+        unsigned long long glyphs, edges, pixels, bytes;
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    };
+
+    /// Enables or disables the collection of statistics
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+    /// Resets statistics of all stages to zero
+    static void reset();
+    static Statistics getStatistics(Stage stage);
+    /// Returns the stage's identifier as used in the JSON output
+    static const char *getStageName(Stage stage);
+    /// Writes statistics of all stages and the total elapsed time (wallTime) into a JSON file
+    static bool exportJSON(const char *filename, double wallTime);
+
+};
+
+}
@@ -0,0 +1,88 @@
+
+#pragma once
+
+#include <deque>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <msdfgen.h>
+#include <msdfgen-ext.h>
+#include "types.h"
+#include "GlyphGeometry.h"
+#include "FontGeometry.h"
+#include "DynamicAtlas.h"
+
+namespace msdf_atlas {
+
+/**
+ * A font atlas that is populated on demand. Each glyph is loaded from the font, edge-colored, packed into the DynamicAtlas
+ * and generated the first time its codepoint is looked up, after which it is cached.
+ * Lookups of glyphs that have already been loaded (or found missing) are lock-free and may be performed from any thread.
+ * Loading is serialized by a mutex, and the atlas storage must not be accessed by other threads while a glyph is being loaded.
+ * Glyphs are added to the atlas without rearrangement, so a glyph's placement never changes once it has been returned.
+ */
+template <class AtlasGenerator>
+class LazyFontAtlas {
+
+public:
+    typedef typename DynamicAtlas<AtlasGenerator>::ChangeFlags ChangeFlags;
+
+    LazyFontAtlas(DynamicAtlas<AtlasGenerator> &atlas, const GlyphGeometry::GlyphAttributes &glyphAttributes);
+    ~LazyFontAtlas();
+    /// Sets the font whose glyphs are loaded and its scale, returns false if its metrics cannot be loaded. Must be called before any lookups
+    bool setFont(msdfgen::FontHandle *font, double fontScale, bool preprocessGeometry = true);
+    /// Sets the edge coloring applied to each glyph as it is loaded, the seed is varied per glyph the same way as in the standalone program
+    void setEdgeColoring(void (*fn)(msdfgen::Shape &, double, unsigned long long), double angleThreshold, unsigned long long seed);
+    /// Returns the glyph of the codepoint as placed in the atlas, loading it first if necessary, or null if the font doesn't contain it
+    const GlyphGeometry *getGlyph(unicode_t codepoint);
+    /// Returns the glyph of the codepoint if it has already been loaded, never loads it
+    const GlyphGeometry *findGlyph(unicode_t codepoint) const;
+    /// Outputs the advance between two glyphs with kerning taken into consideration, loading the glyphs if necessary, returns false on failure
+    bool getAdvance(double &advance, unicode_t codepoint1, unicode_t codepoint2);
+    /// Returns the processed font metrics
+    const msdfgen::FontMetrics &getMetrics() const;
+    /// Returns the number of glyphs added to the atlas so far - its contents have changed whenever this number increases
+    int getGlyphCount() const;
+    /// Returns the atlas change flags accumulated since the last call and resets them
+    ChangeFlags resetChangeFlags();
+
+private:
+    enum {
+        PAGE_BITS = 8,
+        PAGE_SIZE = 1<<PAGE_BITS,
+        PAGE_COUNT = (0x10ffff>>PAGE_BITS)+1
+    };
+
+    /// Lookup table of a range of PAGE_SIZE consecutive codepoints, slots hold null until the glyph is loaded
+    struct Page {
+        std::atomic<const GlyphGeometry *> glyphs[PAGE_SIZE];
+    };
+
+    DynamicAtlas<AtlasGenerator> &atlas;
+    GlyphGeometry::GlyphAttributes glyphAttributes;
+    msdfgen::FontHandle *font;
+    FontGeometry fontGeometry;
+    bool preprocessGeometry;
+    void (*edgeColoringFn)(msdfgen::Shape &, double, unsigned long long);
+    double angleThreshold;
+    unsigned long long coloringSeed;
+    std::atomic<Page *> pages[PAGE_COUNT];
+    /// Loaded glyphs, never relocated
+    std::deque<GlyphGeometry> glyphs;
+    /// Marks codepoints that are not present in the font
+    GlyphGeometry missingGlyph;
+    std::map<std::pair<int, int>, double> kerning;
+    std::mutex mutex;
+    std::atomic<int> glyphCount;
+    std::atomic<int> changeFlags;
+
+    const GlyphGeometry *loadGlyph(unicode_t codepoint);
+
+    LazyFontAtlas(const LazyFontAtlas &) = delete;
+    LazyFontAtlas &operator=(const LazyFontAtlas &) = delete;
+
+};
+
+}
+
+#include "LazyFontAtlas.hpp"
@@ -0,0 +1,128 @@
+
+#include "LazyFontAtlas.h"
+
+#include <utility>
+#include "edge-coloring-seed.h"
+
+namespace msdf_atlas {
+
+template <class AtlasGenerator>
+LazyFontAtlas<AtlasGenerator>::LazyFontAtlas(DynamicAtlas<AtlasGenerator> &atlas, const GlyphGeometry::GlyphAttributes &glyphAttributes) : atlas(atlas), glyphAttributes(glyphAttributes), font(nullptr), preprocessGeometry(true), edgeColoringFn(&msdfgen::edgeColoringInkTrap), angleThreshold(3.0), coloringSeed(0), glyphCount(0), changeFlags(0) {
+    for (std::atomic<Page *> &page : pages)
+        page.store(nullptr, std::memory_order_relaxed);
+}
+
+template <class AtlasGenerator>
+LazyFontAtlas<AtlasGenerator>::~LazyFontAtlas() {
+    for (std::atomic<Page *> &page : pages)
+        delete page.load(std::memory_order_relaxed);
+}
+
+template <class AtlasGenerator>
+bool LazyFontAtlas<AtlasGenerator>::setFont(msdfgen::FontHandle *font, double fontScale, bool preprocessGeometry) {
+    if (!(font && fontGeometry.loadMetrics(font, fontScale)))
+        return false;
+    this->font = font;
+    this->preprocessGeometry = preprocessGeometry;
+    return true;
+}
+
+template <class AtlasGenerator>
+void LazyFontAtlas<AtlasGenerator>::setEdgeColoring(void (*fn)(msdfgen::Shape &, double, unsigned long long), double angleThreshold, unsigned long long seed) {
+    edgeColoringFn = fn;
+    this->angleThreshold = angleThreshold;
+    coloringSeed = seed;
+}
+
+template <class AtlasGenerator>
+const GlyphGeometry *LazyFontAtlas<AtlasGenerator>::getGlyph(unicode_t codepoint) {
+    if (codepoint >= (unicode_t) PAGE_COUNT*PAGE_SIZE)
+        return nullptr;
+    if (const Page *page = pages[codepoint>>PAGE_BITS].load(std::memory_order_acquire)) {
+        if (const GlyphGeometry *glyph = page->glyphs[codepoint&(PAGE_SIZE-1)].load(std::memory_order_acquire))
+            return glyph != &missingGlyph ? glyph : nullptr;
+    }
+    return loadGlyph(codepoint);
+}
+
+template <class AtlasGenerator>
+const GlyphGeometry *LazyFontAtlas<AtlasGenerator>::findGlyph(unicode_t codepoint) const {
+    if (codepoint >= (unicode_t) PAGE_COUNT*PAGE_SIZE)
+        return nullptr;
+    if (const Page *page = pages[codepoint>>PAGE_BITS].load(std::memory_order_acquire)) {
+        const GlyphGeometry *glyph = page->glyphs[codepoint&(PAGE_SIZE-1)].load(std::memory_order_acquire);
+        if (glyph != &missingGlyph)
+            return glyph;
+    }
+    return nullptr;
+}
+
+template <class AtlasGenerator>
+const GlyphGeometry *LazyFontAtlas<AtlasGenerator>::loadGlyph(unicode_t codepoint) {
+    std::lock_guard<std::mutex> lock(mutex);
+    // The page and the glyph may have been created by another thread in the meantime
+    Page *page = pages[codepoint>>PAGE_BITS].load(std::memory_order_relaxed);
+    if (!page) {
+        page = new Page;
+        for (std::atomic<const GlyphGeometry *> &slot : page->glyphs)
+            slot.store(nullptr, std::memory_order_relaxed);
+        pages[codepoint>>PAGE_BITS].store(page, std::memory_order_release);
+    }
+    std::atomic<const GlyphGeometry *> &slot = page->glyphs[codepoint&(PAGE_SIZE-1)];
+    if (const GlyphGeometry *glyph = slot.load(std::memory_order_relaxed))
+        return glyph != &missingGlyph ? glyph : nullptr;
+
+    const GlyphGeometry *result = &missingGlyph;
+    GlyphGeometry glyph;
+    if (font && glyph.load(font, fontGeometry.getGeometryScale(), codepoint, preprocessGeometry)) {
+        if (edgeColoringFn) {
+            // Same per-glyph seed as the standalone program, independent of load order
+            glyph.edgeColoring(edgeColoringFn, angleThreshold, glyphColoringSeed(coloringSeed, (unsigned long long) glyph.getIndex()));
+        }
+        glyph.wrapBox(glyphAttributes);
+        glyphs.push_back((GlyphGeometry &&) glyph);
+        GlyphGeometry &placedGlyph = glyphs.back();
+        changeFlags.fetch_or(atlas.add(&placedGlyph, 1, false));
+        glyphCount.fetch_add(1);
+        result = &placedGlyph;
+    }
+    slot.store(result, std::memory_order_release);
+    return result != &missingGlyph ? result : nullptr;
+}
+
+template <class AtlasGenerator>
+bool LazyFontAtlas<AtlasGenerator>::getAdvance(double &advance, unicode_t codepoint1, unicode_t codepoint2) {
+    const GlyphGeometry *glyph1 = getGlyph(codepoint1);
+    const GlyphGeometry *glyph2 = getGlyph(codepoint2);
+    if (!(glyph1 && glyph2))
+        return false;
+    advance = glyph1->getAdvance();
+    std::lock_guard<std::mutex> lock(mutex);
+    std::pair<int, int> key(glyph1->getIndex(), glyph2->getIndex());
+    std::map<std::pair<int, int>, double>::const_iterator it = kerning.find(key);
+    if (it == kerning.end()) {
+        double kern = 0;
+        if (!msdfgen::getKerning(kern, font, glyph1->getGlyphIndex(), glyph2->getGlyphIndex(), msdfgen::FONT_SCALING_NONE))
+            kern = 0;
+        it = kerning.insert(std::make_pair(key, fontGeometry.getGeometryScale()*kern)).first;
+    }
+    advance += it->second;
+    return true;
+}
+
+template <class AtlasGenerator>
+const msdfgen::FontMetrics &LazyFontAtlas<AtlasGenerator>::getMetrics() const {
+    return fontGeometry.getMetrics();
+}
+
+template <class AtlasGenerator>
+int LazyFontAtlas<AtlasGenerator>::getGlyphCount() const {
+    return glyphCount.load();
+}
+
+template <class AtlasGenerator>
+typename LazyFontAtlas<AtlasGenerator>::ChangeFlags LazyFontAtlas<AtlasGenerator>::resetChangeFlags() {
+    return changeFlags.exchange(0);
+}
+
+}
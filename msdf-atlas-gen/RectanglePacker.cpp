@@ -2,6 +2,7 @@
 #include "RectanglePacker.h"
 
 #include <algorithm>
+#include <utility>
 
 namespace msdf_atlas {
 
@@ -18,27 +19,63 @@ int RectanglePacker::rateFit(int w, int h, int sw, int sh) {
     return std::min(sw-w, sh-h);
 }
 
+static void setRotated(Rectangle &, bool) { }
+
+static void setRotated(OrientedRectangle &rect, bool rotated) {
+    rect.rotated = rotated;
+}
+
+static bool containsRectangle(const Rectangle &outer, const Rectangle &inner) {
+    return inner.x >= outer.x && inner.y >= outer.y && inner.x+inner.w <= outer.x+outer.w && inner.y+inner.h <= outer.y+outer.h;
+}
+
 RectanglePacker::RectanglePacker() : RectanglePacker(0, 0) { }
 
-RectanglePacker::RectanglePacker(int width, int height) {
-    if (width > 0 && height > 0)
-        spaces.push_back(Rectangle { 0, 0, width, height });
+RectanglePacker::RectanglePacker(int width, int height, PackingAlgorithm algorithm) : algorithm(algorithm), width(0), height(0), shelfY(0), shelfHeight(0), shelfX(0) {
+    expand(width, height);
 }
 
 void RectanglePacker::expand(int width, int height) {
     if (width > 0 && height > 0) {
-        int oldWidth = 0, oldHeight = 0;
-        for (const Rectangle &space : spaces) {
-            if (space.x+space.w > oldWidth)
-                oldWidth = space.x+space.w;
-            if (space.y+space.h > oldHeight)
-                oldHeight = space.y+space.h;
+        int oldWidth = this->width, oldHeight = this->height;
+        this->width = width, this->height = height;
+        switch (algorithm) {
+            case PackingAlgorithm::GUILLOTINE:
+                spaces.push_back(Rectangle { 0, 0, width, height });
+                splitSpace(int(spaces.size()-1), oldWidth, oldHeight);
+                break;
+            case PackingAlgorithm::MAX_RECTS:
+                // Free rectangles adjacent to the old boundary extend into the new area
+                for (Rectangle &space : spaces) {
+                    if (space.x+space.w == oldWidth)
+                        space.w = width-space.x;
+                    if (space.y+space.h == oldHeight)
+                        space.h = height-space.y;
+                }
+                if (width > oldWidth)
+                    spaces.push_back(Rectangle { oldWidth, 0, width-oldWidth, height });
+                if (height > oldHeight)
+                    spaces.push_back(Rectangle { 0, oldHeight, width, height-oldHeight });
+                pruneSpaces();
+                break;
+            case PackingAlgorithm::SKYLINE:
+                if (width > oldWidth) {
+                    if (!skyline.empty() && skyline.back().y == 0)
+                        skyline.back().w += width-oldWidth;
+                    else
+                        skyline.push_back(SkylineNode { oldWidth, 0, width-oldWidth });
+                }
+                break;
+            case PackingAlgorithm::SHELF:
+                break;
         }
-        spaces.push_back(Rectangle { 0, 0, width, height });
-        splitSpace(int(spaces.size()-1), oldWidth, oldHeight);
     }
 }
 
+PackingAlgorithm RectanglePacker::getAlgorithm() const {
+    return algorithm;
+}
+
 void RectanglePacker::splitSpace(int index, int w, int h) {
     Rectangle space = spaces[index];
     removeFromUnorderedVector(spaces, index);
@@ -54,7 +91,7 @@ void RectanglePacker::splitSpace(int index, int w, int h) {
         spaces.push_back(b);
 }
 
-int RectanglePacker::pack(Rectangle *rectangles, int count) {
+int RectanglePacker::packGuillotine(Rectangle *rectangles, int count) {
     std::vector<int> remainingRects(count);
     for (int i = 0; i < count; ++i)
         remainingRects[i] = i;
@@ -93,7 +130,7 @@ int RectanglePacker::pack(Rectangle *rectangles, int count) {
     return (int) remainingRects.size();
 }
 
-int RectanglePacker::pack(OrientedRectangle *rectangles, int count) {
+int RectanglePacker::packGuillotine(OrientedRectangle *rectangles, int count) {
     std::vector<int> remainingRects(count);
     for (int i = 0; i < count; ++i)
         remainingRects[i] = i;
@@ -154,4 +191,332 @@ int RectanglePacker::pack(OrientedRectangle *rectangles, int count) {
     return (int) remainingRects.size();
 }
 
+template <typename RectangleType>
+int RectanglePacker::packMaxRects(RectangleType *rectangles, int count, bool allowRotation) {
+    std::vector<int> remainingRects(count);
+    for (int i = 0; i < count; ++i)
+        remainingRects[i] = i;
+    while (!remainingRects.empty()) {
+        // Best short side fit among all remaining rectangles, ties broken by long side fit
+        int bestShortFit = WORST_FIT, bestLongFit = WORST_FIT;
+        int bestRect = -1;
+        int bestX = 0, bestY = 0;
+        bool bestRotated = false;
+        for (const Rectangle &space : spaces) {
+            for (size_t j = 0; j < remainingRects.size(); ++j) {
+                const RectangleType &rect = rectangles[remainingRects[j]];
+                for (int r = 0; r < 1+allowRotation; ++r) {
+                    int rw = r ? rect.h : rect.w, rh = r ? rect.w : rect.h;
+                    if (rw <= space.w && rh <= space.h) {
+                        int shortFit = std::min(space.w-rw, space.h-rh);
+                        int longFit = std::max(space.w-rw, space.h-rh);
+                        if (shortFit < bestShortFit || (shortFit == bestShortFit && longFit < bestLongFit)) {
+                            bestShortFit = shortFit, bestLongFit = longFit;
+                            bestRect = int(j);
+                            bestX = space.x, bestY = space.y;
+                            bestRotated = r != 0;
+                        }
+                    }
+                }
+            }
+        }
+        if (bestRect < 0)
+            break;
+        RectangleType &rect = rectangles[remainingRects[bestRect]];
+        rect.x = bestX;
+        rect.y = bestY;
+        setRotated(rect, bestRotated);
+        if (bestRotated)
+            placeMaxRects(bestX, bestY, rect.h, rect.w);
+        else
+            placeMaxRects(bestX, bestY, rect.w, rect.h);
+        removeFromUnorderedVector(remainingRects, bestRect);
+    }
+    return (int) remainingRects.size();
+}
+
+template <typename RectangleType>
+int RectanglePacker::packOrdered(RectangleType *rectangles, int count, bool allowRotation) {
+    // Taller rectangles first (longer if rotation is allowed)
+    std::vector<int> order(count);
+    for (int i = 0; i < count; ++i)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [rectangles, allowRotation](int a, int b) -> bool {
+        int ah = rectangles[a].h, aw = rectangles[a].w;
+        int bh = rectangles[b].h, bw = rectangles[b].w;
+        if (allowRotation) {
+            if (aw > ah)
+                std::swap(aw, ah);
+            if (bw > bh)
+                std::swap(bw, bh);
+        }
+        return ah > bh || (ah == bh && aw > bw);
+    });
+    int remaining = 0;
+    for (int i : order) {
+        RectangleType &rect = rectangles[i];
+        int x, y;
+        bool rotated = false;
+        if (findPosition(rect.w, rect.h, allowRotation, x, y, rotated)) {
+            rect.x = x;
+            rect.y = y;
+            setRotated(rect, rotated);
+            if (rotated)
+                place(x, y, rect.h, rect.w);
+            else
+                place(x, y, rect.w, rect.h);
+        } else
+            ++remaining;
+    }
+    return remaining;
+}
+
+bool RectanglePacker::findPosition(int w, int h, bool allowRotation, int &x, int &y, bool &rotated) const {
+    switch (algorithm) {
+        case PackingAlgorithm::SKYLINE:
+            return findSkylinePosition(w, h, allowRotation, x, y, rotated);
+        case PackingAlgorithm::SHELF:
+            return findShelfPosition(w, h, allowRotation, x, y, rotated);
+        default:
+            return false;
+    }
+}
+
+void RectanglePacker::place(int x, int y, int w, int h) {
+    switch (algorithm) {
+        case PackingAlgorithm::SKYLINE:
+            placeSkyline(x, y, w, h);
+            break;
+        case PackingAlgorithm::SHELF:
+            placeShelf(x, y, w, h);
+            break;
+        default:;
+    }
+}
+
+void RectanglePacker::placeMaxRects(int x, int y, int w, int h) {
+    // Split free rectangles overlapping the placed one
+    size_t untouched = 0;
+    std::vector<Rectangle> splits;
+    for (size_t i = 0; i < spaces.size(); ++i) {
+        Rectangle space = spaces[i];
+        if (x >= space.x+space.w || x+w <= space.x || y >= space.y+space.h || y+h <= space.y) {
+            spaces[untouched++] = space;
+            continue;
+        }
+        if (x > space.x)
+            splits.push_back(Rectangle { space.x, space.y, x-space.x, space.h });
+        if (x+w < space.x+space.w)
+            splits.push_back(Rectangle { x+w, space.y, space.x+space.w-(x+w), space.h });
+        if (y > space.y)
+            splits.push_back(Rectangle { space.x, space.y, space.w, y-space.y });
+        if (y+h < space.y+space.h)
+            splits.push_back(Rectangle { space.x, y+h, space.w, space.y+space.h-(y+h) });
+    }
+    spaces.resize(untouched);
+    // Only the new splits may be redundant - each is contained in a previously maximal free rectangle
+    for (size_t i = 0; i < splits.size(); ++i) {
+        bool contained = false;
+        for (size_t j = 0; j < spaces.size() && !contained; ++j)
+            contained = containsRectangle(spaces[j], splits[i]);
+        for (size_t j = i+1; j < splits.size() && !contained; ++j)
+            contained = containsRectangle(splits[j], splits[i]);
+        if (!contained)
+            spaces.push_back(splits[i]);
+    }
+}
+
+void RectanglePacker::pruneSpaces() {
+    // Remove free rectangles contained in other ones
+    for (size_t i = 0; i < spaces.size(); ++i) {
+        for (size_t j = i+1; j < spaces.size();) {
+            if (containsRectangle(spaces[i], spaces[j]))
+                removeFromUnorderedVector(spaces, j);
+            else if (containsRectangle(spaces[j], spaces[i])) {
+                removeFromUnorderedVector(spaces, i);
+                j = i+1;
+            } else
+                ++j;
+        }
+    }
+}
+
+int RectanglePacker::findSkylineY(int index, int w) const {
+    if (skyline[index].x+w > width)
+        return -1;
+    int y = 0;
+    for (int i = index, remaining = w; remaining > 0; ++i) {
+        y = std::max(y, skyline[i].y);
+        remaining -= skyline[i].w;
+    }
+    return y;
+}
+
+bool RectanglePacker::findSkylinePosition(int w, int h, bool allowRotation, int &x, int &y, bool &rotated) const {
+    // Bottom left - lowest top edge, ties broken by leftmost position
+    int bestTop = WORST_FIT, bestX = WORST_FIT;
+    for (int i = 0; i < (int) skyline.size(); ++i) {
+        for (int r = 0; r < 1+allowRotation; ++r) {
+            int rw = r ? h : w, rh = r ? w : h;
+            int ny = findSkylineY(i, rw);
+            if (ny >= 0 && ny+rh <= height && (ny+rh < bestTop || (ny+rh == bestTop && skyline[i].x < bestX))) {
+                x = skyline[i].x, y = ny;
+                rotated = r != 0;
+                bestTop = ny+rh, bestX = skyline[i].x;
+            }
+        }
+    }
+    return bestTop != WORST_FIT;
+}
+
+void RectanglePacker::placeSkyline(int x, int y, int w, int h) {
+    size_t index = 0;
+    while (index < skyline.size() && skyline[index].x != x)
+        ++index;
+    skyline.insert(skyline.begin()+index, SkylineNode { x, y+h, w });
+    // Trim segments covered by the new one
+    for (size_t i = index+1; i < skyline.size();) {
+        int overlap = x+w-skyline[i].x;
+        if (overlap <= 0)
+            break;
+        if (skyline[i].w <= overlap)
+            skyline.erase(skyline.begin()+i);
+        else {
+            skyline[i].x += overlap;
+            skyline[i].w -= overlap;
+            break;
+        }
+    }
+    // Merge segments of equal height
+    for (size_t i = 1; i < skyline.size();) {
+        if (skyline[i-1].y == skyline[i].y) {
+            skyline[i-1].w += skyline[i].w;
+            skyline.erase(skyline.begin()+i);
+        } else
+            ++i;
+    }
+}
+
+bool RectanglePacker::findShelfPosition(int w, int h, bool allowRotation, int &x, int &y, bool &rotated) const {
+    // Next fit - only the current shelf is considered, otherwise a new one is opened above it
+    int bestHeight = -1;
+    for (int r = 0; r < 1+allowRotation; ++r) {
+        int rw = r ? h : w, rh = r ? w : h;
+        if (shelfX+rw <= width && (rh <= shelfHeight || (!shelfX && shelfY+rh <= height))) {
+            // Prefer the orientation that fills more of the shelf's height
+            if (shelfX ? rh > bestHeight : (bestHeight < 0 || rh < bestHeight)) {
+                x = shelfX, y = shelfY;
+                rotated = r != 0;
+                bestHeight = rh;
+            }
+        }
+    }
+    if (bestHeight >= 0)
+        return true;
+    for (int r = 0; r < 1+allowRotation; ++r) {
+        int rw = r ? h : w, rh = r ? w : h;
+        if (rw <= width && shelfY+shelfHeight+rh <= height && (bestHeight < 0 || rh < bestHeight)) {
+            x = 0, y = shelfY+shelfHeight;
+            rotated = r != 0;
+            bestHeight = rh;
+        }
+    }
+    return bestHeight >= 0;
+}
+
+void RectanglePacker::placeShelf(int x, int y, int w, int h) {
+    if (y != shelfY) {
+        shelfY = y;
+        shelfHeight = 0;
+    }
+    shelfX = x+w;
+    shelfHeight = std::max(shelfHeight, h);
+}
+
+void RectanglePacker::occupy(const Rectangle &rect) {
+    if (rect.w <= 0 || rect.h <= 0)
+        return;
+    switch (algorithm) {
+        case PackingAlgorithm::GUILLOTINE:
+            // Cut the overlapping free spaces into disjoint pieces around the area
+            for (size_t i = 0; i < spaces.size();) {
+                Rectangle space = spaces[i];
+                if (rect.x >= space.x+space.w || rect.x+rect.w <= space.x || rect.y >= space.y+space.h || rect.y+rect.h <= space.y) {
+                    ++i;
+                    continue;
+                }
+                removeFromUnorderedVector(spaces, i);
+                int l = std::max(space.x, rect.x), r = std::min(space.x+space.w, rect.x+rect.w);
+                if (rect.x > space.x)
+                    spaces.push_back(Rectangle { space.x, space.y, rect.x-space.x, space.h });
+                if (rect.x+rect.w < space.x+space.w)
+                    spaces.push_back(Rectangle { rect.x+rect.w, space.y, space.x+space.w-(rect.x+rect.w), space.h });
+                if (rect.y > space.y)
+                    spaces.push_back(Rectangle { l, space.y, r-l, rect.y-space.y });
+                if (rect.y+rect.h < space.y+space.h)
+                    spaces.push_back(Rectangle { l, rect.y+rect.h, r-l, space.y+space.h-(rect.y+rect.h) });
+                // The pieces can't overlap the area, so they are skipped by the remaining iterations
+            }
+            break;
+        case PackingAlgorithm::MAX_RECTS:
+            placeMaxRects(rect.x, rect.y, rect.w, rect.h);
+            break;
+        case PackingAlgorithm::SKYLINE: {
+            // The skyline is raised above the area
+            std::vector<SkylineNode> raised;
+            raised.reserve(skyline.size()+2);
+            for (const SkylineNode &node : skyline) {
+                if (node.x+node.w <= rect.x || node.x >= rect.x+rect.w) {
+                    raised.push_back(node);
+                    continue;
+                }
+                int l = std::max(node.x, rect.x), r = std::min(node.x+node.w, rect.x+rect.w);
+                if (node.x < l)
+                    raised.push_back(SkylineNode { node.x, node.y, l-node.x });
+                raised.push_back(SkylineNode { l, std::max(node.y, rect.y+rect.h), r-l });
+                if (r < node.x+node.w)
+                    raised.push_back(SkylineNode { r, node.y, node.x+node.w-r });
+            }
+            skyline.clear();
+            for (const SkylineNode &node : raised) {
+                if (!skyline.empty() && skyline.back().y == node.y)
+                    skyline.back().w += node.w;
+                else
+                    skyline.push_back(node);
+            }
+            break;
+        }
+        case PackingAlgorithm::SHELF:
+            // Shelves can't flow around the area, so a new one is opened past it
+            if (rect.y+rect.h > shelfY) {
+                shelfY = std::max(shelfY+shelfHeight, rect.y+rect.h);
+                shelfHeight = 0;
+                shelfX = 0;
+            }
+            break;
+    }
+}
+
+int RectanglePacker::pack(Rectangle *rectangles, int count) {
+    switch (algorithm) {
+        case PackingAlgorithm::GUILLOTINE:
+            return packGuillotine(rectangles, count);
+        case PackingAlgorithm::MAX_RECTS:
+            return packMaxRects(rectangles, count, false);
+        default:
+            return packOrdered(rectangles, count, false);
+    }
+}
+
+int RectanglePacker::pack(OrientedRectangle *rectangles, int count) {
+    switch (algorithm) {
+        case PackingAlgorithm::GUILLOTINE:
+            return packGuillotine(rectangles, count);
+        case PackingAlgorithm::MAX_RECTS:
+            return packMaxRects(rectangles, count, true);
+        default:
+            return packOrdered(rectangles, count, true);
+    }
+}
+
 }
@@ -2,28 +2,59 @@
 #pragma once
 
 #include <vector>
+#include "types.h"
 #include "Rectangle.h"
 
 namespace msdf_atlas {
 
-/// Guillotine 2D single bin packer
+/// 2D single bin packer using the selected packing algorithm (guillotine by default)
 class RectanglePacker {
 
 public:
     RectanglePacker();
-    RectanglePacker(int width, int height);
+    RectanglePacker(int width, int height, PackingAlgorithm algorithm = PackingAlgorithm::GUILLOTINE);
     /// Expands the packing area - both width and height must be greater or equal to the previous value
     void expand(int width, int height);
+    /// Marks an area as occupied so that nothing is packed over it (skyline and shelf packers may also give up some free space around it)
+    void occupy(const Rectangle &rect);
     /// Packs the rectangle array, returns how many didn't fit (0 on success)
     int pack(Rectangle *rectangles, int count);
     int pack(OrientedRectangle *rectangles, int count);
+    /// Returns the packing algorithm in use
+    PackingAlgorithm getAlgorithm() const;
 
 private:
+    struct SkylineNode {
+        int x, y, w;
+    };
+
+    PackingAlgorithm algorithm;
+    int width, height;
+    /// Free rectangles (guillotine, MaxRects)
     std::vector<Rectangle> spaces;
+    /// Skyline segments sorted by x
+    std::vector<SkylineNode> skyline;
+    /// Current open shelf
+    int shelfY, shelfHeight, shelfX;
 
     static int rateFit(int w, int h, int sw, int sh);
 
     void splitSpace(int index, int w, int h);
+    int packGuillotine(Rectangle *rectangles, int count);
+    int packGuillotine(OrientedRectangle *rectangles, int count);
+    template <typename RectangleType>
+    int packMaxRects(RectangleType *rectangles, int count, bool allowRotation);
+    template <typename RectangleType>
+    int packOrdered(RectangleType *rectangles, int count, bool allowRotation);
+    bool findPosition(int w, int h, bool allowRotation, int &x, int &y, bool &rotated) const;
+    void place(int x, int y, int w, int h);
+    void placeMaxRects(int x, int y, int w, int h);
+    void pruneSpaces();
+    int findSkylineY(int index, int w) const;
+    bool findSkylinePosition(int w, int h, bool allowRotation, int &x, int &y, bool &rotated) const;
+    void placeSkyline(int x, int y, int w, int h);
+    bool findShelfPosition(int w, int h, bool allowRotation, int &x, int &y, bool &rotated) const;
+    void placeShelf(int x, int y, int w, int h);
 
 };
 
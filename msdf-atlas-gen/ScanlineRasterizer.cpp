@@ -0,0 +1,201 @@
+
+#include "ScanlineRasterizer.h"
+
+#include <cmath>
+#include <algorithm>
+
+/// Maximum distance (in pixels) between curves and the line segments that approximate them for coverage computation
+#define COVERAGE_FLATNESS (1./16.)
+
+namespace msdf_atlas {
+
+static bool interpretFillRule(int winding, msdfgen::FillRule fillRule) {
+    switch (fillRule) {
+        case msdfgen::FILL_NONZERO:
+            return winding != 0;
+        case msdfgen::FILL_ODD:
+            return (winding&1) != 0;
+        case msdfgen::FILL_POSITIVE:
+            return winding > 0;
+        case msdfgen::FILL_NEGATIVE:
+            return winding < 0;
+    }
+    return false;
+}
+
+ScanlineRasterizer::ScanlineRasterizer(const msdfgen::Shape &shape, const msdfgen::Projection &projection) : projection(projection), nextEdge(0), rowY(-HUGE_VAL) {
+    for (const msdfgen::Contour &contour : shape.contours) {
+        for (const msdfgen::EdgeHolder &edge : contour.edges) {
+            // Curves lie within the convex hull of their control points
+            Edge tableEdge = { edge, +HUGE_VAL, -HUGE_VAL };
+            const msdfgen::Point2 *controlPoints = edge->controlPoints();
+            for (int i = 0; i <= edge->type(); ++i) {
+                tableEdge.minY = std::min(tableEdge.minY, controlPoints[i].y);
+                tableEdge.maxY = std::max(tableEdge.maxY, controlPoints[i].y);
+            }
+            edges.push_back(tableEdge);
+        }
+    }
+    std::stable_sort(edges.begin(), edges.end(), [](const Edge &a, const Edge &b) -> bool {
+        return a.minY < b.minY;
+    });
+}
+
+void ScanlineRasterizer::moveToRow(int y) {
+    double rowY = projection.unprojectY(y+.5);
+    if (rowY < this->rowY) {
+        nextEdge = 0;
+        activeEdges.clear();
+    }
+    this->rowY = rowY;
+    for (; nextEdge < edges.size() && edges[nextEdge].minY <= rowY; ++nextEdge)
+        activeEdges.push_back(&edges[nextEdge]);
+    activeEdges.erase(std::remove_if(activeEdges.begin(), activeEdges.end(), [rowY](const Edge *edge) -> bool {
+        return edge->maxY < rowY;
+    }), activeEdges.end());
+
+    intersections.clear();
+    for (const Edge *edge : activeEdges) {
+        double x[3];
+        int dy[3];
+        int n = edge->segment->scanlineIntersections(x, dy, rowY);
+        for (int i = 0; i < n; ++i) {
+            Intersection intersection = { x[i], dy[i] };
+            intersections.push_back(intersection);
+        }
+    }
+    std::sort(intersections.begin(), intersections.end(), [](const Intersection &a, const Intersection &b) -> bool {
+        return a.x < b.x;
+    });
+    int winding = 0;
+    for (Intersection &intersection : intersections)
+        intersection.direction = winding += intersection.direction;
+}
+
+void ScanlineRasterizer::fillRow(byte *filled, int width, msdfgen::FillRule fillRule) const {
+    size_t next = 0;
+    int winding = 0;
+    for (int x = 0; x < width; ++x) {
+        double rowX = projection.unprojectX(x+.5);
+        for (; next < intersections.size() && intersections[next].x <= rowX; ++next)
+            winding = intersections[next].direction;
+        filled[x] = (byte) interpretFillRule(winding, fillRule);
+    }
+}
+
+void ScanlineRasterizer::fill(byte *filled, int width, int height, msdfgen::FillRule fillRule) {
+    for (int y = 0; y < height; ++y) {
+        moveToRow(y);
+        fillRow(filled+(size_t) width*y, width, fillRule);
+    }
+}
+
+/// Adds the signed area of the line segment (in pixel coordinates), which must lie within 0 <= x <= width, to the accumulation buffer, whose rows are width+2 wide
+static void accumulateSpan(float *accumulation, int width, int height, msdfgen::Point2 a, msdfgen::Point2 b) {
+    if (a.y == b.y)
+        return;
+    float direction = 1.f;
+    if (a.y > b.y) {
+        std::swap(a, b);
+        direction = -1.f;
+    }
+    double dxdy = (b.x-a.x)/(b.y-a.y);
+    double x = a.x;
+    if (a.y < 0)
+        x -= a.y*dxdy;
+    int yEnd = std::min((int) ceil(b.y), height);
+    for (int y = std::max((int) floor(a.y), 0); y < yEnd; ++y) {
+        float *row = accumulation+(size_t) (width+2)*y;
+        double dy = std::min(y+1., b.y)-std::max((double) y, a.y);
+        double xNext = x+dxdy*dy;
+        double d = direction*dy;
+        double x0 = std::min(x, xNext), x1 = std::max(x, xNext);
+        double x0Floor = floor(x0), x1Ceil = ceil(x1);
+        int x0i = (int) x0Floor, x1i = (int) x1Ceil;
+        if (x1i <= x0i+1) {
+            // The segment stays within a single pixel column
+            double xm = .5*(x+xNext)-x0Floor;
+            row[x0i] += float(d-d*xm);
+            row[x0i+1] += float(d*xm);
+        } else {
+            double s = 1/(x1-x0);
+            double x0f = x0-x0Floor;
+            double a0 = .5*s*(1-x0f)*(1-x0f);
+            double x1f = x1-x1Ceil+1;
+            double am = .5*s*x1f*x1f;
+            row[x0i] += float(d*a0);
+            if (x1i == x0i+2)
+                row[x0i+1] += float(d*(1-a0-am));
+            else {
+                double a1 = s*(1.5-x0f);
+                row[x0i+1] += float(d*(a1-a0));
+                for (int xi = x0i+2; xi < x1i-1; ++xi)
+                    row[xi] += float(d*s);
+                double a2 = a1+(x1i-x0i-3)*s;
+                row[x1i-1] += float(d*(1-a2-am));
+            }
+            row[x1i] += float(d*am);
+        }
+        x = xNext;
+    }
+}
+
+/// Adds the signed area of the line segment (in pixel coordinates) to the accumulation buffer, whose rows are width+2 wide
+static void accumulateLine(float *accumulation, int width, int height, msdfgen::Point2 a, msdfgen::Point2 b) {
+    if (a.y == b.y)
+        return;
+    // The segment is split where it crosses the left and right border, parts beyond them still cover the pixels on the other side
+    // (or none), so they are accumulated as vertical lines on the border, which preserves the slope of the part within
+    double splits[2];
+    int splitCount = 0;
+    if ((a.x < 0) != (b.x < 0))
+        splits[splitCount++] = -a.x/(b.x-a.x);
+    if ((a.x < width) != (b.x < width))
+        splits[splitCount++] = (width-a.x)/(b.x-a.x);
+    if (splitCount == 2 && splits[0] > splits[1])
+        std::swap(splits[0], splits[1]);
+    msdfgen::Point2 p = a;
+    for (int i = 0; i <= splitCount; ++i) {
+        msdfgen::Point2 q = i < splitCount ? a+splits[i]*(b-a) : b;
+        msdfgen::Point2 pClamped(std::min(std::max(p.x, 0.), (double) width), p.y);
+        msdfgen::Point2 qClamped(std::min(std::max(q.x, 0.), (double) width), q.y);
+        accumulateSpan(accumulation, width, height, pClamped, qClamped);
+        p = q;
+    }
+}
+
+void ScanlineRasterizer::coverage(const msdfgen::BitmapSection<float, 1> &output, const msdfgen::Shape &shape, const msdfgen::Projection &projection) {
+    msdfgen::BitmapSection<float, 1> section = output;
+    section.reorient(shape.getYAxisOrientation());
+    int width = section.width, height = section.height;
+    std::vector<float> accumulation((size_t) (width+2)*height);
+    for (const msdfgen::Contour &contour : shape.contours) {
+        for (const msdfgen::EdgeHolder &edge : contour.edges) {
+            const msdfgen::Point2 *controlPoints = edge->controlPoints();
+            int segments = 1;
+            if (edge->type() > 1) {
+                // The distance of a curve from its chord is bounded by its control points' second differences
+                double deviation = 0;
+                for (int i = 0; i+2 <= edge->type(); ++i)
+                    deviation = std::max(deviation, (projection.project(controlPoints[i])-2*projection.project(controlPoints[i+1])+projection.project(controlPoints[i+2])).length());
+                segments = std::max(1, std::min((int) ceil(sqrt(.125*edge->type()*(edge->type()-1)*deviation/COVERAGE_FLATNESS)), 256));
+            }
+            msdfgen::Point2 prev = projection.project(controlPoints[0]);
+            for (int i = 1; i <= segments; ++i) {
+                msdfgen::Point2 next = projection.project(i == segments ? edge->point(1) : edge->point((double) i/segments));
+                accumulateLine(accumulation.data(), width, height, prev, next);
+                prev = next;
+            }
+        }
+    }
+    for (int y = 0; y < height; ++y) {
+        const float *row = accumulation.data()+(size_t) (width+2)*y;
+        float area = 0;
+        for (int x = 0; x < width; ++x) {
+            area += row[x];
+            *section(x, y) = std::min(fabsf(area), 1.f);
+        }
+    }
+}
+
+}
@@ -0,0 +1,53 @@
+
+#pragma once
+
+#include <vector>
+#include <msdfgen.h>
+#include "types.h"
+
+namespace msdf_atlas {
+
+/**
+ * Evaluates a shape's scanlines at the centers of pixel rows with an active edge table - edges are sorted by their lowest point,
+ * so each row only computes intersections with the edges whose control points span it. Results are identical to msdfgen::Shape::scanline.
+ */
+class ScanlineRasterizer {
+
+public:
+    /// Prepares the edge table of the shape, which must outlive the rasterizer, for pixel rows of the projection
+    ScanlineRasterizer(const msdfgen::Shape &shape, const msdfgen::Projection &projection);
+    /// Computes the intersections of the center of pixel row y - visiting rows in ascending order updates the active edges incrementally
+    void moveToRow(int y);
+    /// Outputs whether the centers of the first width pixels of the current row are filled (1) or not (0)
+    void fillRow(byte *filled, int width, msdfgen::FillRule fillRule) const;
+    /// Rasterizes the fill of all pixel centers of a width x height area row by row
+    void fill(byte *filled, int width, int height, msdfgen::FillRule fillRule);
+
+    /**
+     * Computes the exact area of each pixel covered by the shape approximated by line segments (at most 1/16 pixel away from curves).
+     * Areas of overlapping contours of the same orientation are clamped, which matches the non-zero fill rule.
+     */
+    static void coverage(const msdfgen::BitmapSection<float, 1> &output, const msdfgen::Shape &shape, const msdfgen::Projection &projection);
+
+private:
+    struct Edge {
+        const msdfgen::EdgeSegment *segment;
+        double minY, maxY;
+    };
+    struct Intersection {
+        double x;
+        int direction;
+    };
+
+    msdfgen::Projection projection;
+    /// Edges ordered by minY
+    std::vector<Edge> edges;
+    size_t nextEdge;
+    double rowY;
+    std::vector<const Edge *> activeEdges;
+    /// Intersections of the current row ordered by x, their direction is the cumulative winding
+    std::vector<Intersection> intersections;
+
+};
+
+}
@@ -0,0 +1,95 @@
+
+#include "TextFileWriter.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <clocale>
+
+namespace msdf_atlas {
+
+/// Replaces the current locale's decimal point in a number formatted by sprintf with '.', returns its new length
+static size_t normalizeDecimalPoint(char *str, size_t length) {
+    const char *decimalPoint = localeconv()->decimal_point;
+    if (!(decimalPoint && *decimalPoint) || !strcmp(decimalPoint, "."))
+        return length;
+    if (char *pos = strstr(str, decimalPoint)) {
+        size_t pointLength = strlen(decimalPoint);
+        *pos = '.';
+        memmove(pos+1, pos+pointLength, length-(size_t) (pos-str)-pointLength+1);
+        length -= pointLength-1;
+    }
+    return length;
+}
+
+/// Formats value into the shortest string that parses back to the same double (or float if singlePrecision) regardless of locale, returns its length
+static size_t formatReal(char *output, double value, bool singlePrecision) {
+    // Integers are exact and by far the most common values
+    if (fabs(value) < 1e15 && value == (double) (long long) value && !(value == 0 && std::signbit(value)))
+        return (size_t) sprintf(output, "%lld", (long long) value);
+    // Any decimal number with up to 15 (6 for float) significant digits round-trips, so %g with that precision already yields the shortest representation if one exists.
+    // The round-trip test is done before the decimal point is normalized, since strtod expects the same locale as sprintf
+    int length = 0;
+    if (singlePrecision) {
+        for (int precision = 6; precision <= 9; ++precision) {
+            length = sprintf(output, "%.*g", precision, value);
+            if ((float) strtod(output, nullptr) == (float) value)
+                break;
+        }
+    } else {
+        for (int precision = 15; precision <= 17; ++precision) {
+            length = sprintf(output, "%.*g", precision, value);
+            if (strtod(output, nullptr) == value)
+                break;
+        }
+    }
+    return normalizeDecimalPoint(output, (size_t) length);
+}
+
+TextFileWriter::TextFileWriter(FILE *file) : file(file), length(0), compactPrecision(false), error(false) { }
+
+void TextFileWriter::setCompactPrecision(bool compactPrecision) {
+    this->compactPrecision = compactPrecision;
+}
+
+void TextFileWriter::reserve(size_t size) {
+    if (length+size > BUFFER_SIZE)
+        flush();
+}
+
+void TextFileWriter::writeString(const char *str) {
+    size_t strLength = strlen(str);
+    if (strLength > BUFFER_SIZE) {
+        flush();
+        error |= fwrite(str, 1, strLength, file) != strLength;
+        return;
+    }
+    reserve(strLength);
+    memcpy(buffer+length, str, strLength);
+    length += strLength;
+}
+
+void TextFileWriter::writeChar(char c) {
+    reserve(1);
+    buffer[length++] = c;
+}
+
+void TextFileWriter::writeInteger(long long value) {
+    reserve(MAX_NUMBER_LENGTH);
+    length += (size_t) sprintf(buffer+length, "%lld", value);
+}
+
+void TextFileWriter::writeReal(double value) {
+    reserve(MAX_NUMBER_LENGTH);
+    length += formatReal(buffer+length, value, compactPrecision);
+}
+
+bool TextFileWriter::flush() {
+    if (length) {
+        error |= fwrite(buffer, 1, length, file) != length;
+        length = 0;
+    }
+    return !error;
+}
+
+}
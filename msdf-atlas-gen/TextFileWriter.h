@@ -0,0 +1,38 @@
+
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+
+namespace msdf_atlas {
+
+/// Buffered writer of text files, which formats real numbers into their shortest round-trip representation
+class TextFileWriter {
+
+public:
+    explicit TextFileWriter(FILE *file);
+    /// If enabled, real numbers are only written with enough precision to round-trip in single precision
+    void setCompactPrecision(bool compactPrecision);
+    void writeString(const char *str);
+    void writeChar(char c);
+    void writeInteger(long long value);
+    void writeReal(double value);
+    /// Writes any buffered text into the file, returns false on error
+    bool flush();
+
+private:
+    static const size_t BUFFER_SIZE = 16384;
+    /// Enough for any single formatted number including the null terminator
+    static const size_t MAX_NUMBER_LENGTH = 33;
+
+    FILE *file;
+    char buffer[BUFFER_SIZE];
+    size_t length;
+    bool compactPrecision;
+    bool error;
+
+    void reserve(size_t size);
+
+};
+
+}
@@ -5,6 +5,8 @@
 #include "Rectangle.h"
 #include "rectangle-packing.h"
 #include "size-selectors.h"
+#include "glyph-deduplication.h"
+#include "Instrumentation.h"
 
 namespace msdf_atlas {
 
@@ -12,6 +14,9 @@ TightAtlasPacker::TightAtlasPacker() :
     width(-1), height(-1),
     spacing(0),
     dimensionsConstraint(DimensionsConstraint::POWER_OF_TWO_SQUARE),
+    packingAlgorithm(PackingAlgorithm::GUILLOTINE),
+    allowRotation(false),
+    deduplicate(false),
     scale(-1),
     minScale(1),
     unitRange(0),
@@ -21,7 +26,53 @@ TightAtlasPacker::TightAtlasPacker() :
     scaleMaximizationTolerance(.001)
 { }
 
-int TightAtlasPacker::tryPack(GlyphGeometry *glyphs, int count, DimensionsConstraint dimensionsConstraint, int &width, int &height, double scale) const {
+static void placeGlyphBox(GlyphGeometry *glyph, const Rectangle &rect, int height) {
+    glyph->placeBox(rect.x, height-(rect.y+rect.h));
+}
+
+static void placeGlyphBox(GlyphGeometry *glyph, const OrientedRectangle &rect, int height) {
+    if (rect.rotated)
+        glyph->placeBox(rect.x, height-(rect.y+rect.w), true);
+    else
+        glyph->placeBox(rect.x, height-(rect.y+rect.h));
+}
+
+template <typename RectangleType>
+static int packBoxes(RectangleType *rectangles, GlyphGeometry *const *rectangleGlyphs, int count, DimensionsConstraint dimensionsConstraint, int &width, int &height, int spacing, PackingAlgorithm packingAlgorithm) {
+    if (width < 0 || height < 0) {
+        std::pair<int, int> dimensions = std::make_pair(width, height);
+        switch (dimensionsConstraint) {
+            case DimensionsConstraint::POWER_OF_TWO_SQUARE:
+                dimensions = packRectangles<SquarePowerOfTwoSizeSelector>(rectangles, count, spacing, packingAlgorithm);
+                break;
+            case DimensionsConstraint::POWER_OF_TWO_RECTANGLE:
+                dimensions = packRectangles<PowerOfTwoSizeSelector>(rectangles, count, spacing, packingAlgorithm);
+                break;
+            case DimensionsConstraint::MULTIPLE_OF_FOUR_SQUARE:
+                dimensions = packRectangles<SquareSizeSelector<4> >(rectangles, count, spacing, packingAlgorithm);
+                break;
+            case DimensionsConstraint::EVEN_SQUARE:
+                dimensions = packRectangles<SquareSizeSelector<2> >(rectangles, count, spacing, packingAlgorithm);
+                break;
+            case DimensionsConstraint::SQUARE:
+            default:
+                dimensions = packRectangles<SquareSizeSelector<> >(rectangles, count, spacing, packingAlgorithm);
+                break;
+        }
+        if (!(dimensions.first > 0 && dimensions.second > 0))
+            return -1;
+        width = dimensions.first, height = dimensions.second;
+    } else {
+        if (int result = packRectangles(rectangles, count, width, height, spacing, packingAlgorithm))
+            return result;
+    }
+    // Set glyph box placement
+    for (int i = 0; i < count; ++i)
+        placeGlyphBox(rectangleGlyphs[i], rectangles[i], height);
+    return 0;
+}
+
+int TightAtlasPacker::tryPack(GlyphGeometry *glyphs, int count, const int *duplicateOf, DimensionsConstraint dimensionsConstraint, int &width, int &height, double scale) const {
     // Wrap glyphs into boxes
     std::vector<Rectangle> rectangles;
     std::vector<GlyphGeometry *> rectangleGlyphs;
@@ -40,7 +91,8 @@ int TightAtlasPacker::tryPack(GlyphGeometry *glyphs, int count, DimensionsConstr
             Rectangle rect = { };
             glyph->wrapBox(attribs);
             glyph->getBoxSize(rect.w, rect.h);
-            if (rect.w > 0 && rect.h > 0) {
+            // Duplicate glyphs share the box of the original
+            if (rect.w > 0 && rect.h > 0 && !(duplicateOf && duplicateOf[glyph-glyphs] >= 0)) {
                 rectangles.push_back(rect);
                 rectangleGlyphs.push_back(glyph);
             }
@@ -53,43 +105,32 @@ int TightAtlasPacker::tryPack(GlyphGeometry *glyphs, int count, DimensionsConstr
         return 0;
     }
     // Box rectangle packing
-    if (width < 0 || height < 0) {
-        std::pair<int, int> dimensions = std::make_pair(width, height);
-        switch (dimensionsConstraint) {
-            case DimensionsConstraint::POWER_OF_TWO_SQUARE:
-                dimensions = packRectangles<SquarePowerOfTwoSizeSelector>(rectangles.data(), rectangles.size(), spacing);
-                break;
-            case DimensionsConstraint::POWER_OF_TWO_RECTANGLE:
-                dimensions = packRectangles<PowerOfTwoSizeSelector>(rectangles.data(), rectangles.size(), spacing);
-                break;
-            case DimensionsConstraint::MULTIPLE_OF_FOUR_SQUARE:
-                dimensions = packRectangles<SquareSizeSelector<4> >(rectangles.data(), rectangles.size(), spacing);
-                break;
-            case DimensionsConstraint::EVEN_SQUARE:
-                dimensions = packRectangles<SquareSizeSelector<2> >(rectangles.data(), rectangles.size(), spacing);
-                break;
-            case DimensionsConstraint::SQUARE:
-            default:
-                dimensions = packRectangles<SquareSizeSelector<> >(rectangles.data(), rectangles.size(), spacing);
-                break;
+    int result;
+    if (allowRotation) {
+        std::vector<OrientedRectangle> orientedRectangles(rectangles.size());
+        for (size_t i = 0; i < rectangles.size(); ++i) {
+            orientedRectangles[i].w = rectangles[i].w;
+            orientedRectangles[i].h = rectangles[i].h;
+        }
+        result = packBoxes(orientedRectangles.data(), rectangleGlyphs.data(), int(rectangles.size()), dimensionsConstraint, width, height, spacing, packingAlgorithm);
+    } else
+        result = packBoxes(rectangles.data(), rectangleGlyphs.data(), int(rectangles.size()), dimensionsConstraint, width, height, spacing, packingAlgorithm);
+    if (!result && duplicateOf) {
+        for (int i = 0; i < count; ++i) {
+            if (duplicateOf[i] >= 0) {
+                const GlyphGeometry &original = glyphs[duplicateOf[i]];
+                Rectangle rect = original.getBoxRect();
+                glyphs[i].placeBox(rect.x, rect.y, original.isBoxRotated());
+            }
         }
-        if (!(dimensions.first > 0 && dimensions.second > 0))
-            return -1;
-        width = dimensions.first, height = dimensions.second;
-    } else {
-        if (int result = packRectangles(rectangles.data(), rectangles.size(), width, height, spacing))
-            return result;
     }
-    // Set glyph box placement
-    for (size_t i = 0; i < rectangles.size(); ++i)
-        rectangleGlyphs[i]->placeBox(rectangles[i].x, height-(rectangles[i].y+rectangles[i].h));
-    return 0;
+    return result;
 }
 
-double TightAtlasPacker::packAndScale(GlyphGeometry *glyphs, int count) const {
+double TightAtlasPacker::packAndScale(GlyphGeometry *glyphs, int count, const int *duplicateOf) const {
     bool lastResult = false;
     int w = width, h = height;
-    #define TRY_PACK(scale) (lastResult = !tryPack(glyphs, count, DimensionsConstraint(), w, h, (scale)))
+    #define TRY_PACK(scale) (lastResult = !tryPack(glyphs, count, duplicateOf, DimensionsConstraint(), w, h, (scale)))
     double minScale = 1, maxScale = 1;
     if (TRY_PACK(1)) {
         while (maxScale < 1e+32 && ((maxScale = 2*minScale), TRY_PACK(maxScale)))
@@ -113,14 +154,24 @@ double TightAtlasPacker::packAndScale(GlyphGeometry *glyphs, int count) const {
 }
 
 int TightAtlasPacker::pack(GlyphGeometry *glyphs, int count) {
+    Instrumentation::Scope scope(Instrumentation::PACKING);
+    scope.addGlyphs(count);
+    // Identical geometry yields identical boxes regardless of scale, so duplicates only need to be found once
+    std::vector<int> duplicateOf;
+    if (deduplicate) {
+        duplicateOf.resize(count);
+        if (!findDuplicateGlyphs(duplicateOf.data(), glyphs, count))
+            duplicateOf.clear();
+    }
+    const int *duplicates = duplicateOf.empty() ? nullptr : duplicateOf.data();
     double initialScale = scale > 0 ? scale : minScale;
     if (initialScale > 0) {
-        if (int remaining = tryPack(glyphs, count, dimensionsConstraint, width, height, initialScale))
+        if (int remaining = tryPack(glyphs, count, duplicates, dimensionsConstraint, width, height, initialScale))
             return remaining;
     } else if (width < 0 || height < 0)
         return -1;
     if (scale <= 0)
-        scale = packAndScale(glyphs, count);
+        scale = packAndScale(glyphs, count, duplicates);
     if (scale <= 0)
         return -1;
     return 0;
@@ -138,6 +189,18 @@ void TightAtlasPacker::setDimensionsConstraint(DimensionsConstraint dimensionsCo
     this->dimensionsConstraint = dimensionsConstraint;
 }
 
+void TightAtlasPacker::setPackingAlgorithm(PackingAlgorithm packingAlgorithm) {
+    this->packingAlgorithm = packingAlgorithm;
+}
+
+void TightAtlasPacker::setRotation(bool allowRotation) {
+    this->allowRotation = allowRotation;
+}
+
+void TightAtlasPacker::setDeduplication(bool deduplicate) {
+    this->deduplicate = deduplicate;
+}
+
 void TightAtlasPacker::setSpacing(int spacing) {
     this->spacing = spacing;
 }
@@ -25,6 +25,12 @@ public:
     void unsetDimensions();
     /// Sets the constraint to be used when determining dimensions
     void setDimensionsConstraint(DimensionsConstraint dimensionsConstraint);
+    /// Sets the algorithm used to pack the glyph boxes
+    void setPackingAlgorithm(PackingAlgorithm packingAlgorithm);
+    /// Sets whether glyph boxes may be rotated by 90 degrees in the atlas to pack them more densely
+    void setRotation(bool allowRotation);
+    /// Sets whether glyphs with identical geometry should share a single box in the atlas
+    void setDeduplication(bool deduplicate);
     /// Sets the spacing between glyph boxes
     void setSpacing(int spacing);
     /// Sets fixed glyph scale
@@ -60,6 +66,9 @@ private:
     int width, height;
     int spacing;
     DimensionsConstraint dimensionsConstraint;
+    PackingAlgorithm packingAlgorithm;
+    bool allowRotation;
+    bool deduplicate;
     double scale;
     double minScale;
     msdfgen::Range unitRange;
@@ -70,8 +79,8 @@ private:
     Padding innerPxPadding, outerPxPadding;
     double scaleMaximizationTolerance;
 
-    int tryPack(GlyphGeometry *glyphs, int count, DimensionsConstraint dimensionsConstraint, int &width, int &height, double scale) const;
-    double packAndScale(GlyphGeometry *glyphs, int count) const;
+    int tryPack(GlyphGeometry *glyphs, int count, const int *duplicateOf, DimensionsConstraint dimensionsConstraint, int &width, int &height, double scale) const;
+    double packAndScale(GlyphGeometry *glyphs, int count, const int *duplicateOf) const;
 
 };
 
@@ -3,6 +3,10 @@
 
 #ifndef MSDF_ATLAS_NO_ARTERY_FONT
 
+#include <string>
+#include <vector>
+#include <map>
+#include <type_traits>
 #include <artery-font/std-artery-font.h>
 #include <artery-font/stdio-serialization.h>
 #include "GlyphGeometry.h"
@@ -43,6 +47,14 @@ static bool encodeTiff(std::vector<byte> &output, const msdfgen::BitmapConstSect
     return false;
 }
 
+#ifndef MSDFGEN_DISABLE_PNG
+/// Half-precision atlases cannot be encoded as PNG
+template <int N>
+static bool encodePng(std::vector<byte> &, const msdfgen::BitmapConstSection<half, N> &) {
+    return false;
+}
+#endif
+
 template <typename T>
 static artery_font::PixelFormat getPixelFormat();
 
@@ -54,6 +66,49 @@ template <>
 artery_font::PixelFormat getPixelFormat<float>() {
     return artery_font::PIXEL_FLOAT32;
 }
+/// Artery Font has no half-precision or 16-bit integer pixel format
+template <>
+artery_font::PixelFormat getPixelFormat<half>() {
+    return artery_font::PIXEL_UNKNOWN;
+}
+template <>
+artery_font::PixelFormat getPixelFormat<uint16_t>() {
+    return artery_font::PIXEL_UNKNOWN;
+}
+
+/// Converts the font's kerning into kerning pairs in one pre-sized pass, glyph indices are converted to codepoints via a flat lookup table
+template <typename REAL>
+static void buildKernPairs(std::vector<artery_font::KernPair<REAL> > &kernPairs, const FontGeometry &font, GlyphIdentifierType identifierType) {
+    const std::map<std::pair<int, int>, double> &kerning = font.getKerning();
+    kernPairs.clear();
+    kernPairs.reserve(kerning.size());
+    switch (identifierType) {
+        case GlyphIdentifierType::GLYPH_INDEX:
+            for (const std::pair<const std::pair<int, int>, double> &elem : kerning) {
+                artery_font::KernPair<REAL> kernPair = { };
+                kernPair.codepoint1 = elem.first.first;
+                kernPair.codepoint2 = elem.first.second;
+                kernPair.advance.h = REAL(elem.second);
+                kernPairs.push_back(kernPair);
+            }
+            break;
+        case GlyphIdentifierType::UNICODE_CODEPOINT: {
+            std::vector<unicode_t> codepoints = font.getCodepointTable();
+            for (const std::pair<const std::pair<int, int>, double> &elem : kerning) {
+                unicode_t codepoint1 = elem.first.first < (int) codepoints.size() ? codepoints[elem.first.first] : 0;
+                unicode_t codepoint2 = elem.first.second < (int) codepoints.size() ? codepoints[elem.first.second] : 0;
+                if (codepoint1 && codepoint2) {
+                    artery_font::KernPair<REAL> kernPair = { };
+                    kernPair.codepoint1 = codepoint1;
+                    kernPair.codepoint2 = codepoint2;
+                    kernPair.advance.h = REAL(elem.second);
+                    kernPairs.push_back(kernPair);
+                }
+            }
+            break;
+        }
+    }
+}
 
 template <typename REAL, typename T, int N>
 bool exportArteryFont(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstSection<T, N> &atlas, const char *filename, const ArteryFontExportProperties &properties) {
@@ -61,6 +116,7 @@ bool exportArteryFont(const FontGeometry *fonts, int fontCount, const msdfgen::B
     arfont.metadataFormat = artery_font::METADATA_NONE;
 
     arfont.variants = artery_font::StdList<typename artery_font::StdArteryFont<REAL>::Variant>(fontCount);
+    bool anyRotated = false;
     for (int i = 0; i < fontCount; ++i) {
         const FontGeometry &font = fonts[i];
         GlyphIdentifierType identifierType = font.getPreferredIdentifierType();
@@ -84,6 +140,7 @@ bool exportArteryFont(const FontGeometry *fonts, int fontCount, const msdfgen::B
             (std::string &) fontVariant.name = name;
         fontVariant.glyphs = artery_font::StdList<artery_font::Glyph<REAL> >(font.getGlyphs().size());
         int j = 0;
+        std::string rotatedGlyphs;
         for (const GlyphGeometry &glyphGeom : font.getGlyphs()) {
             artery_font::Glyph<REAL> &glyph = fontVariant.glyphs[j++];
             glyph.codepoint = glyphGeom.getIdentifier(identifierType);
@@ -101,32 +158,21 @@ bool exportArteryFont(const FontGeometry *fonts, int fontCount, const msdfgen::B
             glyph.imageBounds.t = REAL(t);
             glyph.advance.h = REAL(glyphGeom.getAdvance());
             glyph.advance.v = REAL(0);
+            if (glyphGeom.isBoxRotated()) {
+                if (!rotatedGlyphs.empty())
+                    rotatedGlyphs += ',';
+                rotatedGlyphs += std::to_string(glyph.codepoint);
+            }
         }
-        switch (identifierType) {
-            case GlyphIdentifierType::GLYPH_INDEX:
-                for (const std::pair<std::pair<int, int>, double> &elem : font.getKerning()) {
-                    artery_font::KernPair<REAL> kernPair = { };
-                    kernPair.codepoint1 = elem.first.first;
-                    kernPair.codepoint2 = elem.first.second;
-                    kernPair.advance.h = REAL(elem.second);
-                    ((std::vector<artery_font::KernPair<REAL> > &) fontVariant.kernPairs).push_back((artery_font::KernPair<REAL> &&) kernPair);
-                }
-                break;
-            case GlyphIdentifierType::UNICODE_CODEPOINT:
-                for (const std::pair<std::pair<int, int>, double> &elem : font.getKerning()) {
-                    const GlyphGeometry *glyph1 = font.getGlyph(msdfgen::GlyphIndex(elem.first.first));
-                    const GlyphGeometry *glyph2 = font.getGlyph(msdfgen::GlyphIndex(elem.first.second));
-                    if (glyph1 && glyph2 && glyph1->getCodepoint() && glyph2->getCodepoint()) {
-                        artery_font::KernPair<REAL> kernPair = { };
-                        kernPair.codepoint1 = glyph1->getCodepoint();
-                        kernPair.codepoint2 = glyph2->getCodepoint();
-                        kernPair.advance.h = REAL(elem.second);
-                        ((std::vector<artery_font::KernPair<REAL> > &) fontVariant.kernPairs).push_back((artery_font::KernPair<REAL> &&) kernPair);
-                    }
-                }
-                break;
+        // Artery Font has no per-glyph rotation field, rotated glyphs are listed in the variant's metadata
+        if (!rotatedGlyphs.empty()) {
+            (std::string &) fontVariant.metadata = "{\"rotatedGlyphs\":["+rotatedGlyphs+"]}";
+            anyRotated = true;
         }
+        buildKernPairs((std::vector<artery_font::KernPair<REAL> > &) fontVariant.kernPairs, font, identifierType);
     }
+    if (anyRotated)
+        arfont.metadataFormat = artery_font::METADATA_JSON;
 
     arfont.images = artery_font::StdList<typename artery_font::StdArteryFont<REAL>::Image>(1);
     {
@@ -138,8 +184,10 @@ bool exportArteryFont(const FontGeometry *fonts, int fontCount, const msdfgen::B
         switch (properties.imageFormat) {
         #ifndef MSDFGEN_DISABLE_PNG
             case ImageFormat::PNG:
+            case ImageFormat::PNG16:
                 image.encoding = artery_font::IMAGE_PNG;
-                image.pixelFormat = artery_font::PIXEL_UNSIGNED8;
+                // Artery Font has no 16-bit pixel format, 16-bit integer atlases are embedded as 16-bit PNG with unknown pixel format
+                image.pixelFormat = std::is_same<T, uint16_t>::value ? artery_font::PIXEL_UNKNOWN : artery_font::PIXEL_UNSIGNED8;
                 if (!encodePng((std::vector<byte> &) image.data, atlas))
                     return false;
                 break;
@@ -193,6 +241,12 @@ template bool exportArteryFont<float>(const FontGeometry *fonts, int fontCount,
 template bool exportArteryFont<float>(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstSection<float, 1> &atlas, const char *filename, const ArteryFontExportProperties &properties);
 template bool exportArteryFont<float>(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstSection<float, 3> &atlas, const char *filename, const ArteryFontExportProperties &properties);
 template bool exportArteryFont<float>(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstSection<float, 4> &atlas, const char *filename, const ArteryFontExportProperties &properties);
+template bool exportArteryFont<float>(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstSection<half, 1> &atlas, const char *filename, const ArteryFontExportProperties &properties);
+template bool exportArteryFont<float>(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstSection<half, 3> &atlas, const char *filename, const ArteryFontExportProperties &properties);
+template bool exportArteryFont<float>(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstSection<half, 4> &atlas, const char *filename, const ArteryFontExportProperties &properties);
+template bool exportArteryFont<float>(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstSection<uint16_t, 1> &atlas, const char *filename, const ArteryFontExportProperties &properties);
+template bool exportArteryFont<float>(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstSection<uint16_t, 3> &atlas, const char *filename, const ArteryFontExportProperties &properties);
+template bool exportArteryFont<float>(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstSection<uint16_t, 4> &atlas, const char *filename, const ArteryFontExportProperties &properties);
 
 }
 
@@ -0,0 +1,873 @@
+
+/*
+* MULTI-CHANNEL SIGNED DISTANCE FIELD ATLAS GENERATOR - benchmark program
+* -----------------------------------------------------------------------
+* Measures the individual stages of atlas generation and outputs the results as JSON
+*/
+
+#ifdef MSDF_ATLAS_BENCHMARK
+
+#define _USE_MATH_DEFINES
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+#include "msdf-atlas-gen.h"
+
+using namespace msdf_atlas;
+
+#define DEFAULT_GLYPH_COUNT 256
+#define DEFAULT_ITERATIONS 5
+#define DEFAULT_SIZE 32.0
+#define DEFAULT_PIXEL_RANGE 2.0
+#define DEFAULT_ANGLE_THRESHOLD 3.0
+#define DEFAULT_MITER_LIMIT 1.0
+/// Size of glyphs in pixels per em for the comparison of dense and sparse generation
+#define LARGE_GLYPH_SIZE 256.0
+#define SYNTHETIC_SEED 0x6d736466617467ull
+/// Number of times all glyphs are looked up in the LazyFontAtlas hit benchmark
+#define LAZY_HIT_ROUNDS 1000
+/// Frames of the simulated text editing trace - typing one glyph per frame, then scrolling in a new line per frame
+#define TRACE_TYPING_FRAMES 600
+#define TRACE_SCROLLING_FRAMES 200
+#define TRACE_LINE_LENGTH 80
+#define TRACE_SEED 0x7472616365ull
+/// Size of the synthetic metrics written in the TextFileWriter benchmark
+#define WRITER_GLYPHS 50000
+#define WRITER_KERNING_PAIRS 1000000
+#define WRITER_SEED 0x6a736f6eull
+/// Every N-th glyph is treated as newly added in the incremental build benchmark
+#define INCREMENTAL_ADDED_INTERVAL 20
+/// Temporary file for the benchmarks of exports into named files, removed afterwards
+#define TEMP_FILENAME "msdf-atlas-gen-bench.tmp"
+
+static const char *const helpText = R"(
+Usage: msdf-atlas-gen-bench [options]
+
+  -font <filename.ttf/otf>
+      Benchmarks the printable ASCII glyphs of the font, including lookups in LazyFontAtlas, and the metrics and kerning of all of its glyphs. Synthetic glyphs are used if not specified.
+  -glyphs <N>
+      Sets the number of synthetic glyphs. The default value is 256.
+  -size <em size>
+      Sets the size of the glyphs in pixels per em. The default value is 32.
+  -iterations <N>
+      Sets how many times each benchmark is repeated. The default value is 5.
+  -threads <N>
+      Sets the number of threads used by the generator benchmarks. The default value is 1.
+  -json <filename.json>
+      Writes the results into a JSON file instead of the standard output.
+)";
+
+static bool parseUnsigned(unsigned &value, const char *arg) {
+    char c;
+    return sscanf(arg, "%u%c", &value, &c) == 1;
+}
+
+static bool parseDouble(double &value, const char *arg) {
+    char c;
+    return sscanf(arg, "%lf%c", &value, &c) == 1;
+}
+
+/// Deterministic xorshift generator, so that synthetic glyphs are identical across runs and platforms
+class RandomGenerator {
+
+public:
+    explicit RandomGenerator(unsigned long long seed) : state(seed ? seed : 1) { }
+    /// Returns a value in the range [0, 1)
+    double next() {
+        state ^= state<<13;
+        state ^= state>>7;
+        state ^= state<<17;
+        return (double) (state>>11)*(1.0/9007199254740992.0);
+    }
+    double range(double lower, double upper) {
+        return lower+(upper-lower)*next();
+    }
+
+private:
+    unsigned long long state;
+
+};
+
+/// Adds a closed contour around an ellipse with edgeCount linear, quadratic and cubic edges of random curvature
+static void addSyntheticContour(msdfgen::Shape &shape, RandomGenerator &random, msdfgen::Point2 center, msdfgen::Vector2 radius, int edgeCount, bool reverse) {
+    std::vector<msdfgen::Point2> points(edgeCount);
+    for (int i = 0; i < edgeCount; ++i) {
+        double angle = 2*M_PI*(i+random.range(-.25, .25))/edgeCount;
+        if (reverse)
+            angle = -angle;
+        double r = random.range(.8, 1);
+        points[i] = center+msdfgen::Vector2(r*radius.x*cos(angle), r*radius.y*sin(angle));
+    }
+    msdfgen::Contour &contour = shape.addContour();
+    for (int i = 0; i < edgeCount; ++i) {
+        msdfgen::Point2 a = points[i], b = points[(i+1)%edgeCount];
+        msdfgen::Vector2 bulge = .25*random.range(-1, 1)*(b-a).getOrthonormal();
+        switch ((int) (3*random.next())) {
+            case 0:
+                contour.addEdge(msdfgen::EdgeHolder(a, b));
+                break;
+            case 1:
+                contour.addEdge(msdfgen::EdgeHolder(a, .5*(a+b)+bulge, b));
+                break;
+            default:
+                contour.addEdge(msdfgen::EdgeHolder(a, a+(1/3.)*(b-a)+bulge, a+(2/3.)*(b-a)-bulge, b));
+        }
+    }
+}
+
+/// Generates a glyph-like shape within the em square - an outer contour and possibly a hole, with 4 to 32 edges each
+static msdfgen::Shape generateSyntheticShape(RandomGenerator &random) {
+    msdfgen::Shape shape;
+    msdfgen::Point2 center(.35, .35);
+    msdfgen::Vector2 radius(random.range(.15, .3), random.range(.25, .35));
+    addSyntheticContour(shape, random, center, radius, 4+(int) (29*random.next()), false);
+    if (random.next() < .5)
+        addSyntheticContour(shape, random, center, random.range(.3, .5)*radius, 4+(int) (29*random.next()), true);
+    return shape;
+}
+
+struct BenchmarkResult {
+    const char *name;
+    /// Number of processed items (glyphs, rectangles, pixels or written records)
+    unsigned long long items;
+    /// Number of generated glyphs for generator benchmarks, whose throughput is also reported in glyphs per second, otherwise 0
+    unsigned long long glyphs;
+    /// Number of written or read bytes for serialization benchmarks, whose throughput is also reported in MB/s, otherwise 0
+    unsigned long long bytes;
+    /// For packer benchmarks, the fraction of the area spanned by the packed rectangles that they cover, otherwise 0
+    double occupancy;
+    /// Number of rectangles that didn't fit for packer benchmarks
+    int failed;
+    /// Times of the individual iterations in seconds, sorted
+    std::vector<double> times;
+};
+
+/**
+ * Runs setup() followed by a measured run() once to warm up and then iterations times.
+ * Only run() is measured, setup() prepares its input (e.g. a fresh copy of data that run() modifies).
+ */
+template <typename SETUP_FN, typename RUN_FN>
+static BenchmarkResult benchmark(const char *name, unsigned long long items, int iterations, SETUP_FN setup, RUN_FN run) {
+    BenchmarkResult result;
+    result.name = name;
+    result.items = items;
+    result.glyphs = 0;
+    result.bytes = 0;
+    result.occupancy = 0;
+    result.failed = 0;
+    for (int i = -1; i < iterations; ++i) {
+        setup();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        run();
+        double time = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+        if (i >= 0)
+            result.times.push_back(time);
+    }
+    std::sort(result.times.begin(), result.times.end());
+    return result;
+}
+
+static void printResult(const BenchmarkResult &result) {
+    double median = result.times[result.times.size()/2];
+    if (result.glyphs)
+        fprintf(stderr, "%-48s %10.3f ms %12.0f glyphs/s\n", result.name, 1e3*median, (double) result.glyphs/median);
+    else if (result.bytes)
+        fprintf(stderr, "%-48s %10.3f ms %12.1f MB/s\n", result.name, 1e3*median, 1e-6*(double) result.bytes/median);
+    else if (result.occupancy > 0)
+        fprintf(stderr, "%-48s %10.3f ms %11.1f%% occupancy, %d failed\n", result.name, 1e3*median, 100*result.occupancy, result.failed);
+    else
+        fprintf(stderr, "%-48s %10.3f ms\n", result.name, 1e3*median);
+}
+
+template <typename T, int N, GeneratorFunction<float, N> GEN_FN>
+static BenchmarkResult benchmarkGenerator(const char *name, const std::vector<GlyphGeometry> &glyphs, int width, int height, const GeneratorAttributes &attributes, int threadCount, int iterations) {
+    unsigned long long pixels = 0, glyphCount = 0;
+    for (const GlyphGeometry &glyph : glyphs) {
+        int w, h;
+        glyph.getBoxSize(w, h);
+        pixels += (unsigned long long) w*h;
+        glyphCount += !glyph.isWhitespace();
+    }
+    BenchmarkResult result = benchmark(name, pixels, iterations, []() { }, [&]() {
+        ImmediateAtlasGenerator<float, N, GEN_FN, BitmapAtlasStorage<T, N> > generator(width, height);
+        generator.setAttributes(attributes);
+        generator.setThreadCount(threadCount);
+        generator.generate(glyphs.data(), (int) glyphs.size());
+    });
+    result.glyphs = glyphCount;
+    return result;
+}
+
+/// Returns the fraction of the bounding box of the placed rectangles (those with non-negative coordinates) that they cover
+static double computeOccupancy(const std::vector<Rectangle> &rectangles) {
+    unsigned long long area = 0;
+    int width = 0, height = 0;
+    for (const Rectangle &rect : rectangles) {
+        if (rect.x >= 0 && rect.y >= 0) {
+            area += (unsigned long long) rect.w*rect.h;
+            width = std::max(width, rect.x+rect.w);
+            height = std::max(height, rect.y+rect.h);
+        }
+    }
+    return width > 0 && height > 0 ? (double) area/((double) width*height) : 0;
+}
+
+/**
+ * Measures an incremental build (see packIncrementally) which adds every INCREMENTAL_ADDED_INTERVAL-th of the packed glyphs
+ * into the MSDF atlas of the others. Glyphs are identified by their position, since synthetic glyphs all have the same index.
+ * Returns false if the added glyphs didn't fit.
+ */
+static bool benchmarkIncrementalAdd(std::vector<BenchmarkResult> &results, const std::vector<GlyphGeometry> &glyphs, int width, int height, const GeneratorAttributes &attributes, int threadCount, int iterations) {
+    IncrementalAtlasCache cache = { };
+    cache.width = width, cache.height = height;
+    std::vector<IncrementalAtlasCache::Glyph> keys(glyphs.size());
+    std::vector<GlyphGeometry> previousGlyphs;
+    unsigned long long addedCount = 0;
+    for (size_t i = 0; i < glyphs.size(); ++i) {
+        IncrementalAtlasCache::Glyph &key = keys[i];
+        key.index = (int) i;
+        Rectangle rect = glyphs[i].getBoxRect();
+        key.x = rect.x, key.y = rect.y;
+        glyphs[i].getBoxSize(key.w, key.h);
+        key.rotated = glyphs[i].isBoxRotated();
+        if (i%INCREMENTAL_ADDED_INTERVAL) {
+            cache.glyphs.push_back(key);
+            previousGlyphs.push_back(glyphs[i]);
+        } else
+            addedCount += !glyphs[i].isWhitespace();
+    }
+    ImmediateAtlasGenerator<float, 3, msdfGenerator, BitmapAtlasStorage<byte, 3> > previousGenerator(width, height);
+    previousGenerator.setAttributes(attributes);
+    previousGenerator.setThreadCount(threadCount);
+    previousGenerator.generate(previousGlyphs.data(), (int) previousGlyphs.size());
+    const msdfgen::BitmapConstSection<byte, 3> previousAtlas = (msdfgen::BitmapConstSection<byte, 3>) previousGenerator.atlasStorage();
+
+    std::vector<GlyphGeometry> workGlyphs, addedGlyphs;
+    std::vector<int> changedGlyphs;
+    int remaining = 0;
+    BenchmarkResult result = benchmark("packIncrementally+generate/msdf", addedCount, iterations, [&]() {
+        workGlyphs = glyphs;
+    }, [&]() {
+        if (!(remaining = packIncrementally(changedGlyphs, workGlyphs.data(), keys.data(), nullptr, (int) workGlyphs.size(), cache, 0, PackingAlgorithm::GUILLOTINE, false))) {
+            addedGlyphs.clear();
+            for (int i : changedGlyphs)
+                addedGlyphs.push_back(workGlyphs[i]);
+            ImmediateAtlasGenerator<float, 3, msdfGenerator, BitmapAtlasStorage<byte, 3> > generator(width, height, previousAtlas);
+            generator.setAttributes(attributes);
+            generator.setThreadCount(threadCount);
+            generator.generate(addedGlyphs.data(), (int) addedGlyphs.size());
+        }
+    });
+    if (remaining)
+        return false;
+    result.glyphs = addedCount;
+    results.push_back(result);
+    return true;
+}
+
+#ifndef MSDF_ATLAS_NO_ARTERY_FONT
+/// Measures the export of the font's metrics and kerning into an Artery Font file, with a minimal atlas image so that the kerning pairs dominate
+static bool benchmarkArteryFontKerning(std::vector<BenchmarkResult> &results, const FontGeometry &font, int iterations) {
+    ArteryFontExportProperties properties;
+    properties.fontSize = 1;
+    properties.pxRange = msdfgen::Range(DEFAULT_PIXEL_RANGE);
+    properties.imageType = ImageType::MSDF;
+    properties.imageFormat = ImageFormat::BINARY;
+    msdfgen::Bitmap<byte, 3> atlas(1, 1);
+    const msdfgen::Bitmap<byte, 3> &constAtlas = atlas;
+    bool success = true;
+    results.push_back(benchmark("exportArteryFont/kerning", font.getKerning().size(), iterations, []() { }, [&]() {
+        success &= exportArteryFont<float, byte, 3>(&font, 1, constAtlas, TEMP_FILENAME, properties);
+    }));
+    remove(TEMP_FILENAME);
+    return success;
+}
+#endif
+
+typedef ImmediateAtlasGenerator<float, 3, msdfGenerator, BitmapAtlasStorage<byte, 3> > LazyAtlasGenerator;
+
+/// Measures the lookups of the codepoints in a LazyFontAtlas - misses load, color, pack and generate each glyph, hits find it already loaded
+static void benchmarkLazyFontAtlas(std::vector<BenchmarkResult> &results, msdfgen::FontHandle *font, const Charset &charset, double emSize, bool preprocessGeometry, int iterations) {
+    GlyphGeometry::GlyphAttributes glyphAttributes = { };
+    glyphAttributes.scale = emSize;
+    glyphAttributes.range = DEFAULT_PIXEL_RANGE/emSize;
+    glyphAttributes.miterLimit = DEFAULT_MITER_LIMIT;
+    std::unique_ptr<DynamicAtlas<LazyAtlasGenerator> > atlas;
+    std::unique_ptr<LazyFontAtlas<LazyAtlasGenerator> > lazyAtlas;
+    auto setup = [&]() {
+        lazyAtlas.reset();
+        atlas.reset(new DynamicAtlas<LazyAtlasGenerator>(0));
+        lazyAtlas.reset(new LazyFontAtlas<LazyAtlasGenerator>(*atlas, glyphAttributes));
+        lazyAtlas->setEdgeColoring(&msdfgen::edgeColoringInkTrap, DEFAULT_ANGLE_THRESHOLD, 0);
+        lazyAtlas->setFont(font, 1, preprocessGeometry);
+    };
+    results.push_back(benchmark("LazyFontAtlas::getGlyph/miss", charset.size(), iterations, setup, [&]() {
+        for (unicode_t codepoint : charset)
+            lazyAtlas->getGlyph(codepoint);
+    }));
+    results.push_back(benchmark("LazyFontAtlas::getGlyph/hit", (unsigned long long) LAZY_HIT_ROUNDS*charset.size(), iterations, [&]() {
+        setup();
+        for (unicode_t codepoint : charset)
+            lazyAtlas->getGlyph(codepoint);
+    }, [&]() {
+        // Accumulated so that the lookups cannot be optimized out
+        volatile int found = 0;
+        for (int i = 0; i < LAZY_HIT_ROUNDS; ++i) {
+            for (unicode_t codepoint : charset)
+                found = found+!!lazyAtlas->getGlyph(codepoint);
+        }
+    }));
+}
+
+/// Writes metrics of synthetic glyphs and kerning pairs in the layout of the JSON export, values are in font units divided by units per em like those of real fonts
+static void writeSyntheticMetrics(TextFileWriter &writer) {
+    static const double UNITS_PER_EM = 1000;
+    RandomGenerator random(WRITER_SEED);
+    writer.writeString("{\"glyphs\":[");
+    for (int i = 0; i < WRITER_GLYPHS; ++i) {
+        if (i)
+            writer.writeChar(',');
+        writer.writeString("{\"unicode\":");
+        writer.writeInteger(i);
+        writer.writeString(",\"advance\":");
+        writer.writeReal((int) (1000*random.next())/UNITS_PER_EM);
+        writer.writeString(",\"planeBounds\":{\"left\":");
+        writer.writeReal((int) (-100*random.next())/UNITS_PER_EM);
+        writer.writeString(",\"bottom\":");
+        writer.writeReal((int) (-250*random.next())/UNITS_PER_EM);
+        writer.writeString(",\"right\":");
+        writer.writeReal((int) (1000*random.next())/UNITS_PER_EM);
+        writer.writeString(",\"top\":");
+        writer.writeReal((int) (1000*random.next())/UNITS_PER_EM);
+        writer.writeString("},\"atlasBounds\":{\"left\":");
+        writer.writeReal(.5*(int) (8192*random.next()));
+        writer.writeString(",\"bottom\":");
+        writer.writeReal(.5*(int) (8192*random.next()));
+        writer.writeString(",\"right\":");
+        writer.writeReal(.5*(int) (8192*random.next()));
+        writer.writeString(",\"top\":");
+        writer.writeReal(.5*(int) (8192*random.next()));
+        writer.writeString("}}");
+    }
+    writer.writeString("],\"kerning\":[");
+    for (int i = 0; i < WRITER_KERNING_PAIRS; ++i) {
+        if (i)
+            writer.writeChar(',');
+        writer.writeString("{\"unicode1\":");
+        writer.writeInteger((int) (WRITER_GLYPHS*random.next()));
+        writer.writeString(",\"unicode2\":");
+        writer.writeInteger((int) (WRITER_GLYPHS*random.next()));
+        writer.writeString(",\"advance\":");
+        writer.writeReal((int) (-200*random.next())/UNITS_PER_EM);
+        writer.writeChar('}');
+    }
+    writer.writeString("]}\n");
+}
+
+/// Measures the throughput of TextFileWriter writing synthetic JSON metrics into a temporary file
+static bool benchmarkTextFileWriter(std::vector<BenchmarkResult> &results, int iterations) {
+    FILE *file = tmpfile();
+    if (!file)
+        return false;
+    bool success = true;
+    static const struct {
+        const char *name;
+        bool compactPrecision;
+    } modes[] = {
+        { "TextFileWriter/json", false },
+        { "TextFileWriter/json/compact", true }
+    };
+    for (const auto &mode : modes) {
+        BenchmarkResult result = benchmark(mode.name, (unsigned long long) WRITER_GLYPHS+WRITER_KERNING_PAIRS, iterations, [&]() {
+            rewind(file);
+        }, [&]() {
+            TextFileWriter writer(file);
+            writer.setCompactPrecision(mode.compactPrecision);
+            writeSyntheticMetrics(writer);
+            success &= writer.flush();
+        });
+        long size = ftell(file);
+        success &= size > 0;
+        result.bytes = (unsigned long long) size;
+        results.push_back(result);
+    }
+    fclose(file);
+    return success;
+}
+
+/// Reads the whole file into 4-byte aligned memory
+static bool readFile(std::vector<uint32_t> &data, size_t &size, const char *filename) {
+    FILE *file = fopen(filename, "rb");
+    if (!file)
+        return false;
+    bool success = !fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    success = success && length >= 0 && !fseek(file, 0, SEEK_SET);
+    if (success) {
+        size = (size_t) length;
+        data.resize((size+3)/4);
+        success = fread(data.data(), 1, size, file) == size;
+    }
+    fclose(file);
+    return success;
+}
+
+/// Exports the font's metrics in the binary format and measures opening it in BinaryMetricsReader followed by a lookup of each glyph and kerning pair
+static bool benchmarkBinaryMetrics(std::vector<BenchmarkResult> &results, const FontGeometry &font, int iterations) {
+    BinaryMetricsExportProperties properties = { };
+    properties.imageType = ImageType::MSDF;
+    properties.distanceRange = msdfgen::Range(DEFAULT_PIXEL_RANGE);
+    properties.size = 1;
+    properties.yDirection = msdfgen::Y_UPWARD;
+    properties.kerning = true;
+    std::vector<uint32_t> data;
+    size_t size = 0;
+    bool success = exportBinaryMetrics(&font, 1, TEMP_FILENAME, properties) && readFile(data, size, TEMP_FILENAME);
+    remove(TEMP_FILENAME);
+    BinaryMetricsReader reader;
+    BinaryMetricsReader::Font metrics = { };
+    if (!(success && reader.open(data.data(), size) && reader.getFont(metrics, 0)))
+        return false;
+    uint32_t glyphCount = metrics.properties->glyphCount, kernPairCount = metrics.properties->kernPairCount;
+    BenchmarkResult result = benchmark("BinaryMetricsReader/lookup", (unsigned long long) glyphCount+kernPairCount, iterations, []() { }, [&]() {
+        BinaryMetricsReader reader;
+        BinaryMetricsReader::Font metrics = { };
+        if (reader.open(data.data(), size) && reader.getFont(metrics, 0)) {
+            // Accumulated so that the lookups cannot be optimized out
+            volatile int found = 0;
+            volatile float kerning = 0;
+            for (uint32_t i = 0; i < glyphCount; ++i)
+                found = found+(metrics.findGlyph(metrics.identifiers[i]) >= 0);
+            for (uint32_t i = 0; i < kernPairCount; ++i)
+                kerning = kerning+metrics.getKerning(metrics.kernPairs[i].identifier1, metrics.kernPairs[i].identifier2);
+        }
+    });
+    result.bytes = (unsigned long long) size;
+    results.push_back(result);
+    return true;
+}
+
+typedef ImmediateAtlasGenerator<float, 1, sdfGenerator, BitmapAtlasStorage<byte, 1> > TraceAtlasGenerator;
+
+/// Generates the glyph requests of each frame of a text editing session, glyphs are drawn from a skewed distribution like letter frequencies
+static std::vector<std::vector<int> > generateEditingTrace(int glyphCount) {
+    RandomGenerator random(TRACE_SEED);
+    std::vector<std::vector<int> > frames(TRACE_TYPING_FRAMES+TRACE_SCROLLING_FRAMES);
+    for (int i = 0; i < TRACE_TYPING_FRAMES; ++i)
+        frames[i].push_back(std::min((int) (glyphCount*pow(random.next(), 3)), glyphCount-1));
+    for (int i = TRACE_TYPING_FRAMES; i < TRACE_TYPING_FRAMES+TRACE_SCROLLING_FRAMES; ++i) {
+        for (int j = 0; j < TRACE_LINE_LENGTH; ++j)
+            frames[i].push_back(std::min((int) (glyphCount*pow(random.next(), 3)), glyphCount-1));
+    }
+    return frames;
+}
+
+/**
+ * Replays the editing trace with glyphs requested through DynamicAtlasBatcher and flushed once per frame,
+ * and with each new glyph added to DynamicAtlas directly. Glyphs are identified by their position (as the font ID),
+ * since synthetic glyphs all have the same index.
+ */
+static void benchmarkBatcherTrace(std::vector<BenchmarkResult> &results, const std::vector<GlyphGeometry> &glyphs, int iterations) {
+    std::vector<std::vector<int> > frames = generateEditingTrace((int) glyphs.size());
+    unsigned long long requests = 0;
+    for (const std::vector<int> &frame : frames)
+        requests += frame.size();
+    std::unique_ptr<DynamicAtlas<TraceAtlasGenerator> > atlas;
+    std::unique_ptr<DynamicAtlasBatcher<TraceAtlasGenerator> > batcher;
+    results.push_back(benchmark("DynamicAtlasBatcher/trace", requests, iterations, [&]() {
+        batcher.reset();
+        atlas.reset(new DynamicAtlas<TraceAtlasGenerator>(0));
+        batcher.reset(new DynamicAtlasBatcher<TraceAtlasGenerator>(*atlas));
+    }, [&]() {
+        for (const std::vector<int> &frame : frames) {
+            for (int i : frame)
+                batcher->request(i, glyphs[i]);
+            batcher->flush();
+        }
+    }));
+    std::vector<bool> added;
+    results.push_back(benchmark("DynamicAtlas::add/trace", requests, iterations, [&]() {
+        batcher.reset();
+        atlas.reset(new DynamicAtlas<TraceAtlasGenerator>(0));
+        added.assign(glyphs.size(), false);
+    }, [&]() {
+        for (const std::vector<int> &frame : frames) {
+            for (int i : frame) {
+                if (!added[i]) {
+                    GlyphGeometry glyph = glyphs[i];
+                    atlas->add(&glyph, 1);
+                    added[i] = true;
+                }
+            }
+        }
+    }));
+    batcher.reset();
+}
+
+/// Rasterizes the glyph with msdfgen instead of the ScanlineRasterizer for comparison
+static void msdfgenScanlineGenerator(const msdfgen::BitmapSection<float, 1> &output, const GlyphGeometry &glyph, const GeneratorAttributes &) {
+    msdfgen::rasterize(output, glyph.getShape(), glyph.getBoxScale(), glyph.getBoxTranslate(), MSDF_ATLAS_GLYPH_FILL_RULE);
+}
+
+static bool writeResults(FILE *file, const std::vector<BenchmarkResult> &results, const char *fontFilename, int glyphCount, double emSize, int width, int height, int iterations, int threadCount) {
+    TextFileWriter writer(file);
+    writer.writeString("{\"configuration\":{\"font\":");
+    if (fontFilename) {
+        writer.writeChar('"');
+        for (const char *c = fontFilename; *c; ++c) {
+            if (*c == '"' || *c == '\\')
+                writer.writeChar('\\');
+            writer.writeChar(*c);
+        }
+        writer.writeChar('"');
+    } else
+        writer.writeString("null");
+    writer.writeString(",\"glyphs\":");
+    writer.writeInteger(glyphCount);
+    writer.writeString(",\"size\":");
+    writer.writeReal(emSize);
+    writer.writeString(",\"width\":");
+    writer.writeInteger(width);
+    writer.writeString(",\"height\":");
+    writer.writeInteger(height);
+    writer.writeString(",\"iterations\":");
+    writer.writeInteger(iterations);
+    writer.writeString(",\"threads\":");
+    writer.writeInteger(threadCount);
+    writer.writeString("},\"benchmarks\":[");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult &result = results[i];
+        double mean = 0;
+        for (double time : result.times)
+            mean += time;
+        mean /= (double) result.times.size();
+        if (i)
+            writer.writeChar(',');
+        writer.writeString("{\"name\":\"");
+        writer.writeString(result.name);
+        writer.writeString("\",\"items\":");
+        writer.writeInteger((long long) result.items);
+        if (result.glyphs) {
+            writer.writeString(",\"glyphsPerSecond\":");
+            writer.writeReal((double) result.glyphs/result.times[result.times.size()/2]);
+        }
+        if (result.bytes) {
+            writer.writeString(",\"megabytesPerSecond\":");
+            writer.writeReal(1e-6*(double) result.bytes/result.times[result.times.size()/2]);
+        }
+        if (result.occupancy > 0) {
+            writer.writeString(",\"occupancy\":");
+            writer.writeReal(result.occupancy);
+            writer.writeString(",\"failed\":");
+            writer.writeInteger(result.failed);
+        }
+        writer.writeString(",\"min\":");
+        writer.writeReal(result.times.front());
+        writer.writeString(",\"median\":");
+        writer.writeReal(result.times[result.times.size()/2]);
+        writer.writeString(",\"mean\":");
+        writer.writeReal(mean);
+        writer.writeString(",\"max\":");
+        writer.writeReal(result.times.back());
+        writer.writeChar('}');
+    }
+    writer.writeString("]}\n");
+    return writer.flush();
+}
+
+int main(int argc, const char *const *argv) {
+    #define ABORT(msg) do { fputs(msg "\n", stderr); return 1; } while (false)
+
+    const char *fontFilename = nullptr;
+    const char *jsonFilename = nullptr;
+    unsigned syntheticGlyphCount = DEFAULT_GLYPH_COUNT;
+    unsigned iterations = DEFAULT_ITERATIONS;
+    unsigned threadCount = 1;
+    double emSize = DEFAULT_SIZE;
+    for (int argPos = 1; argPos < argc; ++argPos) {
+        const char *arg = argv[argPos];
+        bool hasValue = argPos+1 < argc;
+        if (!strcmp(arg, "-font") && hasValue)
+            fontFilename = argv[++argPos];
+        else if (!strcmp(arg, "-json") && hasValue)
+            jsonFilename = argv[++argPos];
+        else if (!strcmp(arg, "-glyphs") && hasValue) {
+            if (!(parseUnsigned(syntheticGlyphCount, argv[++argPos]) && syntheticGlyphCount))
+                ABORT("Invalid glyph count. Use -glyphs <N> with N being a positive integer.");
+        } else if (!strcmp(arg, "-size") && hasValue) {
+            if (!(parseDouble(emSize, argv[++argPos]) && emSize > 0))
+                ABORT("Invalid em size argument. Use -size <em size> with a positive real number.");
+        } else if (!strcmp(arg, "-iterations") && hasValue) {
+            if (!(parseUnsigned(iterations, argv[++argPos]) && iterations))
+                ABORT("Invalid iteration count. Use -iterations <N> with N being a positive integer.");
+        } else if (!strcmp(arg, "-threads") && hasValue) {
+            if (!(parseUnsigned(threadCount, argv[++argPos]) && threadCount))
+                ABORT("Invalid thread count. Use -threads <N> with N being a positive integer.");
+        } else if (!strcmp(arg, "-help")) {
+            puts(helpText);
+            return 0;
+        } else {
+            fprintf(stderr, "Unknown setting or insufficient parameters: %s\n", arg);
+            puts(helpText);
+            return 1;
+        }
+    }
+
+    bool preprocessGeometry = (
+        #ifdef MSDFGEN_USE_SKIA
+            true
+        #else
+            false
+        #endif
+    );
+    std::vector<BenchmarkResult> results;
+    std::vector<GlyphGeometry> glyphs;
+
+    // Load
+    if (fontFilename) {
+        msdfgen::FreetypeHandle *ft = msdfgen::initializeFreetype();
+        if (!ft)
+            ABORT("Failed to initialize FreeType library.");
+        msdfgen::FontHandle *font = msdfgen::loadFont(ft, fontFilename);
+        if (!font) {
+            msdfgen::deinitializeFreetype(ft);
+            ABORT("Failed to load specified font file.");
+        }
+        msdfgen::FontMetrics metrics = { };
+        msdfgen::getFontMetrics(metrics, font, msdfgen::FONT_SCALING_NONE);
+        double geometryScale = metrics.emSize > 0 ? 1/metrics.emSize : 1;
+        results.push_back(benchmark("GlyphGeometry::load", Charset::ASCII.size(), iterations, [&]() {
+            glyphs.clear();
+        }, [&]() {
+            for (unicode_t codepoint : Charset::ASCII) {
+                GlyphGeometry glyph;
+                if (glyph.load(font, geometryScale, codepoint, preprocessGeometry))
+                    glyphs.push_back((GlyphGeometry &&) glyph);
+            }
+        }));
+        benchmarkLazyFontAtlas(results, font, Charset::ASCII, emSize, preprocessGeometry, iterations);
+        // Metrics of all glyphs of the font with kerning
+        std::vector<GlyphGeometry> allGlyphs;
+        FontGeometry fontGeometry(&allGlyphs);
+        unsigned allGlyphCount = 0;
+        msdfgen::getGlyphCount(allGlyphCount, font);
+        fontGeometry.loadGlyphRange(font, 1, 0, allGlyphCount, preprocessGeometry, true);
+        if (!benchmarkBinaryMetrics(results, fontGeometry, iterations))
+            fputs("Failed to export and read binary metrics, skipping its benchmark.\n", stderr);
+#ifndef MSDF_ATLAS_NO_ARTERY_FONT
+        if (!benchmarkArteryFontKerning(results, fontGeometry, iterations))
+            fputs("Failed to export Artery Font file.\n", stderr);
+#endif
+        msdfgen::destroyFont(font);
+        msdfgen::deinitializeFreetype(ft);
+    } else {
+        std::vector<msdfgen::Shape> shapes;
+        RandomGenerator random(SYNTHETIC_SEED);
+        for (unsigned i = 0; i < syntheticGlyphCount; ++i)
+            shapes.push_back(generateSyntheticShape(random));
+        results.push_back(benchmark("GlyphGeometry::load", shapes.size(), iterations, [&]() {
+            glyphs.clear();
+        }, [&]() {
+            for (const msdfgen::Shape &shape : shapes) {
+                GlyphGeometry glyph;
+                if (glyph.load(shape, 1, .7, preprocessGeometry))
+                    glyphs.push_back((GlyphGeometry &&) glyph);
+            }
+        }));
+    }
+    if (glyphs.empty())
+        ABORT("No glyphs loaded.");
+    int glyphCount = (int) glyphs.size();
+
+    // Edge coloring
+    std::vector<GlyphGeometry> workGlyphs;
+    results.push_back(benchmark("GlyphGeometry::edgeColoring", glyphCount, iterations, [&]() {
+        workGlyphs = glyphs;
+    }, [&]() {
+        for (GlyphGeometry &glyph : workGlyphs)
+            glyph.edgeColoring(&msdfgen::edgeColoringInkTrap, DEFAULT_ANGLE_THRESHOLD, 0);
+    }));
+    glyphs = workGlyphs;
+
+    // Packing
+    int width = 0, height = 0;
+    TightAtlasPacker tightPacker;
+    tightPacker.setScale(emSize);
+    tightPacker.setPixelRange(DEFAULT_PIXEL_RANGE);
+    tightPacker.setMiterLimit(DEFAULT_MITER_LIMIT);
+    BenchmarkResult tightResult = benchmark("TightAtlasPacker::pack", glyphCount, iterations, [&]() {
+        workGlyphs = glyphs;
+        tightPacker.unsetDimensions();
+    }, [&]() {
+        tightPacker.pack(workGlyphs.data(), glyphCount);
+    });
+    tightPacker.getDimensions(width, height);
+    if (!(width > 0 && height > 0))
+        ABORT("Failed to pack glyphs into atlas.");
+    std::vector<GlyphGeometry> packedGlyphs = workGlyphs;
+    unsigned long long boxArea = 0;
+    for (const GlyphGeometry &glyph : packedGlyphs) {
+        int w, h;
+        glyph.getBoxSize(w, h);
+        boxArea += (unsigned long long) w*h;
+    }
+    tightResult.occupancy = (double) boxArea/((double) width*height);
+    results.push_back(tightResult);
+
+    GridAtlasPacker gridPacker;
+    gridPacker.setScale(emSize);
+    gridPacker.setPixelRange(DEFAULT_PIXEL_RANGE);
+    gridPacker.setMiterLimit(DEFAULT_MITER_LIMIT);
+    results.push_back(benchmark("GridAtlasPacker::pack", glyphCount, iterations, [&]() {
+        workGlyphs = glyphs;
+        gridPacker.unsetDimensions();
+    }, [&]() {
+        gridPacker.pack(workGlyphs.data(), glyphCount);
+    }));
+    // The grid packer's cost grows with the glyph count, which is extended by repeating the glyphs
+    static const struct {
+        const char *name;
+        int glyphCount;
+    } gridSizes[] = {
+        { "GridAtlasPacker::pack/1k", 1000 },
+        { "GridAtlasPacker::pack/10k", 10000 },
+        { "GridAtlasPacker::pack/65k", 65536 }
+    };
+    for (const auto &gridSize : gridSizes) {
+        results.push_back(benchmark(gridSize.name, gridSize.glyphCount, iterations, [&]() {
+            workGlyphs.clear();
+            workGlyphs.reserve(gridSize.glyphCount);
+            for (int i = 0; i < gridSize.glyphCount; ++i)
+                workGlyphs.push_back(glyphs[i%glyphCount]);
+            gridPacker.unsetDimensions();
+        }, [&]() {
+            gridPacker.pack(workGlyphs.data(), gridSize.glyphCount);
+        }));
+    }
+
+    // The packing area leaves some slack, since the other algorithms may not fit the boxes as tightly as the tight packer.
+    // Boxes that don't fit keep their negative coordinates, so that they can be excluded from the occupancy
+    std::vector<Rectangle> boxes(glyphCount), workBoxes;
+    for (int i = 0; i < glyphCount; ++i) {
+        boxes[i].x = -1, boxes[i].y = -1;
+        packedGlyphs[i].getBoxSize(boxes[i].w, boxes[i].h);
+    }
+    static const struct {
+        const char *name;
+        PackingAlgorithm algorithm;
+    } packingAlgorithms[] = {
+        { "RectanglePacker::pack/guillotine", PackingAlgorithm::GUILLOTINE },
+        { "RectanglePacker::pack/maxrects", PackingAlgorithm::MAX_RECTS },
+        { "RectanglePacker::pack/skyline", PackingAlgorithm::SKYLINE },
+        { "RectanglePacker::pack/shelf", PackingAlgorithm::SHELF }
+    };
+    for (const auto &packingAlgorithm : packingAlgorithms) {
+        int failed = 0;
+        BenchmarkResult result = benchmark(packingAlgorithm.name, glyphCount, iterations, [&]() {
+            workBoxes = boxes;
+        }, [&]() {
+            RectanglePacker packer(width+width/4, height+height/4, packingAlgorithm.algorithm);
+            failed = packer.pack(workBoxes.data(), glyphCount);
+        });
+        result.occupancy = computeOccupancy(workBoxes);
+        result.failed = failed;
+        results.push_back(result);
+    }
+
+    // Generation
+    GeneratorAttributes attributes;
+    attributes.config.overlapSupport = !preprocessGeometry;
+    attributes.scanlinePass = !preprocessGeometry;
+    results.push_back(benchmarkGenerator<byte, 1, scanlineGenerator>("ImmediateAtlasGenerator::generate/hardmask", packedGlyphs, width, height, attributes, threadCount, iterations));
+    results.push_back(benchmarkGenerator<byte, 1, msdfgenScanlineGenerator>("ImmediateAtlasGenerator::generate/hardmask/msdfgen", packedGlyphs, width, height, attributes, threadCount, iterations));
+    results.push_back(benchmarkGenerator<byte, 1, softMaskGenerator>("ImmediateAtlasGenerator::generate/softmask", packedGlyphs, width, height, attributes, threadCount, iterations));
+    results.push_back(benchmarkGenerator<byte, 1, sdfGenerator>("ImmediateAtlasGenerator::generate/sdf", packedGlyphs, width, height, attributes, threadCount, iterations));
+    results.push_back(benchmarkGenerator<byte, 1, psdfGenerator>("ImmediateAtlasGenerator::generate/psdf", packedGlyphs, width, height, attributes, threadCount, iterations));
+    results.push_back(benchmarkGenerator<byte, 3, msdfGenerator>("ImmediateAtlasGenerator::generate/msdf", packedGlyphs, width, height, attributes, threadCount, iterations));
+    results.push_back(benchmarkGenerator<byte, 4, mtsdfGenerator>("ImmediateAtlasGenerator::generate/mtsdf", packedGlyphs, width, height, attributes, threadCount, iterations));
+    {
+        GeneratorAttributes noOverlapAttributes = attributes;
+        noOverlapAttributes.config.overlapSupport = false;
+        GeneratorAttributes edgeIndexAttributes = noOverlapAttributes;
+        edgeIndexAttributes.edgeIndex = true;
+        results.push_back(benchmarkGenerator<byte, 3, msdfGenerator>("ImmediateAtlasGenerator::generate/msdf/nooverlap", packedGlyphs, width, height, noOverlapAttributes, threadCount, iterations));
+        results.push_back(benchmarkGenerator<byte, 3, msdfGenerator>("ImmediateAtlasGenerator::generate/msdf/nooverlap/edgeindex", packedGlyphs, width, height, edgeIndexAttributes, threadCount, iterations));
+    }
+
+    // Incremental build adding glyphs into an existing atlas
+    if (!benchmarkIncrementalAdd(results, packedGlyphs, width, height, attributes, threadCount, iterations))
+        fputs("Added glyphs do not fit into the incrementally built atlas, skipping its benchmark.\n", stderr);
+
+    // Dynamic atlas fed by a simulated text editing session
+    benchmarkBatcherTrace(results, packedGlyphs, iterations);
+
+    // Dense and sparse generation of large glyphs with the same (small) range, where most pixels are out of range
+    {
+        TightAtlasPacker largePacker;
+        largePacker.setScale(std::max(emSize, LARGE_GLYPH_SIZE));
+        largePacker.setPixelRange(DEFAULT_PIXEL_RANGE);
+        largePacker.setMiterLimit(DEFAULT_MITER_LIMIT);
+        std::vector<GlyphGeometry> largeGlyphs = glyphs;
+        largePacker.pack(largeGlyphs.data(), glyphCount);
+        int largeWidth = 0, largeHeight = 0;
+        largePacker.getDimensions(largeWidth, largeHeight);
+        if (!(largeWidth > 0 && largeHeight > 0))
+            ABORT("Failed to pack large glyphs into atlas.");
+        GeneratorAttributes sparseAttributes = attributes;
+        sparseAttributes.sparse = true;
+        results.push_back(benchmarkGenerator<byte, 1, sdfGenerator>("ImmediateAtlasGenerator::generate/sdf/large", largeGlyphs, largeWidth, largeHeight, attributes, threadCount, iterations));
+        results.push_back(benchmarkGenerator<byte, 1, sdfGenerator>("ImmediateAtlasGenerator::generate/sdf/large/sparse", largeGlyphs, largeWidth, largeHeight, sparseAttributes, threadCount, iterations));
+        results.push_back(benchmarkGenerator<byte, 3, msdfGenerator>("ImmediateAtlasGenerator::generate/msdf/large", largeGlyphs, largeWidth, largeHeight, attributes, threadCount, iterations));
+        results.push_back(benchmarkGenerator<byte, 3, msdfGenerator>("ImmediateAtlasGenerator::generate/msdf/large/sparse", largeGlyphs, largeWidth, largeHeight, sparseAttributes, threadCount, iterations));
+    }
+
+    // Text metrics output
+    if (!benchmarkTextFileWriter(results, iterations))
+        ABORT("Failed to write temporary file.");
+
+    // Blit and encoding of the MSDF atlas
+    ImmediateAtlasGenerator<float, 3, msdfGenerator, BitmapAtlasStorage<float, 3> > generator(width, height);
+    generator.setAttributes(attributes);
+    generator.setThreadCount(threadCount);
+    generator.generate(packedGlyphs.data(), glyphCount);
+    const msdfgen::BitmapConstSection<float, 3> floatAtlas = (msdfgen::BitmapConstSection<float, 3>) generator.atlasStorage();
+    msdfgen::Bitmap<byte, 3> byteAtlas(width, height), blitTarget(width, height);
+    unsigned long long atlasPixels = (unsigned long long) width*height;
+    results.push_back(benchmark("blit/float", atlasPixels, iterations, []() { }, [&]() {
+        blit(byteAtlas, floatAtlas);
+    }));
+    const msdfgen::Bitmap<byte, 3> &constByteAtlas = byteAtlas;
+    results.push_back(benchmark("blit/byte", atlasPixels, iterations, []() { }, [&]() {
+        blit(blitTarget, constByteAtlas);
+    }));
+#ifndef MSDFGEN_DISABLE_PNG
+    std::vector<byte> png;
+    results.push_back(benchmark("encodePng", atlasPixels, iterations, [&]() {
+        png.clear();
+    }, [&]() {
+        encodePng(png, constByteAtlas);
+    }));
+#endif
+
+    for (const BenchmarkResult &result : results)
+        printResult(result);
+    bool success;
+    if (jsonFilename) {
+        FILE *f = fopen(jsonFilename, "w");
+        if (!f)
+            ABORT("Failed to write JSON output file.");
+        success = writeResults(f, results, fontFilename, glyphCount, emSize, width, height, iterations, threadCount);
+        success = fclose(f) == 0 && success;
+    } else
+        success = writeResults(stdout, results, fontFilename, glyphCount, emSize, width, height, iterations, threadCount);
+    if (!success)
+        ABORT("Failed to write benchmark results.");
+    return 0;
+}
+
+#endif
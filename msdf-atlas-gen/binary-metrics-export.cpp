@@ -0,0 +1,218 @@
+
+#include "binary-metrics-export.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include "GlyphGeometry.h"
+#include "binary-metrics.h"
+
+namespace msdf_atlas {
+
+/// Appends values to a byte buffer in little-endian order regardless of the host
+class LittleEndianBuffer {
+
+public:
+    std::vector<byte> data;
+
+    size_t size() const {
+        return data.size();
+    }
+
+    void writeUint32(uint32_t value) {
+        byte bytes[4] = { byte(value), byte(value>>8), byte(value>>16), byte(value>>24) };
+        data.insert(data.end(), bytes, bytes+4);
+    }
+
+    void writeFloat(double value) {
+        float floatValue = float(value);
+        uint32_t bits;
+        memcpy(&bits, &floatValue, sizeof(bits));
+        writeUint32(bits);
+    }
+
+    void writeBytes(const void *bytes, size_t length) {
+        data.insert(data.end(), (const byte *) bytes, (const byte *) bytes+length);
+    }
+
+    /// Pads the buffer to a multiple of 4 bytes
+    void align() {
+        data.resize((data.size()+3)&~(size_t) 3);
+    }
+
+    /// Overwrites a previously written value
+    void setUint32(size_t offset, uint32_t value) {
+        data[offset] = byte(value);
+        data[offset+1] = byte(value>>8);
+        data[offset+2] = byte(value>>16);
+        data[offset+3] = byte(value>>24);
+    }
+
+};
+
+static void writeFontArrays(LittleEndianBuffer &buffer, size_t fontRecordOffset, const FontGeometry &font, const BinaryMetricsExportProperties &properties) {
+    FontGeometry::GlyphRange glyphs = font.getGlyphs();
+    GlyphIdentifierType identifierType = font.getPreferredIdentifierType();
+    uint32_t glyphCount = uint32_t(glyphs.size());
+    #define SET_FIELD(field, value) buffer.setUint32(fontRecordOffset+offsetof(BinaryMetricsFont, field), uint32_t(value))
+
+    // Name
+    const char *name = font.getName();
+    SET_FIELD(nameOffset, buffer.size());
+    if (name) {
+        SET_FIELD(nameLength, strlen(name));
+        buffer.writeBytes(name, strlen(name));
+        buffer.align();
+    }
+
+    // Glyph arrays
+    SET_FIELD(identifiersOffset, buffer.size());
+    for (const GlyphGeometry &glyph : glyphs)
+        buffer.writeUint32(uint32_t(glyph.getIdentifier(identifierType)));
+    SET_FIELD(flagsOffset, buffer.size());
+    for (const GlyphGeometry &glyph : glyphs)
+        buffer.writeUint32(glyph.isBoxRotated() ? BINARY_METRICS_GLYPH_ROTATED : 0);
+    SET_FIELD(advancesOffset, buffer.size());
+    for (const GlyphGeometry &glyph : glyphs)
+        buffer.writeFloat(glyph.getAdvance());
+    SET_FIELD(planeBoundsOffset, buffer.size());
+    for (const GlyphGeometry &glyph : glyphs) {
+        double l, b, r, t;
+        glyph.getQuadPlaneBounds(l, b, r, t);
+        if (properties.yDirection == msdfgen::Y_DOWNWARD) {
+            double top = -t;
+            t = -b, b = top;
+        }
+        buffer.writeFloat(l), buffer.writeFloat(b), buffer.writeFloat(r), buffer.writeFloat(t);
+    }
+    SET_FIELD(atlasBoundsOffset, buffer.size());
+    for (const GlyphGeometry &glyph : glyphs) {
+        double l, b, r, t;
+        glyph.getQuadAtlasBounds(l, b, r, t);
+        if (properties.yDirection == msdfgen::Y_DOWNWARD && (l || b || r || t)) {
+            double top = properties.height-t;
+            t = properties.height-b, b = top;
+        }
+        buffer.writeFloat(l), buffer.writeFloat(b), buffer.writeFloat(r), buffer.writeFloat(t);
+    }
+
+    // Kerning pairs, converted to identifiers and sorted
+    std::vector<BinaryMetricsKernPair> kernPairs;
+    if (properties.kerning) {
+        const std::map<std::pair<int, int>, double> &kerning = font.getKerning();
+        kernPairs.reserve(kerning.size());
+        switch (identifierType) {
+            case GlyphIdentifierType::GLYPH_INDEX:
+                for (const std::pair<const std::pair<int, int>, double> &elem : kerning) {
+                    BinaryMetricsKernPair kernPair = { uint32_t(elem.first.first), uint32_t(elem.first.second), float(elem.second) };
+                    kernPairs.push_back(kernPair);
+                }
+                break;
+            case GlyphIdentifierType::UNICODE_CODEPOINT: {
+                std::vector<unicode_t> codepoints = font.getCodepointTable();
+                for (const std::pair<const std::pair<int, int>, double> &elem : kerning) {
+                    unicode_t codepoint1 = elem.first.first < (int) codepoints.size() ? codepoints[elem.first.first] : 0;
+                    unicode_t codepoint2 = elem.first.second < (int) codepoints.size() ? codepoints[elem.first.second] : 0;
+                    if (codepoint1 && codepoint2) {
+                        BinaryMetricsKernPair kernPair = { codepoint1, codepoint2, float(elem.second) };
+                        kernPairs.push_back(kernPair);
+                    }
+                }
+                break;
+            }
+        }
+        std::stable_sort(kernPairs.begin(), kernPairs.end(), [](const BinaryMetricsKernPair &a, const BinaryMetricsKernPair &b) -> bool {
+            return a.identifier1 < b.identifier1 || (a.identifier1 == b.identifier1 && a.identifier2 < b.identifier2);
+        });
+        kernPairs.erase(std::unique(kernPairs.begin(), kernPairs.end(), [](const BinaryMetricsKernPair &a, const BinaryMetricsKernPair &b) -> bool {
+            return a.identifier1 == b.identifier1 && a.identifier2 == b.identifier2;
+        }), kernPairs.end());
+    }
+    SET_FIELD(kernPairCount, kernPairs.size());
+    SET_FIELD(kernPairsOffset, buffer.size());
+    for (const BinaryMetricsKernPair &kernPair : kernPairs) {
+        buffer.writeUint32(kernPair.identifier1);
+        buffer.writeUint32(kernPair.identifier2);
+        buffer.writeFloat(kernPair.advance);
+    }
+
+    // Identifier hash index with load factor of at most 1/2
+    uint32_t hashCapacity = 0;
+    if (glyphCount) {
+        hashCapacity = 1;
+        while (hashCapacity < 2*glyphCount)
+            hashCapacity <<= 1;
+    }
+    std::vector<uint32_t> hashIndex(hashCapacity);
+    uint32_t glyphPosition = 0;
+    for (const GlyphGeometry &glyph : glyphs) {
+        uint32_t identifier = uint32_t(glyph.getIdentifier(identifierType));
+        for (uint32_t slot = identifier*2654435761u&(hashCapacity-1);; slot = (slot+1)&(hashCapacity-1)) {
+            if (!hashIndex[slot]) {
+                hashIndex[slot] = glyphPosition+1;
+                break;
+            }
+            // If multiple glyphs have the same identifier, the first one is kept
+            if (uint32_t(glyphs.begin()[hashIndex[slot]-1].getIdentifier(identifierType)) == identifier)
+                break;
+        }
+        ++glyphPosition;
+    }
+    SET_FIELD(hashCapacity, hashCapacity);
+    SET_FIELD(hashIndexOffset, buffer.size());
+    for (uint32_t entry : hashIndex)
+        buffer.writeUint32(entry);
+
+    #undef SET_FIELD
+}
+
+bool exportBinaryMetrics(const FontGeometry *fonts, int fontCount, const char *filename, const BinaryMetricsExportProperties &properties) {
+    LittleEndianBuffer buffer;
+
+    // Header
+    buffer.writeBytes(MSDF_ATLAS_BINARY_METRICS_TAG, sizeof(BinaryMetricsHeader::tag));
+    buffer.writeUint32(MSDF_ATLAS_BINARY_METRICS_VERSION);
+    buffer.writeUint32(0); // fileSize
+    buffer.writeUint32(uint32_t(properties.imageType));
+    buffer.writeUint32(properties.yDirection == msdfgen::Y_DOWNWARD ? 1 : 0);
+    buffer.writeFloat(properties.distanceRange.upper-properties.distanceRange.lower);
+    buffer.writeFloat(.5*(properties.distanceRange.lower+properties.distanceRange.upper));
+    buffer.writeFloat(properties.size);
+    buffer.writeUint32(uint32_t(properties.width));
+    buffer.writeUint32(uint32_t(properties.height));
+    buffer.writeUint32(uint32_t(fontCount));
+    buffer.writeUint32(uint32_t(sizeof(BinaryMetricsHeader)));
+
+    // Font records, array offsets are filled in afterwards
+    for (int i = 0; i < fontCount; ++i) {
+        const FontGeometry &font = fonts[i];
+        double yFactor = properties.yDirection == msdfgen::Y_DOWNWARD ? -1 : 1;
+        const msdfgen::FontMetrics &fontMetrics = font.getMetrics();
+        buffer.writeUint32(font.getPreferredIdentifierType() == GlyphIdentifierType::UNICODE_CODEPOINT ? 1 : 0);
+        buffer.writeUint32(uint32_t(font.getGlyphs().size()));
+        buffer.writeUint32(0); // kernPairCount
+        buffer.writeUint32(0); // hashCapacity
+        buffer.writeFloat(fontMetrics.emSize);
+        buffer.writeFloat(fontMetrics.lineHeight);
+        buffer.writeFloat(yFactor*fontMetrics.ascenderY);
+        buffer.writeFloat(yFactor*fontMetrics.descenderY);
+        buffer.writeFloat(yFactor*fontMetrics.underlineY);
+        buffer.writeFloat(fontMetrics.underlineThickness);
+        for (size_t j = offsetof(BinaryMetricsFont, nameOffset); j < sizeof(BinaryMetricsFont); j += sizeof(uint32_t))
+            buffer.writeUint32(0);
+    }
+    for (int i = 0; i < fontCount; ++i)
+        writeFontArrays(buffer, sizeof(BinaryMetricsHeader)+i*sizeof(BinaryMetricsFont), fonts[i], properties);
+    buffer.setUint32(offsetof(BinaryMetricsHeader, fileSize), uint32_t(buffer.size()));
+
+    FILE *f = fopen(filename, "wb");
+    if (!f)
+        return false;
+    bool success = fwrite(buffer.data.data(), 1, buffer.size(), f) == buffer.size();
+    return fclose(f) == 0 && success;
+}
+
+}
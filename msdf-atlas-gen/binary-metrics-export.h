@@ -0,0 +1,23 @@
+
+#pragma once
+
+#include <msdfgen.h>
+#include <msdfgen-ext.h>
+#include "types.h"
+#include "FontGeometry.h"
+
+namespace msdf_atlas {
+
+struct BinaryMetricsExportProperties {
+    ImageType imageType;
+    msdfgen::Range distanceRange;
+    double size;
+    int width, height;
+    msdfgen::YAxisOrientation yDirection;
+    bool kerning;
+};
+
+/// Writes the font and glyph metrics and atlas layout into a binary file that can be used in place (see binary-metrics.h)
+bool exportBinaryMetrics(const FontGeometry *fonts, int fontCount, const char *filename, const BinaryMetricsExportProperties &properties);
+
+}
@@ -0,0 +1,110 @@
+
+#include "binary-metrics.h"
+
+#include <cstring>
+
+namespace msdf_atlas {
+
+static bool isLittleEndianHost() {
+    const uint32_t value = 1;
+    return *reinterpret_cast<const unsigned char *>(&value) == 1;
+}
+
+static bool validRange(uint64_t offset, uint64_t size, uint64_t fileSize) {
+    return !(offset&3) && offset <= fileSize && size <= fileSize-offset;
+}
+
+int BinaryMetricsReader::Font::findGlyph(uint32_t identifier) const {
+    uint32_t capacity = properties->hashCapacity;
+    if (!capacity)
+        return -1;
+    for (uint32_t slot = identifier*2654435761u&(capacity-1), i = 0; i < capacity; slot = (slot+1)&(capacity-1), ++i) {
+        uint32_t entry = hashIndex[slot];
+        if (!entry)
+            break;
+        if (identifiers[entry-1] == identifier)
+            return int(entry-1);
+    }
+    return -1;
+}
+
+float BinaryMetricsReader::Font::getKerning(uint32_t identifier1, uint32_t identifier2) const {
+    uint32_t low = 0, high = properties->kernPairCount;
+    while (low < high) {
+        uint32_t mid = low+(high-low)/2;
+        const BinaryMetricsKernPair &kernPair = kernPairs[mid];
+        if (kernPair.identifier1 < identifier1 || (kernPair.identifier1 == identifier1 && kernPair.identifier2 < identifier2))
+            low = mid+1;
+        else
+            high = mid;
+    }
+    if (low < properties->kernPairCount && kernPairs[low].identifier1 == identifier1 && kernPairs[low].identifier2 == identifier2)
+        return kernPairs[low].advance;
+    return 0;
+}
+
+BinaryMetricsReader::BinaryMetricsReader() : data(nullptr) { }
+
+bool BinaryMetricsReader::open(const void *data, size_t size) {
+    this->data = nullptr;
+    // The format is read in place, which requires a little-endian host and 4-byte aligned data
+    if (!isLittleEndianHost() || (reinterpret_cast<uintptr_t>(data)&3) || size < sizeof(BinaryMetricsHeader))
+        return false;
+    const BinaryMetricsHeader *header = reinterpret_cast<const BinaryMetricsHeader *>(data);
+    if (memcmp(header->tag, MSDF_ATLAS_BINARY_METRICS_TAG, sizeof(header->tag)) || header->version != MSDF_ATLAS_BINARY_METRICS_VERSION || header->fileSize > size)
+        return false;
+    uint64_t fileSize = header->fileSize;
+    if (!validRange(header->fontTableOffset, (uint64_t) header->fontCount*sizeof(BinaryMetricsFont), fileSize))
+        return false;
+    const BinaryMetricsFont *fonts = reinterpret_cast<const BinaryMetricsFont *>(reinterpret_cast<const unsigned char *>(data)+header->fontTableOffset);
+    for (uint32_t i = 0; i < header->fontCount; ++i) {
+        const BinaryMetricsFont &font = fonts[i];
+        uint64_t glyphCount = font.glyphCount;
+        if (font.hashCapacity&(font.hashCapacity-1) || font.hashCapacity < font.glyphCount)
+            return false;
+        if (!(
+            !(font.nameOffset&3) && font.nameOffset <= fileSize && font.nameLength <= fileSize-font.nameOffset &&
+            validRange(font.identifiersOffset, sizeof(uint32_t)*glyphCount, fileSize) &&
+            validRange(font.flagsOffset, sizeof(uint32_t)*glyphCount, fileSize) &&
+            validRange(font.advancesOffset, sizeof(float)*glyphCount, fileSize) &&
+            validRange(font.planeBoundsOffset, 4*sizeof(float)*glyphCount, fileSize) &&
+            validRange(font.atlasBoundsOffset, 4*sizeof(float)*glyphCount, fileSize) &&
+            validRange(font.kernPairsOffset, (uint64_t) sizeof(BinaryMetricsKernPair)*font.kernPairCount, fileSize) &&
+            validRange(font.hashIndexOffset, (uint64_t) sizeof(uint32_t)*font.hashCapacity, fileSize)
+        ))
+            return false;
+        const uint32_t *hashIndex = reinterpret_cast<const uint32_t *>(reinterpret_cast<const unsigned char *>(data)+font.hashIndexOffset);
+        for (uint32_t j = 0; j < font.hashCapacity; ++j) {
+            if (hashIndex[j] > font.glyphCount)
+                return false;
+        }
+    }
+    this->data = reinterpret_cast<const unsigned char *>(data);
+    return true;
+}
+
+const BinaryMetricsHeader *BinaryMetricsReader::getHeader() const {
+    return reinterpret_cast<const BinaryMetricsHeader *>(data);
+}
+
+int BinaryMetricsReader::getFontCount() const {
+    return data ? int(getHeader()->fontCount) : 0;
+}
+
+bool BinaryMetricsReader::getFont(Font &font, int index) const {
+    if (!(index >= 0 && index < getFontCount()))
+        return false;
+    const BinaryMetricsFont *properties = reinterpret_cast<const BinaryMetricsFont *>(data+getHeader()->fontTableOffset)+index;
+    font.properties = properties;
+    font.name = reinterpret_cast<const char *>(data+properties->nameOffset);
+    font.identifiers = reinterpret_cast<const uint32_t *>(data+properties->identifiersOffset);
+    font.flags = reinterpret_cast<const uint32_t *>(data+properties->flagsOffset);
+    font.advances = reinterpret_cast<const float *>(data+properties->advancesOffset);
+    font.planeBounds = reinterpret_cast<const float *>(data+properties->planeBoundsOffset);
+    font.atlasBounds = reinterpret_cast<const float *>(data+properties->atlasBoundsOffset);
+    font.kernPairs = reinterpret_cast<const BinaryMetricsKernPair *>(data+properties->kernPairsOffset);
+    font.hashIndex = reinterpret_cast<const uint32_t *>(data+properties->hashIndexOffset);
+    return true;
+}
+
+}
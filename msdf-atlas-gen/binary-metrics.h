@@ -0,0 +1,111 @@
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * BINARY METRICS FORMAT
+ * ---------------------
+ * A compact alternative to the JSON output, which can be used directly from memory (e.g. a memory-mapped file) without parsing.
+ * All values are little-endian 4-byte integers or IEEE 754 single precision floats, aligned to 4 bytes.
+ * Offsets are in bytes from the start of the file. The file starts with BinaryMetricsHeader,
+ * followed by fontCount BinaryMetricsFont records at fontTableOffset. The arrays of each font are:
+ *     name - nameLength bytes of UTF-8 (not null-terminated)
+ *     identifiers - glyphCount glyph indices or Unicode codepoints (see identifierType)
+ *     flags - glyphCount glyph flags (BINARY_METRICS_GLYPH_ROTATED)
+ *     advances - glyphCount horizontal advances in em's
+ *     planeBounds - glyphCount x 4 plane bounds in em's
+ *     atlasBounds - glyphCount x 4 atlas bounds in pixels
+ *     kernPairs - kernPairCount BinaryMetricsKernPair records sorted by identifier1, then identifier2
+ *     hashIndex - hashCapacity (a power of two) slots of an open addressing hash table mapping identifiers to glyphs.
+ *         The search for identifier starts at slot (identifier*2654435761 mod 2^32)&(hashCapacity-1) and continues linearly (wrapping around).
+ *         Each slot holds the glyph's position in the arrays plus one, or zero if empty, which ends the search.
+ * Bounds are stored as left, bottom, right, top if yOrigin is bottom (0), and as left, top, right, bottom if yOrigin is top (1),
+ * with the same values as in the JSON output. Atlas bounds of glyphs without a box (whitespace) are zero.
+ */
+
+#define MSDF_ATLAS_BINARY_METRICS_TAG "MSDFABM\0"
+#define MSDF_ATLAS_BINARY_METRICS_VERSION 1
+
+namespace msdf_atlas {
+
+enum {
+    /// The glyph's box is rotated in the atlas (see -rotate)
+    BINARY_METRICS_GLYPH_ROTATED = 0x01
+};
+
+struct BinaryMetricsHeader {
+    char tag[8];
+    uint32_t version;
+    uint32_t fileSize;
+    /// Same values as ImageType
+    uint32_t imageType;
+    /// 0 = bottom, 1 = top
+    uint32_t yOrigin;
+    float distanceRange, distanceRangeMiddle;
+    float size;
+    uint32_t width, height;
+    uint32_t fontCount;
+    uint32_t fontTableOffset;
+};
+
+struct BinaryMetricsFont {
+    /// 0 = glyph index, 1 = Unicode codepoint
+    uint32_t identifierType;
+    uint32_t glyphCount;
+    uint32_t kernPairCount;
+    uint32_t hashCapacity;
+    float emSize, lineHeight, ascender, descender, underlineY, underlineThickness;
+    uint32_t nameOffset, nameLength;
+    uint32_t identifiersOffset;
+    uint32_t flagsOffset;
+    uint32_t advancesOffset;
+    uint32_t planeBoundsOffset;
+    uint32_t atlasBoundsOffset;
+    uint32_t kernPairsOffset;
+    uint32_t hashIndexOffset;
+};
+
+struct BinaryMetricsKernPair {
+    uint32_t identifier1, identifier2;
+    float advance;
+};
+
+/// Reference reader of the binary metrics format, which references the data in place without copying
+class BinaryMetricsReader {
+
+public:
+    /// Arrays of a single font in the data
+    struct Font {
+        const BinaryMetricsFont *properties;
+        const char *name;
+        const uint32_t *identifiers;
+        const uint32_t *flags;
+        const float *advances;
+        const float *planeBounds;
+        const float *atlasBounds;
+        const BinaryMetricsKernPair *kernPairs;
+        const uint32_t *hashIndex;
+
+        /// Returns the position of the glyph with identifier in the arrays or -1 if not present
+        int findGlyph(uint32_t identifier) const;
+        /// Returns the kerning advance adjustment between two glyph identifiers (zero if none)
+        float getKerning(uint32_t identifier1, uint32_t identifier2) const;
+    };
+
+    BinaryMetricsReader();
+    /// Validates the data and references it (the data must outlive the reader), returns false if invalid
+    bool open(const void *data, size_t size);
+    /// Returns the file header or null if not open
+    const BinaryMetricsHeader *getHeader() const;
+    int getFontCount() const;
+    /// Retrieves the arrays of the font at index, returns false if out of range
+    bool getFont(Font &font, int index) const;
+
+private:
+    const unsigned char *data;
+
+};
+
+}
@@ -31,6 +31,28 @@ static void blitSameType(const msdfgen::BitmapSection<T, N> &dst, const msdfgen:
         memcpy(dst(dx, dy+y), src(sx, sy+y), rowSize);
 }
 
+static void convertFromFloat(half *dst, const float *src, size_t count) {
+    convertFloatToHalf(dst, src, count);
+}
+
+static void convertFromFloat(uint16_t *dst, const float *src, size_t count) {
+    convertFloatToUint16(dst, src, count);
+}
+
+template <typename T, int N>
+static void blitFromFloat(const msdfgen::BitmapSection<T, N> &dst, const msdfgen::BitmapConstSection<float, N> &src) {
+    int width = std::min(dst.width, src.width), height = std::min(dst.height, src.height);
+    for (int y = 0; y < height; ++y)
+        convertFromFloat(dst(0, y), src(0, y), (size_t) N*width);
+}
+
+template <typename T, int N>
+static void blitFromFloat(const msdfgen::BitmapSection<T, N> &dst, const msdfgen::BitmapConstSection<float, N> &src, int dx, int dy, int sx, int sy, int w, int h) {
+    BOUND_SECTION();
+    for (int y = 0; y < h; ++y)
+        convertFromFloat(dst(dx, dy+y), src(sx, sy+y), (size_t) N*w);
+}
+
 #define BLIT_SAME_TYPE_IMPL(T, N) void blit(const msdfgen::BitmapSection<T, N> &dst, const msdfgen::BitmapConstSection<T, N> &src) { blitSameType(dst, src); }
 #define BLIT_SAME_TYPE_PART_IMPL(T, N) void blit(const msdfgen::BitmapSection<T, N> &dst, const msdfgen::BitmapConstSection<T, N> &src, int dx, int dy, int sx, int sy, int w, int h) { blitSameType(dst, src, dx, dy, sx, sy, w, h); }
 
@@ -40,6 +62,12 @@ BLIT_SAME_TYPE_IMPL(byte, 4)
 BLIT_SAME_TYPE_IMPL(float, 1)
 BLIT_SAME_TYPE_IMPL(float, 3)
 BLIT_SAME_TYPE_IMPL(float, 4)
+BLIT_SAME_TYPE_IMPL(half, 1)
+BLIT_SAME_TYPE_IMPL(half, 3)
+BLIT_SAME_TYPE_IMPL(half, 4)
+BLIT_SAME_TYPE_IMPL(uint16_t, 1)
+BLIT_SAME_TYPE_IMPL(uint16_t, 3)
+BLIT_SAME_TYPE_IMPL(uint16_t, 4)
 
 void blit(const msdfgen::BitmapSection<byte, 1> &dst, const msdfgen::BitmapConstSection<float, 1> &src) {
     int width = std::min(dst.width, src.width), height = std::min(dst.height, src.height);
@@ -78,12 +106,28 @@ void blit(const msdfgen::BitmapSection<byte, 4> &dst, const msdfgen::BitmapConst
     }
 }
 
+#define BLIT_FROM_FLOAT_IMPL(T, N) void blit(const msdfgen::BitmapSection<T, N> &dst, const msdfgen::BitmapConstSection<float, N> &src) { blitFromFloat(dst, src); }
+#define BLIT_FROM_FLOAT_PART_IMPL(T, N) void blit(const msdfgen::BitmapSection<T, N> &dst, const msdfgen::BitmapConstSection<float, N> &src, int dx, int dy, int sx, int sy, int w, int h) { blitFromFloat(dst, src, dx, dy, sx, sy, w, h); }
+
+BLIT_FROM_FLOAT_IMPL(half, 1)
+BLIT_FROM_FLOAT_IMPL(half, 3)
+BLIT_FROM_FLOAT_IMPL(half, 4)
+BLIT_FROM_FLOAT_IMPL(uint16_t, 1)
+BLIT_FROM_FLOAT_IMPL(uint16_t, 3)
+BLIT_FROM_FLOAT_IMPL(uint16_t, 4)
+
 BLIT_SAME_TYPE_PART_IMPL(byte, 1)
 BLIT_SAME_TYPE_PART_IMPL(byte, 3)
 BLIT_SAME_TYPE_PART_IMPL(byte, 4)
 BLIT_SAME_TYPE_PART_IMPL(float, 1)
 BLIT_SAME_TYPE_PART_IMPL(float, 3)
 BLIT_SAME_TYPE_PART_IMPL(float, 4)
+BLIT_SAME_TYPE_PART_IMPL(half, 1)
+BLIT_SAME_TYPE_PART_IMPL(half, 3)
+BLIT_SAME_TYPE_PART_IMPL(half, 4)
+BLIT_SAME_TYPE_PART_IMPL(uint16_t, 1)
+BLIT_SAME_TYPE_PART_IMPL(uint16_t, 3)
+BLIT_SAME_TYPE_PART_IMPL(uint16_t, 4)
 
 void blit(const msdfgen::BitmapSection<byte, 1> &dst, const msdfgen::BitmapConstSection<float, 1> &src, int dx, int dy, int sx, int sy, int w, int h) {
     BOUND_SECTION();
@@ -122,4 +166,38 @@ void blit(const msdfgen::BitmapSection<byte, 4> &dst, const msdfgen::BitmapConst
     }
 }
 
+BLIT_FROM_FLOAT_PART_IMPL(half, 1)
+BLIT_FROM_FLOAT_PART_IMPL(half, 3)
+BLIT_FROM_FLOAT_PART_IMPL(half, 4)
+BLIT_FROM_FLOAT_PART_IMPL(uint16_t, 1)
+BLIT_FROM_FLOAT_PART_IMPL(uint16_t, 3)
+BLIT_FROM_FLOAT_PART_IMPL(uint16_t, 4)
+
+template <typename T, int N>
+static void blitRotatedSameType(const msdfgen::BitmapSection<T, N> &dst, const msdfgen::BitmapConstSection<T, N> &src) {
+    for (int y = 0; y < src.height; ++y) {
+        const T *srcPixel = src(0, y);
+        for (int x = 0; x < src.width; ++x) {
+            T *dstPixel = dst(src.height-1-y, x);
+            for (int i = 0; i < N; ++i)
+                *dstPixel++ = *srcPixel++;
+        }
+    }
+}
+
+#define BLIT_ROTATED_IMPL(T, N) void blitRotated(const msdfgen::BitmapSection<T, N> &dst, const msdfgen::BitmapConstSection<T, N> &src) { blitRotatedSameType(dst, src); }
+
+BLIT_ROTATED_IMPL(byte, 1)
+BLIT_ROTATED_IMPL(byte, 3)
+BLIT_ROTATED_IMPL(byte, 4)
+BLIT_ROTATED_IMPL(float, 1)
+BLIT_ROTATED_IMPL(float, 3)
+BLIT_ROTATED_IMPL(float, 4)
+BLIT_ROTATED_IMPL(half, 1)
+BLIT_ROTATED_IMPL(half, 3)
+BLIT_ROTATED_IMPL(half, 4)
+BLIT_ROTATED_IMPL(uint16_t, 1)
+BLIT_ROTATED_IMPL(uint16_t, 3)
+BLIT_ROTATED_IMPL(uint16_t, 4)
+
 }
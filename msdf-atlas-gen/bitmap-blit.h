@@ -3,6 +3,8 @@
 
 #include <msdfgen.h>
 #include "types.h"
+#include "half-float.h"
+#include "uint16-pixels.h"
 
 namespace msdf_atlas {
 
@@ -24,6 +26,22 @@ void blit(const msdfgen::BitmapSection<byte, 1> &dst, const msdfgen::BitmapConst
 void blit(const msdfgen::BitmapSection<byte, 3> &dst, const msdfgen::BitmapConstSection<float, 3> &src);
 void blit(const msdfgen::BitmapSection<byte, 4> &dst, const msdfgen::BitmapConstSection<float, 4> &src);
 
+void blit(const msdfgen::BitmapSection<half, 1> &dst, const msdfgen::BitmapConstSection<half, 1> &src);
+void blit(const msdfgen::BitmapSection<half, 3> &dst, const msdfgen::BitmapConstSection<half, 3> &src);
+void blit(const msdfgen::BitmapSection<half, 4> &dst, const msdfgen::BitmapConstSection<half, 4> &src);
+
+void blit(const msdfgen::BitmapSection<half, 1> &dst, const msdfgen::BitmapConstSection<float, 1> &src);
+void blit(const msdfgen::BitmapSection<half, 3> &dst, const msdfgen::BitmapConstSection<float, 3> &src);
+void blit(const msdfgen::BitmapSection<half, 4> &dst, const msdfgen::BitmapConstSection<float, 4> &src);
+
+void blit(const msdfgen::BitmapSection<uint16_t, 1> &dst, const msdfgen::BitmapConstSection<uint16_t, 1> &src);
+void blit(const msdfgen::BitmapSection<uint16_t, 3> &dst, const msdfgen::BitmapConstSection<uint16_t, 3> &src);
+void blit(const msdfgen::BitmapSection<uint16_t, 4> &dst, const msdfgen::BitmapConstSection<uint16_t, 4> &src);
+
+void blit(const msdfgen::BitmapSection<uint16_t, 1> &dst, const msdfgen::BitmapConstSection<float, 1> &src);
+void blit(const msdfgen::BitmapSection<uint16_t, 3> &dst, const msdfgen::BitmapConstSection<float, 3> &src);
+void blit(const msdfgen::BitmapSection<uint16_t, 4> &dst, const msdfgen::BitmapConstSection<float, 4> &src);
+
 void blit(const msdfgen::BitmapSection<byte, 1> &dst, const msdfgen::BitmapConstSection<byte, 1> &src, int dx, int dy, int sx, int sy, int w, int h);
 void blit(const msdfgen::BitmapSection<byte, 3> &dst, const msdfgen::BitmapConstSection<byte, 3> &src, int dx, int dy, int sx, int sy, int w, int h);
 void blit(const msdfgen::BitmapSection<byte, 4> &dst, const msdfgen::BitmapConstSection<byte, 4> &src, int dx, int dy, int sx, int sy, int w, int h);
@@ -36,4 +54,42 @@ void blit(const msdfgen::BitmapSection<byte, 1> &dst, const msdfgen::BitmapConst
 void blit(const msdfgen::BitmapSection<byte, 3> &dst, const msdfgen::BitmapConstSection<float, 3> &src, int dx, int dy, int sx, int sy, int w, int h);
 void blit(const msdfgen::BitmapSection<byte, 4> &dst, const msdfgen::BitmapConstSection<float, 4> &src, int dx, int dy, int sx, int sy, int w, int h);
 
+void blit(const msdfgen::BitmapSection<half, 1> &dst, const msdfgen::BitmapConstSection<half, 1> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blit(const msdfgen::BitmapSection<half, 3> &dst, const msdfgen::BitmapConstSection<half, 3> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blit(const msdfgen::BitmapSection<half, 4> &dst, const msdfgen::BitmapConstSection<half, 4> &src, int dx, int dy, int sx, int sy, int w, int h);
+
+void blit(const msdfgen::BitmapSection<half, 1> &dst, const msdfgen::BitmapConstSection<float, 1> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blit(const msdfgen::BitmapSection<half, 3> &dst, const msdfgen::BitmapConstSection<float, 3> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blit(const msdfgen::BitmapSection<half, 4> &dst, const msdfgen::BitmapConstSection<float, 4> &src, int dx, int dy, int sx, int sy, int w, int h);
+
+void blit(const msdfgen::BitmapSection<uint16_t, 1> &dst, const msdfgen::BitmapConstSection<uint16_t, 1> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blit(const msdfgen::BitmapSection<uint16_t, 3> &dst, const msdfgen::BitmapConstSection<uint16_t, 3> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blit(const msdfgen::BitmapSection<uint16_t, 4> &dst, const msdfgen::BitmapConstSection<uint16_t, 4> &src, int dx, int dy, int sx, int sy, int w, int h);
+
+void blit(const msdfgen::BitmapSection<uint16_t, 1> &dst, const msdfgen::BitmapConstSection<float, 1> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blit(const msdfgen::BitmapSection<uint16_t, 3> &dst, const msdfgen::BitmapConstSection<float, 3> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blit(const msdfgen::BitmapSection<uint16_t, 4> &dst, const msdfgen::BitmapConstSection<float, 4> &src, int dx, int dy, int sx, int sy, int w, int h);
+
+/*
+ * Copies the source bitmap to the destination bitmap rotated by 90 degrees counter-clockwise,
+ * i.e. source pixel (x, y) is written to (src.height-1-y, x).
+ * The destination's dimensions must be at least src.height x src.width.
+ */
+
+void blitRotated(const msdfgen::BitmapSection<byte, 1> &dst, const msdfgen::BitmapConstSection<byte, 1> &src);
+void blitRotated(const msdfgen::BitmapSection<byte, 3> &dst, const msdfgen::BitmapConstSection<byte, 3> &src);
+void blitRotated(const msdfgen::BitmapSection<byte, 4> &dst, const msdfgen::BitmapConstSection<byte, 4> &src);
+
+void blitRotated(const msdfgen::BitmapSection<float, 1> &dst, const msdfgen::BitmapConstSection<float, 1> &src);
+void blitRotated(const msdfgen::BitmapSection<float, 3> &dst, const msdfgen::BitmapConstSection<float, 3> &src);
+void blitRotated(const msdfgen::BitmapSection<float, 4> &dst, const msdfgen::BitmapConstSection<float, 4> &src);
+
+void blitRotated(const msdfgen::BitmapSection<half, 1> &dst, const msdfgen::BitmapConstSection<half, 1> &src);
+void blitRotated(const msdfgen::BitmapSection<half, 3> &dst, const msdfgen::BitmapConstSection<half, 3> &src);
+void blitRotated(const msdfgen::BitmapSection<half, 4> &dst, const msdfgen::BitmapConstSection<half, 4> &src);
+
+void blitRotated(const msdfgen::BitmapSection<uint16_t, 1> &dst, const msdfgen::BitmapConstSection<uint16_t, 1> &src);
+void blitRotated(const msdfgen::BitmapSection<uint16_t, 3> &dst, const msdfgen::BitmapConstSection<uint16_t, 3> &src);
+void blitRotated(const msdfgen::BitmapSection<uint16_t, 4> &dst, const msdfgen::BitmapConstSection<uint16_t, 4> &src);
+
 }
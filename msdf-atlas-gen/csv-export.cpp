@@ -3,43 +3,87 @@
 
 #include <cstdio>
 #include "GlyphGeometry.h"
+#include "TextFileWriter.h"
 
 namespace msdf_atlas {
 
-bool exportCSV(const FontGeometry *fonts, int fontCount, int atlasWidth, int atlasHeight, msdfgen::YAxisOrientation yDirection, const char *filename) {
+bool exportCSV(const FontGeometry *fonts, int fontCount, int atlasWidth, int atlasHeight, msdfgen::YAxisOrientation yDirection, const char *filename, bool compactPrecision) {
     FILE *f = fopen(filename, "w");
     if (!f)
         return false;
+    TextFileWriter writer(f);
+    writer.setCompactPrecision(compactPrecision);
+    #define WRITE_BOUNDS(l, b, r, t) ( \
+        writer.writeReal(l), writer.writeChar(','), writer.writeReal(b), writer.writeChar(','), \
+        writer.writeReal(r), writer.writeChar(','), writer.writeReal(t) \
+    )
+
+    // The rotation column is only present if any glyph is rotated
+    bool anyRotated = false;
+    for (int i = 0; i < fontCount && !anyRotated; ++i) {
+        for (const GlyphGeometry &glyph : fonts[i].getGlyphs())
+            anyRotated |= glyph.isBoxRotated();
+    }
 
     for (int i = 0; i < fontCount; ++i) {
         for (const GlyphGeometry &glyph : fonts[i].getGlyphs()) {
             double l, b, r, t;
             if (fontCount > 1)
-                fprintf(f, "%d,", i);
-            fprintf(f, "%d,%.17g,", glyph.getIdentifier(fonts[i].getPreferredIdentifierType()), glyph.getAdvance());
+                writer.writeInteger(i), writer.writeChar(',');
+            writer.writeInteger(glyph.getIdentifier(fonts[i].getPreferredIdentifierType())), writer.writeChar(',');
+            writer.writeReal(glyph.getAdvance()), writer.writeChar(',');
             glyph.getQuadPlaneBounds(l, b, r, t);
             switch (yDirection) {
                 case msdfgen::Y_UPWARD:
-                    fprintf(f, "%.17g,%.17g,%.17g,%.17g,", l, b, r, t);
+                    WRITE_BOUNDS(l, b, r, t);
                     break;
                 case msdfgen::Y_DOWNWARD:
-                    fprintf(f, "%.17g,%.17g,%.17g,%.17g,", l, -t, r, -b);
+                    WRITE_BOUNDS(l, -t, r, -b);
                     break;
             }
+            writer.writeChar(',');
             glyph.getQuadAtlasBounds(l, b, r, t);
             switch (yDirection) {
                 case msdfgen::Y_UPWARD:
-                    fprintf(f, "%.17g,%.17g,%.17g,%.17g\n", l, b, r, t);
+                    WRITE_BOUNDS(l, b, r, t);
                     break;
                 case msdfgen::Y_DOWNWARD:
-                    fprintf(f, "%.17g,%.17g,%.17g,%.17g\n", l, atlasHeight-t, r, atlasHeight-b);
+                    WRITE_BOUNDS(l, atlasHeight-t, r, atlasHeight-b);
                     break;
             }
+            if (anyRotated)
+                writer.writeChar(','), writer.writeInteger(int(glyph.isBoxRotated()));
+            writer.writeChar('\n');
         }
     }
 
-    fclose(f);
-    return true;
+    #undef WRITE_BOUNDS
+    bool success = writer.flush();
+    return fclose(f) == 0 && success;
+}
+
+bool exportGlyphProfileCSV(const GlyphProfile *profile, int count, const char *filename) {
+    FILE *f = fopen(filename, "w");
+    if (!f)
+        return false;
+    TextFileWriter writer(f);
+    writer.writeString("index,codepoint,edges,pixels,time,errorCorrectionTime,complexity\n");
+    for (int i = 0; i < count; ++i) {
+        writer.writeInteger(profile[i].index), writer.writeChar(',');
+        writer.writeInteger(profile[i].codepoint), writer.writeChar(',');
+        writer.writeInteger(profile[i].edgeCount), writer.writeChar(',');
+        writer.writeInteger(profile[i].pixelCount), writer.writeChar(',');
+        writer.writeReal(profile[i].time), writer.writeChar(',');
+        writer.writeReal(profile[i].errorCorrectionTime), writer.writeChar(',');
+        switch (profile[i].complexity) {
+            case GlyphComplexity::SIMPLE: writer.writeString("simple"); break;
+            case GlyphComplexity::MODERATE: writer.writeString("moderate"); break;
+            case GlyphComplexity::COMPLEX: writer.writeString("complex"); break;
+        }
+        writer.writeChar('\n');
+    }
+    bool success = writer.flush();
+    return fclose(f) == 0 && success;
 }
 
 }
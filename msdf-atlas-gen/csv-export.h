@@ -2,13 +2,23 @@
 #pragma once
 
 #include "FontGeometry.h"
+#include "AtlasGenerator.h"
 
 namespace msdf_atlas {
 
 /**
  * Writes the positioning data and atlas layout of the glyphs into a CSV file
- * The columns are: font variant index (if fontCount > 1), glyph identifier (index or Unicode), horizontal advance, plane bounds (l, b, r, t), atlas bounds (l, b, r, t)
+ * The columns are: font variant index (if fontCount > 1), glyph identifier (index or Unicode), horizontal advance, plane bounds (l, b, r, t), atlas bounds (l, b, r, t),
+ * rotated (0 or 1, only if any glyph is rotated in the atlas)
+ * If compactPrecision is enabled, real numbers are only written with enough digits to round-trip in single precision
  */
-bool exportCSV(const FontGeometry *fonts, int fontCount, int atlasWidth, int atlasHeight, msdfgen::YAxisOrientation yDirection, const char *filename);
+bool exportCSV(const FontGeometry *fonts, int fontCount, int atlasWidth, int atlasHeight, msdfgen::YAxisOrientation yDirection, const char *filename, bool compactPrecision = false);
+
+/**
+ * Writes per-glyph generation measurements (see ImmediateAtlasGenerator::setProfiling) into a CSV file with a header row
+ * The columns are: glyph index, Unicode codepoint (0 if unknown), edge count, box pixel count, generation time and error correction time in seconds,
+ * complexity class (simple / moderate / complex, see GeneratorAttributes::adaptiveQuality)
+ */
+bool exportGlyphProfileCSV(const GlyphProfile *profile, int count, const char *filename);
 
 }
@@ -0,0 +1,97 @@
+
+#include "edge-coloring-cache.h"
+
+#include <cstdio>
+#include <cstring>
+#include "glyph-deduplication.h"
+#include "incremental-atlas.h"
+
+#define EDGE_COLORING_CACHE_TAG "MSDFACOL"
+#define EDGE_COLORING_CACHE_VERSION 1
+
+namespace msdf_atlas {
+
+unsigned long long edgeColoringKey(const GlyphGeometry &glyph, unsigned long long seed) {
+    unsigned long long key = hashGlyphGeometry(glyph);
+    hashAtlasSettings(key, &seed, sizeof(seed));
+    return key;
+}
+
+template <typename T>
+static bool readValue(T &value, FILE *f) {
+    return fread(&value, sizeof(T), 1, f) == 1;
+}
+
+template <typename T>
+static bool writeValue(const T &value, FILE *f) {
+    return fwrite(&value, sizeof(T), 1, f) == 1;
+}
+
+/// Returns the size of the file in bytes or -1 on error, the position is reset to the start
+static long getFileSize(FILE *f) {
+    if (fseek(f, 0, SEEK_END))
+        return -1;
+    long size = ftell(f);
+    if (fseek(f, 0, SEEK_SET))
+        return -1;
+    return size;
+}
+
+/// Reads the cache from a file of fileSize bytes, counts are checked against the remaining size so that a corrupted file cannot trigger huge allocations
+static bool readCache(EdgeColoringCache &cache, FILE *f, long fileSize) {
+    char tag[8];
+    int version = 0, glyphCount = 0;
+    if (!(
+        fread(tag, 1, sizeof(tag), f) == sizeof(tag) && !memcmp(tag, EDGE_COLORING_CACHE_TAG, sizeof(tag)) &&
+        readValue(version, f) && version == EDGE_COLORING_CACHE_VERSION &&
+        readValue(cache.settingsHash, f) &&
+        readValue(glyphCount, f) && glyphCount >= 0
+    ))
+        return false;
+    for (int i = 0; i < glyphCount; ++i) {
+        unsigned long long key = 0;
+        int edgeCount = 0;
+        if (!(readValue(key, f) && readValue(edgeCount, f) && edgeCount >= 0 && edgeCount <= fileSize-ftell(f)))
+            return false;
+        std::vector<byte> &colors = cache.glyphs[key];
+        colors.resize(edgeCount);
+        if (fread(colors.data(), 1, colors.size(), f) != colors.size())
+            return false;
+    }
+    return true;
+}
+
+bool loadEdgeColoringCache(EdgeColoringCache &cache, const char *filename) {
+    FILE *f = fopen(filename, "rb");
+    if (!f)
+        return false;
+    cache.glyphs.clear();
+    long fileSize = getFileSize(f);
+    bool success = fileSize >= 0 && readCache(cache, f, fileSize);
+    fclose(f);
+    if (!success)
+        cache.glyphs.clear();
+    return success;
+}
+
+bool saveEdgeColoringCache(const EdgeColoringCache &cache, const char *filename) {
+    FILE *f = fopen(filename, "wb");
+    if (!f)
+        return false;
+    int version = EDGE_COLORING_CACHE_VERSION, glyphCount = (int) cache.glyphs.size();
+    bool success = (
+        fwrite(EDGE_COLORING_CACHE_TAG, 1, 8, f) == 8 &&
+        writeValue(version, f) &&
+        writeValue(cache.settingsHash, f) &&
+        writeValue(glyphCount, f)
+    );
+    for (const std::pair<const unsigned long long, std::vector<byte> > &glyph : cache.glyphs) {
+        if (!success)
+            break;
+        int edgeCount = (int) glyph.second.size();
+        success = writeValue(glyph.first, f) && writeValue(edgeCount, f) && fwrite(glyph.second.data(), 1, glyph.second.size(), f) == glyph.second.size();
+    }
+    return fclose(f) == 0 && success;
+}
+
+}
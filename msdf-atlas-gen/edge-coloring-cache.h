@@ -0,0 +1,30 @@
+
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include "types.h"
+#include "GlyphGeometry.h"
+
+namespace msdf_atlas {
+
+/**
+ * Edge colors of previously colored glyphs, which allows skipping edge coloring of unchanged glyphs in consecutive runs.
+ * The cache file is meant for local use between consecutive runs and is stored in the host's byte order.
+ */
+struct EdgeColoringCache {
+    /// Hash of the coloring settings (strategy and angle threshold) the colors were computed with (see hashAtlasSettings)
+    unsigned long long settingsHash;
+    /// Colors of each glyph's edges in contour order, keyed by edgeColoringKey
+    std::unordered_map<unsigned long long, std::vector<byte> > glyphs;
+};
+
+/// Identifies the edge coloring of a glyph by its uncolored geometry and coloring seed
+unsigned long long edgeColoringKey(const GlyphGeometry &glyph, unsigned long long seed);
+
+/// Loads the edge coloring cache from a file, returns false if it doesn't exist or is invalid
+bool loadEdgeColoringCache(EdgeColoringCache &cache, const char *filename);
+/// Saves the edge coloring cache into a file
+bool saveEdgeColoringCache(const EdgeColoringCache &cache, const char *filename);
+
+}
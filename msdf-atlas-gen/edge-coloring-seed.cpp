@@ -0,0 +1,17 @@
+
+#include "edge-coloring-seed.h"
+
+#define LCG_MULTIPLIER 6364136223846793005ull
+#define LCG_INCREMENT 1442695040888963407ull
+
+namespace msdf_atlas {
+
+unsigned long long glyphColoringSeed(unsigned long long coloringSeed, unsigned long long key) {
+    return (LCG_MULTIPLIER*(coloringSeed^key)+LCG_INCREMENT)*!!coloringSeed;
+}
+
+unsigned long long nextLegacyColoringSeed(unsigned long long seed) {
+    return LCG_MULTIPLIER*seed;
+}
+
+}
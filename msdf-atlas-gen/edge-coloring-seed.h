@@ -0,0 +1,11 @@
+
+#pragma once
+
+namespace msdf_atlas {
+
+/// Derives the edge coloring seed of a single glyph from the coloring seed and a key (the glyph index) in one step of a linear congruential generator, zero if the coloring seed is zero
+unsigned long long glyphColoringSeed(unsigned long long coloringSeed, unsigned long long key);
+/// Returns the next seed of the legacy sequence, in which each consecutive glyph's seed is the previous one multiplied by the generator's multiplier
+unsigned long long nextLegacyColoringSeed(unsigned long long seed);
+
+}
@@ -0,0 +1,143 @@
+
+#include "glyph-complexity.h"
+
+#include <cmath>
+#include <vector>
+
+/// Shapes with more edges are not analyzed and considered complex
+#define MAX_ANALYZED_EDGES 128
+/// Maximum number of edges of a moderately complex shape
+#define MAX_MODERATE_EDGES 64
+/// Maximum number of corners of a moderately complex shape
+#define MAX_MODERATE_CORNERS 12
+/// Sine of the default angle threshold of edge coloring (3 radians), above which a change of direction is a corner
+#define CORNER_CROSS_THRESHOLD 0.14112000805986721
+
+/// Number of line segments that approximate each curved edge in the intersection test
+#define CURVE_SEGMENTS 8
+
+namespace msdf_atlas {
+
+namespace {
+
+struct Segment {
+    msdfgen::Point2 a, b;
+    int contour, edge;
+    int part, partCount;
+};
+
+}
+
+static bool segmentsCross(const Segment &s, const Segment &t) {
+    msdfgen::Vector2 d = s.b-s.a, e = t.b-t.a;
+    double denominator = msdfgen::crossProduct(d, e);
+    if (denominator == 0)
+        return false;
+    double u = msdfgen::crossProduct(t.a-s.a, e)/denominator;
+    double v = msdfgen::crossProduct(t.a-s.a, d)/denominator;
+    return u >= 0 && u <= 1 && v >= 0 && v <= 1;
+}
+
+/// Returns true if two edges of the shape (approximated by line segments) intersect anywhere except at the shared endpoint of consecutive edges
+static bool anyEdgesIntersect(const msdfgen::Shape &shape) {
+    std::vector<Segment> segments;
+    std::vector<int> contourSizes;
+    for (const msdfgen::Contour &contour : shape.contours) {
+        for (size_t i = 0; i < contour.edges.size(); ++i) {
+            const msdfgen::EdgeHolder &edge = contour.edges[i];
+            int partCount = edge->type() > 1 ? CURVE_SEGMENTS : 1;
+            for (int j = 0; j < partCount; ++j) {
+                Segment segment = { edge->point(double(j)/partCount), edge->point(double(j+1)/partCount), (int) contourSizes.size(), (int) i, j, partCount };
+                segments.push_back(segment);
+            }
+        }
+        contourSizes.push_back((int) contour.edges.size());
+    }
+    for (size_t i = 0; i < segments.size(); ++i) {
+        const Segment &s = segments[i];
+        for (size_t j = i+1; j < segments.size(); ++j) {
+            const Segment &t = segments[j];
+            if (s.contour == t.contour) {
+                // Consecutive segments share an endpoint
+                int size = contourSizes[s.contour];
+                if (s.edge == t.edge && t.part == s.part+1)
+                    continue;
+                if (t.edge == s.edge+1 && s.part == s.partCount-1 && t.part == 0)
+                    continue;
+                if (s.edge == 0 && t.edge == size-1 && s.part == 0 && t.part == t.partCount-1)
+                    continue;
+            }
+            if (segmentsCross(s, t))
+                return true;
+        }
+    }
+    return false;
+}
+
+/// Returns true if the contour's control polygon turns in a single direction by exactly one full turn, which makes the contour convex
+static bool isConvex(const msdfgen::Contour &contour) {
+    std::vector<msdfgen::Point2> points;
+    for (const msdfgen::EdgeHolder &edge : contour.edges) {
+        const msdfgen::Point2 *controlPoints = edge->controlPoints();
+        for (int i = 0; i < edge->type(); ++i) {
+            if (points.empty() || controlPoints[i] != points.back())
+                points.push_back(controlPoints[i]);
+        }
+    }
+    while (points.size() > 1 && points.front() == points.back())
+        points.pop_back();
+    if (points.size() < 3)
+        return false;
+    int direction = 0;
+    double totalAngle = 0;
+    for (size_t i = 0; i < points.size(); ++i) {
+        msdfgen::Vector2 a = points[(i+1)%points.size()]-points[i];
+        msdfgen::Vector2 b = points[(i+2)%points.size()]-points[(i+1)%points.size()];
+        double cross = msdfgen::crossProduct(a, b);
+        int turn = (cross > 0)-(cross < 0);
+        if (turn) {
+            if (direction && turn != direction)
+                return false;
+            direction = turn;
+        }
+        totalAngle += atan2(cross, msdfgen::dotProduct(a, b));
+    }
+    return fabs(fabs(totalAngle)-6.283185307179586) < 1e-6;
+}
+
+static int countCorners(const msdfgen::Contour &contour) {
+    int corners = 0;
+    if (!contour.edges.empty()) {
+        msdfgen::Vector2 prevDirection = contour.edges.back()->direction(1);
+        for (const msdfgen::EdgeHolder &edge : contour.edges) {
+            msdfgen::Vector2 a = prevDirection.normalize(), b = edge->direction(0).normalize();
+            if (msdfgen::dotProduct(a, b) <= 0 || fabs(msdfgen::crossProduct(a, b)) > CORNER_CROSS_THRESHOLD)
+                ++corners;
+            prevDirection = edge->direction(1);
+        }
+    }
+    return corners;
+}
+
+GlyphComplexity classifyGlyphComplexity(const msdfgen::Shape &shape) {
+    int edgeCount = shape.edgeCount();
+    if (edgeCount > MAX_ANALYZED_EDGES)
+        return GlyphComplexity::COMPLEX;
+    // A convex contour cannot intersect itself
+    if (shape.contours.size() == 1 && isConvex(shape.contours.front()))
+        return GlyphComplexity::SIMPLE;
+    if (edgeCount > MAX_MODERATE_EDGES || anyEdgesIntersect(shape))
+        return GlyphComplexity::COMPLEX;
+    int curveCount = 0, cornerCount = 0;
+    for (const msdfgen::Contour &contour : shape.contours) {
+        for (const msdfgen::EdgeHolder &edge : contour.edges)
+            curveCount += edge->type() > 1;
+        cornerCount += countCorners(contour);
+    }
+    // Artifacts are most likely where curves meet at corners, which purely polygonal shapes do not have
+    if (curveCount && cornerCount > MAX_MODERATE_CORNERS)
+        return GlyphComplexity::COMPLEX;
+    return GlyphComplexity::MODERATE;
+}
+
+}
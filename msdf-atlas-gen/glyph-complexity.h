@@ -0,0 +1,16 @@
+
+#pragma once
+
+#include <msdfgen.h>
+#include "types.h"
+
+namespace msdf_atlas {
+
+/**
+ * Classifies the shape's complexity by its edge and curve counts, corners, convexity and intersections between edges
+ * (including overlapping contours), which is used by the generator functions if GeneratorAttributes::adaptiveQuality is enabled.
+ * The classification is conservative - any shape whose distance field might be affected by the reduced post-processing is COMPLEX.
+ */
+GlyphComplexity classifyGlyphComplexity(const msdfgen::Shape &shape);
+
+}
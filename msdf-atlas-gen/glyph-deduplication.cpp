@@ -0,0 +1,89 @@
+
+#include "glyph-deduplication.h"
+
+#include <cstring>
+#include <vector>
+#include <unordered_map>
+
+namespace msdf_atlas {
+
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ull
+#define FNV_PRIME 0x00000100000001b3ull
+
+static void hashBytes(unsigned long long &hash, const void *data, size_t size) {
+    const byte *bytes = reinterpret_cast<const byte *>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+}
+
+unsigned long long hashGlyphGeometry(const GlyphGeometry &glyph, bool edgeColors) {
+    unsigned long long hash = FNV_OFFSET_BASIS;
+    double geometryScale = glyph.getGeometryScale();
+    hashBytes(hash, &geometryScale, sizeof(geometryScale));
+    const msdfgen::Shape &shape = glyph.getShape();
+    byte inverseYAxis = shape.inverseYAxis;
+    hashBytes(hash, &inverseYAxis, sizeof(inverseYAxis));
+    for (const msdfgen::Contour &contour : shape.contours) {
+        int edgeCount = (int) contour.edges.size();
+        hashBytes(hash, &edgeCount, sizeof(edgeCount));
+        for (const msdfgen::EdgeHolder &edge : contour.edges) {
+            int type = edge->type();
+            hashBytes(hash, &type, sizeof(type));
+            hashBytes(hash, edge->controlPoints(), sizeof(msdfgen::Point2)*(type+1));
+            if (edgeColors) {
+                int color = edge->color;
+                hashBytes(hash, &color, sizeof(color));
+            }
+        }
+    }
+    return hash;
+}
+
+static bool identicalGeometry(const GlyphGeometry &a, const GlyphGeometry &b) {
+    if (a.getGeometryScale() != b.getGeometryScale())
+        return false;
+    const msdfgen::Shape &shapeA = a.getShape(), &shapeB = b.getShape();
+    if (shapeA.inverseYAxis != shapeB.inverseYAxis || shapeA.contours.size() != shapeB.contours.size())
+        return false;
+    for (size_t i = 0; i < shapeA.contours.size(); ++i) {
+        const std::vector<msdfgen::EdgeHolder> &edgesA = shapeA.contours[i].edges, &edgesB = shapeB.contours[i].edges;
+        if (edgesA.size() != edgesB.size())
+            return false;
+        for (size_t j = 0; j < edgesA.size(); ++j) {
+            int type = edgesA[j]->type();
+            if (type != edgesB[j]->type())
+                return false;
+            const msdfgen::Point2 *pointsA = edgesA[j]->controlPoints(), *pointsB = edgesB[j]->controlPoints();
+            for (int k = 0; k <= type; ++k) {
+                if (pointsA[k] != pointsB[k])
+                    return false;
+            }
+        }
+    }
+    return true;
+}
+
+int findDuplicateGlyphs(int *duplicateOf, const GlyphGeometry *glyphs, int count) {
+    int duplicates = 0;
+    std::unordered_map<unsigned long long, std::vector<int> > buckets;
+    for (int i = 0; i < count; ++i) {
+        duplicateOf[i] = -1;
+        if (glyphs[i].isWhitespace())
+            continue;
+        std::vector<int> &bucket = buckets[hashGlyphGeometry(glyphs[i])];
+        for (int j : bucket) {
+            if (identicalGeometry(glyphs[j], glyphs[i])) {
+                duplicateOf[i] = j;
+                ++duplicates;
+                break;
+            }
+        }
+        if (duplicateOf[i] < 0)
+            bucket.push_back(i);
+    }
+    return duplicates;
+}
+
+}
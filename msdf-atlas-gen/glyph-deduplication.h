@@ -0,0 +1,18 @@
+
+#pragma once
+
+#include "GlyphGeometry.h"
+
+namespace msdf_atlas {
+
+/**
+ * Finds glyphs with identical geometry (same outline and geometry scale), which therefore also have identical boxes and bitmaps,
+ * e.g. multiple codepoints mapped to the same outline. For each glyph, outputs the index of the first glyph identical to it
+ * into duplicateOf, or -1 if it is the first of its kind. Edge colors are not taken into account. Returns the number of duplicates.
+ */
+int findDuplicateGlyphs(int *duplicateOf, const GlyphGeometry *glyphs, int count);
+
+/// Computes a hash of the glyph's geometry (outline and geometry scale) and optionally its edge colors
+unsigned long long hashGlyphGeometry(const GlyphGeometry &glyph, bool edgeColors = false);
+
+}
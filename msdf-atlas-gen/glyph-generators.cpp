@@ -1,52 +1,275 @@
 
 #include "glyph-generators.h"
 
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include "Instrumentation.h"
+#include "glyph-complexity.h"
+#include "GlyphEdgeIndex.h"
+#include "ScanlineRasterizer.h"
+
+/// Size of the square tiles (in pixels) into which the glyph's box is split by sparse generation and the edge index
+#define GENERATOR_TILE_SIZE 16
+/// Minimum number of edges of a glyph for which the edge index is used
+#define EDGE_INDEX_MIN_EDGES 32
+
 namespace msdf_atlas {
 
+/**
+ * Generates the distance field by calling generate(section, shape, projection) for tiles of the output. In sparse mode, tiles which are
+ * out of range of all edges (determined conservatively from their bounding boxes) are filled with the saturated inside / outside value instead,
+ * according to fill (see rasterizeFill), which is only needed in sparse mode. The bound is based on the true distance, so pseudo-distances (PSDF, MSDF, MTSDF)
+ * are saturated in these tiles too, even where an edge's extension past its endpoint would bring them within range in dense generation.
+ * With the edge index, each tile is generated from only the edges that may affect it, otherwise adjacent tiles are generated together.
+ */
+template <int N, typename GEN>
+static void generateTiled(const msdfgen::BitmapSection<float, N> &output, const GlyphGeometry &glyph, const GeneratorAttributes &attribs, const byte *fill, GEN generate) {
+    const msdfgen::Shape &shape = glyph.getShape();
+    bool edgeIndex = attribs.edgeIndex && !attribs.config.overlapSupport && shape.edgeCount() >= EDGE_INDEX_MIN_EDGES;
+    if (!(attribs.sparse || edgeIndex)) {
+        generate(output, shape, glyph.getBoxProjection());
+        return;
+    }
+    msdfgen::BitmapSection<float, N> section = output;
+    section.reorient(shape.getYAxisOrientation());
+    double scale = glyph.getBoxScale();
+    msdfgen::Vector2 translate = glyph.getBoxTranslate();
+    msdfgen::Range range = glyph.getBoxRange();
+    double saturationDistance = std::max(-range.lower, range.upper);
+    GlyphEdgeIndex index(shape);
+    msdfgen::Shape culledShape;
+
+    int tilesX = (section.width+GENERATOR_TILE_SIZE-1)/GENERATOR_TILE_SIZE;
+    for (int y0 = 0; y0 < section.height; y0 += GENERATOR_TILE_SIZE) {
+        int y1 = std::min(y0+GENERATOR_TILE_SIZE, section.height);
+        double b = y0/scale-translate.y, t = y1/scale-translate.y;
+        int runStart = -1;
+        for (int tx = 0; tx <= tilesX; ++tx) {
+            int x0 = std::min(tx*GENERATOR_TILE_SIZE, section.width), x1 = std::min(x0+GENERATOR_TILE_SIZE, section.width);
+            double l = x0/scale-translate.x, r = x1/scale-translate.x;
+            bool inRange = tx < tilesX && (!attribs.sparse || index.anyEdgeWithin(l, b, r, t, saturationDistance));
+            if (inRange && edgeIndex) {
+                index.cullShape(culledShape, l, b, r, t);
+                generate(section.getSection(x0, y0, x1, y1), culledShape, msdfgen::Projection(msdfgen::Vector2(scale), translate-msdfgen::Vector2(x0, y0)/scale));
+                continue;
+            }
+            if (inRange) {
+                if (runStart < 0)
+                    runStart = x0;
+                continue;
+            }
+            if (runStart >= 0) {
+                generate(section.getSection(runStart, y0, x0, y1), shape, msdfgen::Projection(msdfgen::Vector2(scale), translate-msdfgen::Vector2(runStart, y0)/scale));
+                runStart = -1;
+            }
+            if (tx < tilesX) {
+                // The tile is farther from all edges than the range, so it is either completely inside or outside
+                float value = fill[(size_t) section.width*y0+x0] ? 1.f : 0.f;
+                for (int y = y0; y < y1; ++y) {
+                    float *p = section(x0, y);
+                    for (int i = 0; i < N*(x1-x0); ++i)
+                        p[i] = value;
+                }
+            }
+        }
+    }
+}
+
+/// Rasterizes the fill of the glyph's pixels in the Y-axis orientation of its shape, which is shared by sparse generation and the scanline pass
+static void rasterizeFill(std::vector<byte> &fill, int width, int height, const GlyphGeometry &glyph) {
+    fill.resize((size_t) width*height);
+    ScanlineRasterizer(glyph.getShape(), glyph.getBoxProjection()).fill(fill.data(), width, height, MSDF_ATLAS_GLYPH_FILL_RULE);
+}
+
+static float median(float a, float b, float c) {
+    return std::max(std::min(a, b), std::min(std::max(a, b), c));
+}
+
+/// Corrects the signs of the distances according to the rasterized fill, same as msdfgen::distanceSignCorrection
+static void distanceSignCorrection(const msdfgen::BitmapSection<float, 1> &output, const GlyphGeometry &glyph, const byte *fill) {
+    msdfgen::BitmapSection<float, 1> section = output;
+    section.reorient(glyph.getShape().getYAxisOrientation());
+    for (int y = 0; y < section.height; ++y) {
+        for (int x = 0; x < section.width; ++x) {
+            float &sd = *section(x, y);
+            if ((sd > .5f) != (*fill++ != 0))
+                sd = 1.f-sd;
+        }
+    }
+}
+
+/// Corrects the signs of the multi-channel distances according to the rasterized fill, same as msdfgen::distanceSignCorrection
+template <int N>
+static void distanceSignCorrection(const msdfgen::BitmapSection<float, N> &output, const GlyphGeometry &glyph, const byte *fill) {
+    msdfgen::BitmapSection<float, N> section = output;
+    section.reorient(glyph.getShape().getYAxisOrientation());
+    int w = section.width, h = section.height;
+    bool ambiguous = false;
+    std::vector<signed char> matchMap((size_t) w*h);
+    signed char *match = matchMap.data();
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x, ++match, ++fill) {
+            bool filled = *fill != 0;
+            float *msd = section(x, y);
+            float sd = median(msd[0], msd[1], msd[2]);
+            if (sd == .5f)
+                ambiguous = true;
+            else if ((sd > .5f) != filled) {
+                msd[0] = 1.f-msd[0];
+                msd[1] = 1.f-msd[1];
+                msd[2] = 1.f-msd[2];
+                *match = -1;
+            } else
+                *match = 1;
+            if (N >= 4 && (msd[3] > .5f) != filled)
+                msd[3] = 1.f-msd[3];
+        }
+    }
+    // Pixels exactly at the edge are flipped if their neighbors were, to avoid artifacts when the whole shape is inverted
+    if (ambiguous) {
+        match = matchMap.data();
+        for (int y = 0; y < h; ++y) {
+            for (int x = 0; x < w; ++x, ++match) {
+                if (!*match) {
+                    int neighborMatch = 0;
+                    if (x > 0)
+                        neighborMatch += *(match-1);
+                    if (x < w-1)
+                        neighborMatch += *(match+1);
+                    if (y > 0)
+                        neighborMatch += *(match-w);
+                    if (y < h-1)
+                        neighborMatch += *(match+w);
+                    if (neighborMatch < 0) {
+                        float *msd = section(x, y);
+                        msd[0] = 1.f-msd[0];
+                        msd[1] = 1.f-msd[1];
+                        msd[2] = 1.f-msd[2];
+                    }
+                }
+            }
+        }
+    }
+}
+
+/// Performs error correction separately from msdfgen::generateMSDF / generateMTSDF (which would otherwise do the same), so that it can be measured
+template <int N>
+static void errorCorrection(const msdfgen::BitmapSection<float, N> &output, const GlyphGeometry &glyph, const msdfgen::MSDFGeneratorConfig &config, const GeneratorAttributes &attribs) {
+    if (config.errorCorrection.mode == msdfgen::ErrorCorrectionConfig::DISABLED)
+        return;
+    Instrumentation::Scope scope(Instrumentation::ERROR_CORRECTION);
+    std::chrono::steady_clock::time_point start;
+    if (attribs.errorCorrectionTime)
+        start = std::chrono::steady_clock::now();
+    msdfgen::msdfErrorCorrection(output, glyph.getShape(), glyph.getBoxProjection(), glyph.getBoxRange(), config);
+    if (attribs.errorCorrectionTime)
+        *attribs.errorCorrectionTime = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+    scope.addGlyphs(1);
+    scope.addPixels((unsigned long long) output.width*output.height);
+}
+
+/// Returns the complexity of the glyph, which determines its post-processing, and reports it to the caller if requested
+static GlyphComplexity glyphComplexity(const GlyphGeometry &glyph, const GeneratorAttributes &attribs) {
+    GlyphComplexity complexity = GlyphComplexity::COMPLEX;
+    if (attribs.adaptiveQuality) {
+        complexity = classifyGlyphComplexity(glyph.getShape());
+        if (attribs.complexity)
+            *attribs.complexity = complexity;
+    }
+    return complexity;
+}
+
+/// Adjusts error correction of MSDF / MTSDF according to the glyph's complexity - skipped for simple glyphs, without the slow distance check for moderate ones
+static void adaptErrorCorrection(msdfgen::MSDFGeneratorConfig &config, GlyphComplexity complexity) {
+    if (complexity == GlyphComplexity::SIMPLE)
+        config.errorCorrection.mode = msdfgen::ErrorCorrectionConfig::DISABLED;
+    else if (complexity == GlyphComplexity::MODERATE)
+        config.errorCorrection.distanceCheckMode = msdfgen::ErrorCorrectionConfig::DO_NOT_CHECK_DISTANCE;
+}
+
 void scanlineGenerator(const msdfgen::BitmapSection<float, 1> &output, const GlyphGeometry &glyph, const GeneratorAttributes &attribs) {
-    msdfgen::rasterize(output, glyph.getShape(), glyph.getBoxScale(), glyph.getBoxTranslate(), MSDF_ATLAS_GLYPH_FILL_RULE);
+    msdfgen::BitmapSection<float, 1> section = output;
+    section.reorient(glyph.getShape().getYAxisOrientation());
+    ScanlineRasterizer rasterizer(glyph.getShape(), glyph.getBoxProjection());
+    std::vector<byte> row(section.width);
+    for (int y = 0; y < section.height; ++y) {
+        rasterizer.moveToRow(y);
+        rasterizer.fillRow(row.data(), section.width, MSDF_ATLAS_GLYPH_FILL_RULE);
+        for (int x = 0; x < section.width; ++x)
+            *section(x, y) = row[x] ? 1.f : 0.f;
+    }
+}
+
+void softMaskGenerator(const msdfgen::BitmapSection<float, 1> &output, const GlyphGeometry &glyph, const GeneratorAttributes &attribs) {
+    ScanlineRasterizer::coverage(output, glyph.getShape(), glyph.getBoxProjection());
 }
 
 void sdfGenerator(const msdfgen::BitmapSection<float, 1> &output, const GlyphGeometry &glyph, const GeneratorAttributes &attribs) {
-    msdfgen::generateSDF(output, glyph.getShape(), glyph.getBoxProjection(), glyph.getBoxRange(), attribs.config);
-    if (attribs.scanlinePass)
-        msdfgen::distanceSignCorrection(output, glyph.getShape(), glyph.getBoxProjection(), MSDF_ATLAS_GLYPH_FILL_RULE);
+    GlyphComplexity complexity = glyphComplexity(glyph, attribs);
+    bool scanlinePass = attribs.scanlinePass && complexity == GlyphComplexity::COMPLEX;
+    std::vector<byte> fill;
+    if (scanlinePass || attribs.sparse)
+        rasterizeFill(fill, output.width, output.height, glyph);
+    generateTiled(output, glyph, attribs, fill.data(), [&glyph, &attribs](const msdfgen::BitmapSection<float, 1> &section, const msdfgen::Shape &shape, const msdfgen::Projection &projection) {
+        msdfgen::generateSDF(section, shape, projection, glyph.getBoxRange(), attribs.config);
+    });
+    if (scanlinePass)
+        distanceSignCorrection(output, glyph, fill.data());
 }
 
 void psdfGenerator(const msdfgen::BitmapSection<float, 1> &output, const GlyphGeometry &glyph, const GeneratorAttributes &attribs) {
-    msdfgen::generatePSDF(output, glyph.getShape(), glyph.getBoxProjection(), glyph.getBoxRange(), attribs.config);
-    if (attribs.scanlinePass)
-        msdfgen::distanceSignCorrection(output, glyph.getShape(), glyph.getBoxProjection(), MSDF_ATLAS_GLYPH_FILL_RULE);
+    GlyphComplexity complexity = glyphComplexity(glyph, attribs);
+    bool scanlinePass = attribs.scanlinePass && complexity == GlyphComplexity::COMPLEX;
+    std::vector<byte> fill;
+    if (scanlinePass || attribs.sparse)
+        rasterizeFill(fill, output.width, output.height, glyph);
+    generateTiled(output, glyph, attribs, fill.data(), [&glyph, &attribs](const msdfgen::BitmapSection<float, 1> &section, const msdfgen::Shape &shape, const msdfgen::Projection &projection) {
+        msdfgen::generatePSDF(section, shape, projection, glyph.getBoxRange(), attribs.config);
+    });
+    if (scanlinePass)
+        distanceSignCorrection(output, glyph, fill.data());
 }
 
 void msdfGenerator(const msdfgen::BitmapSection<float, 3> &output, const GlyphGeometry &glyph, const GeneratorAttributes &attribs) {
+    GlyphComplexity complexity = glyphComplexity(glyph, attribs);
+    bool scanlinePass = attribs.scanlinePass && complexity == GlyphComplexity::COMPLEX;
+    std::vector<byte> fill;
+    if (scanlinePass || attribs.sparse)
+        rasterizeFill(fill, output.width, output.height, glyph);
     msdfgen::MSDFGeneratorConfig config = attribs.config;
-    if (attribs.scanlinePass)
-        config.errorCorrection.mode = msdfgen::ErrorCorrectionConfig::DISABLED;
-    msdfgen::generateMSDF(output, glyph.getShape(), glyph.getBoxProjection(), glyph.getBoxRange(), config);
-    if (attribs.scanlinePass) {
-        msdfgen::distanceSignCorrection(output, glyph.getShape(), glyph.getBoxProjection(), MSDF_ATLAS_GLYPH_FILL_RULE);
-        if (attribs.config.errorCorrection.mode != msdfgen::ErrorCorrectionConfig::DISABLED) {
-            config.errorCorrection.mode = attribs.config.errorCorrection.mode;
-            config.errorCorrection.distanceCheckMode = msdfgen::ErrorCorrectionConfig::DO_NOT_CHECK_DISTANCE;
-            msdfgen::msdfErrorCorrection(output, glyph.getShape(), glyph.getBoxProjection(), glyph.getBoxRange(), config);
-        }
+    config.errorCorrection.mode = msdfgen::ErrorCorrectionConfig::DISABLED;
+    generateTiled(output, glyph, attribs, fill.data(), [&glyph, &config](const msdfgen::BitmapSection<float, 3> &section, const msdfgen::Shape &shape, const msdfgen::Projection &projection) {
+        msdfgen::generateMSDF(section, shape, projection, glyph.getBoxRange(), config);
+    });
+    if (scanlinePass) {
+        distanceSignCorrection(output, glyph, fill.data());
+        config.errorCorrection.distanceCheckMode = msdfgen::ErrorCorrectionConfig::DO_NOT_CHECK_DISTANCE;
     }
+    config.errorCorrection.mode = attribs.config.errorCorrection.mode;
+    adaptErrorCorrection(config, complexity);
+    errorCorrection(output, glyph, config, attribs);
 }
 
 void mtsdfGenerator(const msdfgen::BitmapSection<float, 4> &output, const GlyphGeometry &glyph, const GeneratorAttributes &attribs) {
+    GlyphComplexity complexity = glyphComplexity(glyph, attribs);
+    bool scanlinePass = attribs.scanlinePass && complexity == GlyphComplexity::COMPLEX;
+    std::vector<byte> fill;
+    if (scanlinePass || attribs.sparse)
+        rasterizeFill(fill, output.width, output.height, glyph);
     msdfgen::MSDFGeneratorConfig config = attribs.config;
-    if (attribs.scanlinePass)
-        config.errorCorrection.mode = msdfgen::ErrorCorrectionConfig::DISABLED;
-    msdfgen::generateMTSDF(output, glyph.getShape(), glyph.getBoxProjection(), glyph.getBoxRange(), config);
-    if (attribs.scanlinePass) {
-        msdfgen::distanceSignCorrection(output, glyph.getShape(), glyph.getBoxProjection(), MSDF_ATLAS_GLYPH_FILL_RULE);
-        if (attribs.config.errorCorrection.mode != msdfgen::ErrorCorrectionConfig::DISABLED) {
-            config.errorCorrection.mode = attribs.config.errorCorrection.mode;
-            config.errorCorrection.distanceCheckMode = msdfgen::ErrorCorrectionConfig::DO_NOT_CHECK_DISTANCE;
-            msdfgen::msdfErrorCorrection(output, glyph.getShape(), glyph.getBoxProjection(), glyph.getBoxRange(), config);
-        }
+    config.errorCorrection.mode = msdfgen::ErrorCorrectionConfig::DISABLED;
+    generateTiled(output, glyph, attribs, fill.data(), [&glyph, &config](const msdfgen::BitmapSection<float, 4> &section, const msdfgen::Shape &shape, const msdfgen::Projection &projection) {
+        msdfgen::generateMTSDF(section, shape, projection, glyph.getBoxRange(), config);
+    });
+    if (scanlinePass) {
+        distanceSignCorrection(output, glyph, fill.data());
+        config.errorCorrection.distanceCheckMode = msdfgen::ErrorCorrectionConfig::DO_NOT_CHECK_DISTANCE;
     }
+    config.errorCorrection.mode = attribs.config.errorCorrection.mode;
+    adaptErrorCorrection(config, complexity);
+    errorCorrection(output, glyph, config, attribs);
 }
 
 }
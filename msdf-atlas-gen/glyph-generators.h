@@ -13,6 +13,8 @@ namespace msdf_atlas {
 
 /// Generates non-anti-aliased binary image of the glyph using scanline rasterization
 void scanlineGenerator(const msdfgen::BitmapSection<float, 1> &output, const GlyphGeometry &glyph, const GeneratorAttributes &attribs);
+/// Generates anti-aliased image of the glyph with the exact coverage of each pixel
+void softMaskGenerator(const msdfgen::BitmapSection<float, 1> &output, const GlyphGeometry &glyph, const GeneratorAttributes &attribs);
 /// Generates a true signed distance field of the glyph
 void sdfGenerator(const msdfgen::BitmapSection<float, 1> &output, const GlyphGeometry &glyph, const GeneratorAttributes &attribs);
 /// Generates a signed perpendicular distance field of the glyph
@@ -0,0 +1,75 @@
+
+#include "half-float.h"
+
+#include <cstring>
+#ifdef __F16C__
+#include <immintrin.h>
+#endif
+
+namespace msdf_atlas {
+
+half pixelFloatToHalf(float x) {
+    uint32_t f;
+    memcpy(&f, &x, sizeof(f));
+    uint32_t sign = f&0x80000000u;
+    f ^= sign;
+    half result;
+    if (f >= 0x47800000u) // Infinity, NaN, or too large (65520 and above)
+        result.bits = uint16_t(f > 0x7f800000u ? 0x7e00u : 0x7c00u);
+    else if (f < 0x38800000u) {
+        // Subnormal result - adding 0.5 aligns the mantissa's rounded bits to the bottom of the float's mantissa
+        float magic;
+        memcpy(&magic, &f, sizeof(magic));
+        magic += .5f;
+        memcpy(&f, &magic, sizeof(f));
+        result.bits = uint16_t(f-0x3f000000u);
+    } else {
+        uint32_t mantissaOdd = (f>>13)&1u;
+        // Rebias exponent from 127 to 15 and round to nearest even
+        f += 0xc8000fffu+mantissaOdd;
+        result.bits = uint16_t(f>>13);
+    }
+    result.bits |= uint16_t(sign>>16);
+    return result;
+}
+
+float pixelHalfToFloat(half x) {
+    uint32_t f = uint32_t(x.bits&0x7fffu)<<13;
+    uint32_t exponent = f&0x0f800000u;
+    f += 0x38000000u; // Rebias exponent from 15 to 127
+    float result;
+    if (exponent == 0x0f800000u) // Infinity or NaN
+        f += 0x38000000u;
+    else if (!exponent) {
+        // Subnormal input - renormalized by subtracting the implicit leading one
+        f += 0x00800000u;
+        memcpy(&result, &f, sizeof(result));
+        result -= 6.103515625e-05f;
+        memcpy(&f, &result, sizeof(f));
+    }
+    f |= uint32_t(x.bits&0x8000u)<<16;
+    memcpy(&result, &f, sizeof(result));
+    return result;
+}
+
+void convertFloatToHalf(half *dst, const float *src, size_t count) {
+    size_t i = 0;
+#ifdef __F16C__
+    for (; i+8 <= count; i += 8)
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst+i), _mm256_cvtps_ph(_mm256_loadu_ps(src+i), _MM_FROUND_TO_NEAREST_INT));
+#endif
+    for (; i < count; ++i)
+        dst[i] = pixelFloatToHalf(src[i]);
+}
+
+void convertHalfToFloat(float *dst, const half *src, size_t count) {
+    size_t i = 0;
+#ifdef __F16C__
+    for (; i+8 <= count; i += 8)
+        _mm256_storeu_ps(dst+i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src+i))));
+#endif
+    for (; i < count; ++i)
+        dst[i] = pixelHalfToFloat(src[i]);
+}
+
+}
@@ -0,0 +1,19 @@
+
+#pragma once
+
+#include <cstddef>
+#include "types.h"
+
+namespace msdf_atlas {
+
+/// Converts a floating-point value to half precision, rounding to nearest even. Values out of range become infinity
+half pixelFloatToHalf(float x);
+/// Converts a half-precision value to single-precision floating-point (exactly)
+float pixelHalfToFloat(half x);
+
+/// Converts an array of floating-point values to half precision, using the F16C instruction set if available
+void convertFloatToHalf(half *dst, const float *src, size_t count);
+/// Converts an array of half-precision values to single-precision floating-point
+void convertHalfToFloat(float *dst, const half *src, size_t count);
+
+}
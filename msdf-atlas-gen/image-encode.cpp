@@ -2,6 +2,7 @@
 #include "image-encode.h"
 
 #include <core/pixel-conversion.hpp>
+#include "Instrumentation.h"
 
 #ifdef MSDFGEN_USE_LIBPNG
 
@@ -30,9 +31,11 @@ static void pngWrite(png_structp png, png_bytep data, png_size_t length) {
 
 static void pngFlush(png_structp) { }
 
-static bool pngEncode(std::vector<byte> &output, const byte *pixels, int width, int height, int rowStride, int colorType) {
+static bool pngEncode(std::vector<byte> &output, const byte *pixels, int width, int height, int rowStride, int colorType, int bitDepth = 8) {
     if (!(pixels && width && height))
         return false;
+    Instrumentation::Scope scope(Instrumentation::ENCODING);
+    size_t initialSize = output.size();
     png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, &pngIgnoreError, &pngIgnoreError);
     if (!png)
         return false;
@@ -46,10 +49,18 @@ static bool pngEncode(std::vector<byte> &output, const byte *pixels, int width,
     if (setjmp(png_jmpbuf(png)))
         return false;
     png_set_write_fn(png, &output, &pngWrite, &pngFlush);
-    png_set_IHDR(png, info, width, height, 8, colorType, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+    png_set_IHDR(png, info, width, height, bitDepth, colorType, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
     png_set_compression_level(png, 9);
     png_set_rows(png, info, const_cast<png_bytepp>(&rows[0]));
-    png_write_png(png, info, PNG_TRANSFORM_IDENTITY, NULL);
+    int transforms = PNG_TRANSFORM_IDENTITY;
+    #if !MSDF_ATLAS_BIG_ENDIAN
+        // PNG stores 16-bit samples in big endian
+        if (bitDepth == 16)
+            transforms |= PNG_TRANSFORM_SWAP_ENDIAN;
+    #endif
+    png_write_png(png, info, transforms, NULL);
+    scope.addPixels((unsigned long long) width*height);
+    scope.addBytes(output.size()-initialSize);
     return true;
 }
 
@@ -67,6 +78,10 @@ static bool pngEncode(std::vector<byte> &output, const float *pixels, int width,
     return pngEncode(output, bytePixels.data(), width, height, channels*width, colorType);
 }
 
+static bool pngEncode(std::vector<byte> &output, const uint16_t *pixels, int width, int height, int rowStride, int colorType) {
+    return pngEncode(output, reinterpret_cast<const byte *>(pixels), width, height, int(sizeof(uint16_t))*rowStride, colorType, 16);
+}
+
 bool encodePng(std::vector<byte> &output, msdfgen::BitmapConstSection<byte, 1> bitmap) {
     bitmap.reorient(msdfgen::Y_DOWNWARD);
     return pngEncode(output, bitmap.pixels, bitmap.width, bitmap.height, bitmap.rowStride, PNG_COLOR_TYPE_GRAY);
@@ -97,6 +112,21 @@ bool encodePng(std::vector<byte> &output, msdfgen::BitmapConstSection<float, 4>
     return pngEncode(output, bitmap.pixels, bitmap.width, bitmap.height, bitmap.rowStride, 4, PNG_COLOR_TYPE_RGB_ALPHA);
 }
 
+bool encodePng(std::vector<byte> &output, msdfgen::BitmapConstSection<uint16_t, 1> bitmap) {
+    bitmap.reorient(msdfgen::Y_DOWNWARD);
+    return pngEncode(output, bitmap.pixels, bitmap.width, bitmap.height, bitmap.rowStride, PNG_COLOR_TYPE_GRAY);
+}
+
+bool encodePng(std::vector<byte> &output, msdfgen::BitmapConstSection<uint16_t, 3> bitmap) {
+    bitmap.reorient(msdfgen::Y_DOWNWARD);
+    return pngEncode(output, bitmap.pixels, bitmap.width, bitmap.height, bitmap.rowStride, PNG_COLOR_TYPE_RGB);
+}
+
+bool encodePng(std::vector<byte> &output, msdfgen::BitmapConstSection<uint16_t, 4> bitmap) {
+    bitmap.reorient(msdfgen::Y_DOWNWARD);
+    return pngEncode(output, bitmap.pixels, bitmap.width, bitmap.height, bitmap.rowStride, PNG_COLOR_TYPE_RGB_ALPHA);
+}
+
 }
 
 #endif
@@ -107,12 +137,22 @@ bool encodePng(std::vector<byte> &output, msdfgen::BitmapConstSection<float, 4>
 
 namespace msdf_atlas {
 
+static bool lodepngEncode(std::vector<byte> &output, const std::vector<byte> &pixels, int width, int height, LodePNGColorType colorType, unsigned bitDepth = 8) {
+    Instrumentation::Scope scope(Instrumentation::ENCODING);
+    size_t initialSize = output.size();
+    if (lodepng::encode(output, pixels, width, height, colorType, bitDepth))
+        return false;
+    scope.addPixels((unsigned long long) width*height);
+    scope.addBytes(output.size()-initialSize);
+    return true;
+}
+
 bool encodePng(std::vector<byte> &output, msdfgen::BitmapConstSection<byte, 1> bitmap) {
     std::vector<byte> pixels(bitmap.width*bitmap.height);
     bitmap.reorient(msdfgen::Y_DOWNWARD);
     for (int y = 0; y < bitmap.height; ++y)
         memcpy(&pixels[bitmap.width*y], bitmap(0, y), bitmap.width);
-    return !lodepng::encode(output, pixels, bitmap.width, bitmap.height, LCT_GREY);
+    return lodepngEncode(output, pixels, bitmap.width, bitmap.height, LCT_GREY);
 }
 
 bool encodePng(std::vector<byte> &output, msdfgen::BitmapConstSection<byte, 3> bitmap) {
@@ -120,7 +160,7 @@ bool encodePng(std::vector<byte> &output, msdfgen::BitmapConstSection<byte, 3> b
     bitmap.reorient(msdfgen::Y_DOWNWARD);
     for (int y = 0; y < bitmap.height; ++y)
         memcpy(&pixels[3*bitmap.width*y], bitmap(0, y), 3*bitmap.width);
-    return !lodepng::encode(output, pixels, bitmap.width, bitmap.height, LCT_RGB);
+    return lodepngEncode(output, pixels, bitmap.width, bitmap.height, LCT_RGB);
 }
 
 bool encodePng(std::vector<byte> &output, msdfgen::BitmapConstSection<byte, 4> bitmap) {
@@ -128,7 +168,7 @@ bool encodePng(std::vector<byte> &output, msdfgen::BitmapConstSection<byte, 4> b
     bitmap.reorient(msdfgen::Y_DOWNWARD);
     for (int y = 0; y < bitmap.height; ++y)
         memcpy(&pixels[4*bitmap.width*y], bitmap(0, y), 4*bitmap.width);
-    return !lodepng::encode(output, pixels, bitmap.width, bitmap.height, LCT_RGBA);
+    return lodepngEncode(output, pixels, bitmap.width, bitmap.height, LCT_RGBA);
 }
 
 bool encodePng(std::vector<byte> &output, msdfgen::BitmapConstSection<float, 1> bitmap) {
@@ -139,7 +179,7 @@ bool encodePng(std::vector<byte> &output, msdfgen::BitmapConstSection<float, 1>
         for (int x = 0; x < bitmap.width; ++x)
             *it++ = msdfgen::pixelFloatToByte(*bitmap(x, y));
     }
-    return !lodepng::encode(output, pixels, bitmap.width, bitmap.height, LCT_GREY);
+    return lodepngEncode(output, pixels, bitmap.width, bitmap.height, LCT_GREY);
 }
 
 bool encodePng(std::vector<byte> &output, msdfgen::BitmapConstSection<float, 3> bitmap) {
@@ -153,7 +193,7 @@ bool encodePng(std::vector<byte> &output, msdfgen::BitmapConstSection<float, 3>
             *it++ = msdfgen::pixelFloatToByte(bitmap(x, y)[2]);
         }
     }
-    return !lodepng::encode(output, pixels, bitmap.width, bitmap.height, LCT_RGB);
+    return lodepngEncode(output, pixels, bitmap.width, bitmap.height, LCT_RGB);
 }
 
 bool encodePng(std::vector<byte> &output, msdfgen::BitmapConstSection<float, 4> bitmap) {
@@ -168,7 +208,34 @@ bool encodePng(std::vector<byte> &output, msdfgen::BitmapConstSection<float, 4>
             *it++ = msdfgen::pixelFloatToByte(bitmap(x, y)[3]);
         }
     }
-    return !lodepng::encode(output, pixels, bitmap.width, bitmap.height, LCT_RGBA);
+    return lodepngEncode(output, pixels, bitmap.width, bitmap.height, LCT_RGBA);
+}
+
+/// Serializes 16-bit samples in big endian as required by PNG
+template <int N>
+static bool lodepngEncode(std::vector<byte> &output, msdfgen::BitmapConstSection<uint16_t, N> bitmap, LodePNGColorType colorType) {
+    std::vector<byte> pixels(2*N*bitmap.width*bitmap.height);
+    std::vector<byte>::iterator it = pixels.begin();
+    bitmap.reorient(msdfgen::Y_DOWNWARD);
+    for (int y = 0; y < bitmap.height; ++y) {
+        for (const uint16_t *src = bitmap(0, y), *end = src+N*bitmap.width; src < end; ++src) {
+            *it++ = byte(*src>>8);
+            *it++ = byte(*src);
+        }
+    }
+    return lodepngEncode(output, pixels, bitmap.width, bitmap.height, colorType, 16);
+}
+
+bool encodePng(std::vector<byte> &output, msdfgen::BitmapConstSection<uint16_t, 1> bitmap) {
+    return lodepngEncode(output, bitmap, LCT_GREY);
+}
+
+bool encodePng(std::vector<byte> &output, msdfgen::BitmapConstSection<uint16_t, 3> bitmap) {
+    return lodepngEncode(output, bitmap, LCT_RGB);
+}
+
+bool encodePng(std::vector<byte> &output, msdfgen::BitmapConstSection<uint16_t, 4> bitmap) {
+    return lodepngEncode(output, bitmap, LCT_RGBA);
 }
 
 }
@@ -10,7 +10,7 @@
 namespace msdf_atlas {
 
 // Functions to encode an image as a sequence of bytes in memory
-// Only PNG format available currently
+// Only PNG format available currently, 16-bit integer bitmaps are encoded with 16 bits per sample
 
 bool encodePng(std::vector<byte> &output, msdfgen::BitmapConstSection<byte, 1> bitmap);
 bool encodePng(std::vector<byte> &output, msdfgen::BitmapConstSection<byte, 3> bitmap);
@@ -18,6 +18,9 @@ bool encodePng(std::vector<byte> &output, msdfgen::BitmapConstSection<byte, 4> b
 bool encodePng(std::vector<byte> &output, msdfgen::BitmapConstSection<float, 1> bitmap);
 bool encodePng(std::vector<byte> &output, msdfgen::BitmapConstSection<float, 3> bitmap);
 bool encodePng(std::vector<byte> &output, msdfgen::BitmapConstSection<float, 4> bitmap);
+bool encodePng(std::vector<byte> &output, msdfgen::BitmapConstSection<uint16_t, 1> bitmap);
+bool encodePng(std::vector<byte> &output, msdfgen::BitmapConstSection<uint16_t, 3> bitmap);
+bool encodePng(std::vector<byte> &output, msdfgen::BitmapConstSection<uint16_t, 4> bitmap);
 
 }
 
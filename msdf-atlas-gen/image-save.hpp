@@ -2,7 +2,10 @@
 #include "image-save.h"
 
 #include <cstdio>
+#include <vector>
 #include <msdfgen-ext.h>
+#include "image-encode.h"
+#include "Instrumentation.h"
 
 namespace msdf_atlas {
 
@@ -13,6 +16,15 @@ bool saveImageBinaryLE(msdfgen::BitmapConstSection<float, N> bitmap, const char
 template <int N>
 bool saveImageBinaryBE(msdfgen::BitmapConstSection<float, N> bitmap, const char *filename);
 
+template <int N>
+bool saveImageBinary(msdfgen::BitmapConstSection<half, N> bitmap, const char *filename);
+template <typename T, int N>
+bool saveImageTiff16(msdfgen::BitmapConstSection<T, N> bitmap, bool floatingPoint, const char *filename);
+#ifndef MSDFGEN_DISABLE_PNG
+template <int N>
+bool saveImagePng16(msdfgen::BitmapConstSection<uint16_t, N> bitmap, const char *filename);
+#endif
+
 template <int N>
 bool saveImageText(msdfgen::BitmapConstSection<byte, N> bitmap, const char *filename);
 template <int N>
@@ -20,6 +32,8 @@ bool saveImageText(msdfgen::BitmapConstSection<float, N> bitmap, const char *fil
 
 template <int N>
 bool saveImage(const msdfgen::BitmapConstSection<byte, N> &bitmap, ImageFormat format, const char *filename) {
+    Instrumentation::Scope scope(Instrumentation::IMAGE_SAVE);
+    scope.addPixels((unsigned long long) bitmap.width*bitmap.height);
     switch (format) {
     #ifndef MSDFGEN_DISABLE_PNG
         case ImageFormat::PNG:
@@ -49,6 +63,8 @@ bool saveImage(const msdfgen::BitmapConstSection<byte, N> &bitmap, ImageFormat f
 
 template <int N>
 bool saveImage(const msdfgen::BitmapConstSection<float, N> &bitmap, ImageFormat format, const char *filename) {
+    Instrumentation::Scope scope(Instrumentation::IMAGE_SAVE);
+    scope.addPixels((unsigned long long) bitmap.width*bitmap.height);
     switch (format) {
     #ifndef MSDFGEN_DISABLE_PNG
         case ImageFormat::PNG:
@@ -77,6 +93,36 @@ bool saveImage(const msdfgen::BitmapConstSection<float, N> &bitmap, ImageFormat
     return false;
 }
 
+template <int N>
+bool saveImage(const msdfgen::BitmapConstSection<half, N> &bitmap, ImageFormat format, const char *filename) {
+    Instrumentation::Scope scope(Instrumentation::IMAGE_SAVE);
+    scope.addPixels((unsigned long long) bitmap.width*bitmap.height);
+    switch (format) {
+        case ImageFormat::TIFF_HALF:
+            return saveImageTiff16(bitmap, true, filename);
+        case ImageFormat::BINARY_HALF:
+            return saveImageBinary(bitmap, filename);
+        default:;
+    }
+    return false;
+}
+
+template <int N>
+bool saveImage(const msdfgen::BitmapConstSection<uint16_t, N> &bitmap, ImageFormat format, const char *filename) {
+    Instrumentation::Scope scope(Instrumentation::IMAGE_SAVE);
+    scope.addPixels((unsigned long long) bitmap.width*bitmap.height);
+    switch (format) {
+    #ifndef MSDFGEN_DISABLE_PNG
+        case ImageFormat::PNG16:
+            return saveImagePng16(bitmap, filename);
+    #endif
+        case ImageFormat::TIFF16:
+            return saveImageTiff16(bitmap, false, filename);
+        default:;
+    }
+    return false;
+}
+
 template <int N>
 bool saveImageBinary(msdfgen::BitmapConstSection<byte, N> bitmap, const char *filename) {
     bool success = false;
@@ -92,7 +138,7 @@ bool saveImageBinary(msdfgen::BitmapConstSection<byte, N> bitmap, const char *fi
 
 template <int N>
 bool
-    #ifdef __BIG_ENDIAN__
+    #if MSDF_ATLAS_BIG_ENDIAN
         saveImageBinaryBE
     #else
         saveImageBinaryLE
@@ -112,7 +158,7 @@ bool
 
 template <int N>
 bool
-    #ifdef __BIG_ENDIAN__
+    #if MSDF_ATLAS_BIG_ENDIAN
         saveImageBinaryLE
     #else
         saveImageBinaryBE
@@ -136,6 +182,108 @@ bool
     return success;
 }
 
+template <int N>
+bool saveImageBinary(msdfgen::BitmapConstSection<half, N> bitmap, const char *filename) {
+    bool success = false;
+    if (FILE *f = fopen(filename, "wb")) {
+        size_t written = 0;
+        for (int y = 0; y < bitmap.height; ++y)
+            written += fwrite(bitmap(0, y), sizeof(half), (size_t) N*bitmap.width, f);
+        success = written == (size_t) N*bitmap.width*bitmap.height;
+        fclose(f);
+    }
+    return success;
+}
+
+/// Writes an uncompressed TIFF image with 16-bit samples in native byte order - half-precision floating-point if floatingPoint, otherwise unsigned integer
+template <typename T, int N>
+bool saveImageTiff16(msdfgen::BitmapConstSection<T, N> bitmap, bool floatingPoint, const char *filename) {
+    static_assert(sizeof(T) == 2, "TIFF samples must be 16-bit");
+    enum { SHORT = 3, LONG = 4 };
+    const int entryCount = N == 4 ? 12 : 11;
+    // Header, image file directory, BitsPerSample & SampleFormat arrays, pixel data
+    const uint32_t ifdOffset = 8;
+    const uint32_t arraysOffset = ifdOffset+2+12*entryCount+4;
+    const uint32_t dataOffset = arraysOffset+4*N;
+    const uint32_t dataSize = uint32_t(sizeof(T)*N*bitmap.width*bitmap.height);
+    std::vector<byte> header;
+    header.reserve(dataOffset);
+    auto writeShort = [&header](uint16_t value) {
+        header.insert(header.end(), reinterpret_cast<const byte *>(&value), reinterpret_cast<const byte *>(&value)+sizeof(value));
+    };
+    auto writeLong = [&header](uint32_t value) {
+        header.insert(header.end(), reinterpret_cast<const byte *>(&value), reinterpret_cast<const byte *>(&value)+sizeof(value));
+    };
+    // Values of SHORT entries are left-justified within the 4-byte value field
+    auto writeEntry = [&](uint16_t tag, uint16_t type, uint32_t count, uint32_t value) {
+        writeShort(tag);
+        writeShort(type);
+        writeLong(count);
+        if (type == SHORT && count == 1) {
+            writeShort(uint16_t(value));
+            writeShort(0);
+        } else
+            writeLong(value);
+    };
+    #if MSDF_ATLAS_BIG_ENDIAN
+        header.push_back('M'), header.push_back('M');
+    #else
+        header.push_back('I'), header.push_back('I');
+    #endif
+    writeShort(42);
+    writeLong(ifdOffset);
+    writeShort(uint16_t(entryCount));
+    writeEntry(256, LONG, 1, uint32_t(bitmap.width)); // ImageWidth
+    writeEntry(257, LONG, 1, uint32_t(bitmap.height)); // ImageLength
+    if (N == 1)
+        writeEntry(258, SHORT, 1, 16); // BitsPerSample
+    else
+        writeEntry(258, SHORT, N, arraysOffset);
+    writeEntry(259, SHORT, 1, 1); // Compression: none
+    writeEntry(262, SHORT, 1, N >= 3 ? 2 : 1); // PhotometricInterpretation: RGB or BlackIsZero
+    writeEntry(273, LONG, 1, dataOffset); // StripOffsets
+    writeEntry(277, SHORT, 1, N); // SamplesPerPixel
+    writeEntry(278, LONG, 1, uint32_t(bitmap.height)); // RowsPerStrip
+    writeEntry(279, LONG, 1, dataSize); // StripByteCounts
+    writeEntry(284, SHORT, 1, 1); // PlanarConfiguration: chunky
+    if (N == 4)
+        writeEntry(338, SHORT, 1, 2); // ExtraSamples: unassociated alpha
+    if (N == 1)
+        writeEntry(339, SHORT, 1, floatingPoint ? 3 : 1); // SampleFormat
+    else
+        writeEntry(339, SHORT, N, arraysOffset+2*N);
+    writeLong(0);
+    for (int i = 0; i < N; ++i)
+        writeShort(16);
+    for (int i = 0; i < N; ++i)
+        writeShort(floatingPoint ? 3 : 1);
+
+    bool success = false;
+    if (FILE *f = fopen(filename, "wb")) {
+        bitmap.reorient(msdfgen::Y_DOWNWARD);
+        size_t written = fwrite(header.data(), 1, header.size(), f);
+        for (int y = 0; y < bitmap.height; ++y)
+            written += sizeof(T)*fwrite(bitmap(0, y), sizeof(T), (size_t) N*bitmap.width, f);
+        success = written == dataOffset+dataSize;
+        fclose(f);
+    }
+    return success;
+}
+
+#ifndef MSDFGEN_DISABLE_PNG
+template <int N>
+bool saveImagePng16(msdfgen::BitmapConstSection<uint16_t, N> bitmap, const char *filename) {
+    std::vector<byte> data;
+    if (!encodePng(data, bitmap))
+        return false;
+    bool success = false;
+    if (FILE *f = fopen(filename, "wb")) {
+        success = fwrite(data.data(), 1, data.size(), f) == data.size();
+        fclose(f);
+    }
+    return success;
+}
+#endif
 
 template <int N>
 bool saveImageText(msdfgen::BitmapConstSection<byte, N> bitmap, const char *filename) {
@@ -0,0 +1,204 @@
+
+#include "incremental-atlas.h"
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <tuple>
+#include "Rectangle.h"
+#include "RectanglePacker.h"
+
+#define INCREMENTAL_CACHE_TAG "MSDFAINC"
+#define INCREMENTAL_CACHE_VERSION 1
+
+namespace msdf_atlas {
+
+void hashAtlasSettings(unsigned long long &hash, const void *data, size_t size) {
+    const byte *bytes = reinterpret_cast<const byte *>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x00000100000001b3ull;
+    }
+}
+
+template <typename T>
+static bool readValue(T &value, FILE *f) {
+    return fread(&value, sizeof(T), 1, f) == 1;
+}
+
+template <typename T>
+static bool writeValue(const T &value, FILE *f) {
+    return fwrite(&value, sizeof(T), 1, f) == 1;
+}
+
+/// Returns the size of the file in bytes or -1 on error, the position is reset to the start
+static long getFileSize(FILE *f) {
+    if (fseek(f, 0, SEEK_END))
+        return -1;
+    long size = ftell(f);
+    if (fseek(f, 0, SEEK_SET))
+        return -1;
+    return size;
+}
+
+/// Reads the cache from a file of fileSize bytes, counts are checked against the remaining size so that a corrupted file cannot trigger huge allocations
+static bool readCache(IncrementalAtlasCache &cache, FILE *f, long fileSize) {
+    char tag[8];
+    int version = 0, glyphCount = 0;
+    unsigned long long pixelBytes = 0;
+    if (!(
+        fread(tag, 1, sizeof(tag), f) == sizeof(tag) && !memcmp(tag, INCREMENTAL_CACHE_TAG, sizeof(tag)) &&
+        readValue(version, f) && version == INCREMENTAL_CACHE_VERSION &&
+        readValue(cache.settingsHash, f) &&
+        readValue(cache.emSize, f) &&
+        readValue(cache.pxRange.lower, f) && readValue(cache.pxRange.upper, f) &&
+        readValue(cache.width, f) && readValue(cache.height, f) &&
+        readValue(cache.channels, f) && readValue(cache.channelSize, f) &&
+        readValue(glyphCount, f)
+    ))
+        return false;
+    // Size of each glyph record - font, index, x, y, w, h, codepoint, hash, rotated
+    const long glyphRecordSize = (long) (6*sizeof(int)+sizeof(unicode_t)+sizeof(unsigned long long)+sizeof(byte));
+    if (!(cache.width > 0 && cache.height > 0 && cache.channels > 0 && cache.channelSize > 0 && glyphCount >= 0 && glyphCount <= (fileSize-ftell(f))/glyphRecordSize))
+        return false;
+    cache.glyphs.resize(glyphCount);
+    for (IncrementalAtlasCache::Glyph &glyph : cache.glyphs) {
+        byte rotated = 0;
+        if (!(
+            readValue(glyph.font, f) && readValue(glyph.index, f) && readValue(glyph.codepoint, f) &&
+            readValue(glyph.hash, f) &&
+            readValue(glyph.x, f) && readValue(glyph.y, f) && readValue(glyph.w, f) && readValue(glyph.h, f) &&
+            readValue(rotated, f)
+        ))
+            return false;
+        glyph.rotated = rotated != 0;
+    }
+    if (!(readValue(pixelBytes, f) && pixelBytes == (unsigned long long) cache.width*cache.height*cache.channels*cache.channelSize && pixelBytes <= (unsigned long long) (fileSize-ftell(f))))
+        return false;
+    cache.pixels.resize((size_t) pixelBytes);
+    return fread(cache.pixels.data(), 1, cache.pixels.size(), f) == cache.pixels.size();
+}
+
+bool loadIncrementalAtlasCache(IncrementalAtlasCache &cache, const char *filename) {
+    FILE *f = fopen(filename, "rb");
+    if (!f)
+        return false;
+    long fileSize = getFileSize(f);
+    bool success = fileSize >= 0 && readCache(cache, f, fileSize);
+    fclose(f);
+    if (!success) {
+        cache.glyphs.clear();
+        cache.pixels.clear();
+    }
+    return success;
+}
+
+bool saveIncrementalAtlasCache(const IncrementalAtlasCache &cache, const char *filename) {
+    FILE *f = fopen(filename, "wb");
+    if (!f)
+        return false;
+    int version = INCREMENTAL_CACHE_VERSION, glyphCount = (int) cache.glyphs.size();
+    unsigned long long pixelBytes = cache.pixels.size();
+    bool success = (
+        fwrite(INCREMENTAL_CACHE_TAG, 1, 8, f) == 8 &&
+        writeValue(version, f) &&
+        writeValue(cache.settingsHash, f) &&
+        writeValue(cache.emSize, f) &&
+        writeValue(cache.pxRange.lower, f) && writeValue(cache.pxRange.upper, f) &&
+        writeValue(cache.width, f) && writeValue(cache.height, f) &&
+        writeValue(cache.channels, f) && writeValue(cache.channelSize, f) &&
+        writeValue(glyphCount, f)
+    );
+    for (const IncrementalAtlasCache::Glyph &glyph : cache.glyphs) {
+        if (!success)
+            break;
+        byte rotated = (byte) glyph.rotated;
+        success = (
+            writeValue(glyph.font, f) && writeValue(glyph.index, f) && writeValue(glyph.codepoint, f) &&
+            writeValue(glyph.hash, f) &&
+            writeValue(glyph.x, f) && writeValue(glyph.y, f) && writeValue(glyph.w, f) && writeValue(glyph.h, f) &&
+            writeValue(rotated, f)
+        );
+    }
+    success = success && writeValue(pixelBytes, f) && fwrite(cache.pixels.data(), 1, cache.pixels.size(), f) == cache.pixels.size();
+    return fclose(f) == 0 && success;
+}
+
+int packIncrementally(std::vector<int> &changedGlyphs, GlyphGeometry *glyphs, const IncrementalAtlasCache::Glyph *keys, const int *duplicateOf, int count, const IncrementalAtlasCache &cache, int spacing, PackingAlgorithm packingAlgorithm, bool allowRotation) {
+    typedef std::tuple<int, int, unicode_t> GlyphKey;
+    std::map<GlyphKey, const IncrementalAtlasCache::Glyph *> previousGlyphs;
+    for (const IncrementalAtlasCache::Glyph &glyph : cache.glyphs)
+        previousGlyphs.insert(std::make_pair(GlyphKey(glyph.font, glyph.index, glyph.codepoint), &glyph));
+
+    // Keep unchanged glyphs in place and mark their area as occupied
+    RectanglePacker packer(cache.width+spacing, cache.height+spacing, packingAlgorithm);
+    std::vector<int> remainingGlyphs;
+    changedGlyphs.clear();
+    for (int i = 0; i < count; ++i) {
+        int w = 0, h = 0;
+        if (glyphs[i].isWhitespace() || (duplicateOf && duplicateOf[i] >= 0))
+            continue;
+        glyphs[i].getBoxSize(w, h);
+        if (!(w > 0 && h > 0))
+            continue;
+        std::map<GlyphKey, const IncrementalAtlasCache::Glyph *>::const_iterator it = previousGlyphs.find(GlyphKey(keys[i].font, keys[i].index, keys[i].codepoint));
+        if (it != previousGlyphs.end() && it->second->hash == keys[i].hash && it->second->w == w && it->second->h == h) {
+            const IncrementalAtlasCache::Glyph &previous = *it->second;
+            int atlasW = previous.rotated ? h : w, atlasH = previous.rotated ? w : h;
+            if (previous.x >= 0 && previous.y >= 0 && previous.x+atlasW <= cache.width && previous.y+atlasH <= cache.height) {
+                glyphs[i].placeBox(previous.x, previous.y, previous.rotated);
+                // Packer coordinates are top-down
+                packer.occupy(Rectangle { previous.x, cache.height-(previous.y+atlasH), atlasW+spacing, atlasH+spacing });
+                continue;
+            }
+        }
+        remainingGlyphs.push_back(i);
+    }
+
+    // Pack added and changed glyphs into the remaining space
+    int remaining = 0;
+    if (!remainingGlyphs.empty()) {
+        if (allowRotation) {
+            std::vector<OrientedRectangle> rectangles(remainingGlyphs.size());
+            for (size_t i = 0; i < remainingGlyphs.size(); ++i) {
+                glyphs[remainingGlyphs[i]].getBoxSize(rectangles[i].w, rectangles[i].h);
+                rectangles[i].w += spacing, rectangles[i].h += spacing;
+            }
+            if ((remaining = packer.pack(rectangles.data(), (int) rectangles.size())))
+                return remaining;
+            for (size_t i = 0; i < remainingGlyphs.size(); ++i) {
+                const OrientedRectangle &rect = rectangles[i];
+                if (rect.rotated)
+                    glyphs[remainingGlyphs[i]].placeBox(rect.x, cache.height-(rect.y+rect.w-spacing), true);
+                else
+                    glyphs[remainingGlyphs[i]].placeBox(rect.x, cache.height-(rect.y+rect.h-spacing));
+            }
+        } else {
+            std::vector<Rectangle> rectangles(remainingGlyphs.size());
+            for (size_t i = 0; i < remainingGlyphs.size(); ++i) {
+                rectangles[i].x = 0, rectangles[i].y = 0;
+                glyphs[remainingGlyphs[i]].getBoxSize(rectangles[i].w, rectangles[i].h);
+                rectangles[i].w += spacing, rectangles[i].h += spacing;
+            }
+            if ((remaining = packer.pack(rectangles.data(), (int) rectangles.size())))
+                return remaining;
+            for (size_t i = 0; i < remainingGlyphs.size(); ++i)
+                glyphs[remainingGlyphs[i]].placeBox(rectangles[i].x, cache.height-(rectangles[i].y+rectangles[i].h-spacing));
+        }
+    }
+    changedGlyphs = remainingGlyphs;
+
+    // Duplicate glyphs share the box of the original
+    if (duplicateOf) {
+        for (int i = 0; i < count; ++i) {
+            if (duplicateOf[i] >= 0) {
+                const GlyphGeometry &original = glyphs[duplicateOf[i]];
+                Rectangle rect = original.getBoxRect();
+                glyphs[i].placeBox(rect.x, rect.y, original.isBoxRotated());
+            }
+        }
+    }
+    return 0;
+}
+
+}
@@ -0,0 +1,57 @@
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <msdfgen.h>
+#include "types.h"
+#include "GlyphGeometry.h"
+
+namespace msdf_atlas {
+
+/**
+ * State of a previously generated atlas, which allows rebuilding it incrementally - only glyphs which were added or changed are regenerated.
+ * The cache file is meant for local use between consecutive runs and is stored in the host's byte order.
+ */
+struct IncrementalAtlasCache {
+    struct Glyph {
+        /// Index of the glyph's font in the input
+        int font;
+        int index;
+        unicode_t codepoint;
+        /// Hash of the glyph's geometry and edge colors (see hashGlyphGeometry)
+        unsigned long long hash;
+        /// Placement of the glyph's box in the atlas, w and h are the box dimensions before rotation
+        int x, y, w, h;
+        bool rotated;
+    };
+
+    /// Hash of all settings which affect the pixels of the glyphs (see hashAtlasSettings)
+    unsigned long long settingsHash;
+    double emSize;
+    msdfgen::Range pxRange;
+    int width, height;
+    int channels, channelSize;
+    std::vector<Glyph> glyphs;
+    /// Raw pixel data of the atlas storage, row by row (channels x channelSize bytes per pixel)
+    std::vector<byte> pixels;
+};
+
+/// Combines the bytes of a setting value into hash, which should start at zero
+void hashAtlasSettings(unsigned long long &hash, const void *data, size_t size);
+
+/// Loads the incremental atlas cache from a file, returns false if it doesn't exist or is invalid
+bool loadIncrementalAtlasCache(IncrementalAtlasCache &cache, const char *filename);
+/// Saves the incremental atlas cache into a file
+bool saveIncrementalAtlasCache(const IncrementalAtlasCache &cache, const char *filename);
+
+/**
+ * Places glyphs whose key (font, index, codepoint, hash) and box dimensions match a glyph of the cache at its previous position
+ * and packs the remaining ones into the free space of the cached atlas. The glyphs' boxes must already be wrapped with the cache's scale and range.
+ * keys[i] identifies glyphs[i], duplicateOf may be null or the output of findDuplicateGlyphs.
+ * Indices of glyphs which must be (re)generated are output into changedGlyphs.
+ * Returns the number of glyphs that didn't fit into the atlas (0 on success).
+ */
+int packIncrementally(std::vector<int> &changedGlyphs, GlyphGeometry *glyphs, const IncrementalAtlasCache::Glyph *keys, const int *duplicateOf, int count, const IncrementalAtlasCache &cache, int spacing, PackingAlgorithm packingAlgorithm, bool allowRotation);
+
+}
@@ -3,6 +3,7 @@
 
 #include <string>
 #include "GlyphGeometry.h"
+#include "TextFileWriter.h"
 
 namespace msdf_atlas {
 
@@ -58,122 +59,129 @@ static const char *imageTypeString(ImageType type) {
     return nullptr;
 }
 
-bool exportJSON(const FontGeometry *fonts, int fontCount, ImageType imageType, const JsonAtlasMetrics &metrics, const char *filename, bool kerning) {
-    FILE *f = fopen(filename, "w");
-    if (!f)
-        return false;
-    fputs("{", f);
+static void writeAtlas(TextFileWriter &writer, const FontGeometry *fonts, int fontCount, ImageType imageType, const JsonAtlasMetrics &metrics, bool kerning) {
+    #define WRITE_BOUNDS(first, second, l, b, r, t) { \
+        writer.writeString("{\"left\":"), writer.writeReal(l); \
+        writer.writeString(",\"" first "\":"), writer.writeReal(b); \
+        writer.writeString(",\"right\":"), writer.writeReal(r); \
+        writer.writeString(",\"" second "\":"), writer.writeReal(t); \
+        writer.writeChar('}'); \
+    }
+    writer.writeChar('{');
 
     // Atlas properties
-    fputs("\"atlas\":{", f); {
-        fprintf(f, "\"type\":\"%s\",", imageTypeString(imageType));
+    writer.writeString("\"atlas\":{"); {
+        writer.writeString("\"type\":\""), writer.writeString(imageTypeString(imageType)), writer.writeString("\",");
         if (imageType == ImageType::SDF || imageType == ImageType::PSDF || imageType == ImageType::MSDF || imageType == ImageType::MTSDF) {
-            fprintf(f, "\"distanceRange\":%.17g,", metrics.distanceRange.upper-metrics.distanceRange.lower);
-            fprintf(f, "\"distanceRangeMiddle\":%.17g,", .5*(metrics.distanceRange.lower+metrics.distanceRange.upper));
+            writer.writeString("\"distanceRange\":"), writer.writeReal(metrics.distanceRange.upper-metrics.distanceRange.lower), writer.writeChar(',');
+            writer.writeString("\"distanceRangeMiddle\":"), writer.writeReal(.5*(metrics.distanceRange.lower+metrics.distanceRange.upper)), writer.writeChar(',');
         }
-        fprintf(f, "\"size\":%.17g,", metrics.size);
-        fprintf(f, "\"width\":%d,", metrics.width);
-        fprintf(f, "\"height\":%d,", metrics.height);
-        fprintf(f, "\"yOrigin\":\"%s\"", metrics.yDirection == msdfgen::Y_DOWNWARD ? "top" : "bottom");
+        writer.writeString("\"size\":"), writer.writeReal(metrics.size), writer.writeChar(',');
+        writer.writeString("\"width\":"), writer.writeInteger(metrics.width), writer.writeChar(',');
+        writer.writeString("\"height\":"), writer.writeInteger(metrics.height), writer.writeChar(',');
+        writer.writeString(metrics.yDirection == msdfgen::Y_DOWNWARD ? "\"yOrigin\":\"top\"" : "\"yOrigin\":\"bottom\"");
         if (metrics.grid) {
-            fputs(",\"grid\":{", f);
-            fprintf(f, "\"cellWidth\":%d,", metrics.grid->cellWidth);
-            fprintf(f, "\"cellHeight\":%d,", metrics.grid->cellHeight);
-            fprintf(f, "\"columns\":%d,", metrics.grid->columns);
-            fprintf(f, "\"rows\":%d", metrics.grid->rows);
+            writer.writeString(",\"grid\":{");
+            writer.writeString("\"cellWidth\":"), writer.writeInteger(metrics.grid->cellWidth), writer.writeChar(',');
+            writer.writeString("\"cellHeight\":"), writer.writeInteger(metrics.grid->cellHeight), writer.writeChar(',');
+            writer.writeString("\"columns\":"), writer.writeInteger(metrics.grid->columns), writer.writeChar(',');
+            writer.writeString("\"rows\":"), writer.writeInteger(metrics.grid->rows);
             if (metrics.grid->originX)
-                fprintf(f, ",\"originX\":%.17g", *metrics.grid->originX);
+                writer.writeString(",\"originX\":"), writer.writeReal(*metrics.grid->originX);
             if (metrics.grid->originY) {
                 switch (metrics.yDirection) {
                     case msdfgen::Y_UPWARD:
-                        fprintf(f, ",\"originY\":%.17g", *metrics.grid->originY);
+                        writer.writeString(",\"originY\":"), writer.writeReal(*metrics.grid->originY);
                         break;
                     case msdfgen::Y_DOWNWARD:
-                        fprintf(f, ",\"originY\":%.17g", (metrics.grid->cellHeight-metrics.grid->spacing-1)/metrics.size-*metrics.grid->originY);
+                        writer.writeString(",\"originY\":"), writer.writeReal((metrics.grid->cellHeight-metrics.grid->spacing-1)/metrics.size-*metrics.grid->originY);
                         break;
                 }
             }
-            fputs("}", f);
+            writer.writeChar('}');
         }
-    } fputs("},", f);
+    } writer.writeString("},");
 
     if (fontCount > 1)
-        fputs("\"variants\":[", f);
+        writer.writeString("\"variants\":[");
     for (int i = 0; i < fontCount; ++i) {
         const FontGeometry &font = fonts[i];
         if (fontCount > 1)
-            fputs(i == 0 ? "{" : ",{", f);
+            writer.writeString(i == 0 ? "{" : ",{");
 
         // Font name
         const char *name = font.getName();
         if (name)
-            fprintf(f, "\"name\":\"%s\",", escapeJsonString(name).c_str());
+            writer.writeString("\"name\":\""), writer.writeString(escapeJsonString(name).c_str()), writer.writeString("\",");
 
         // Font metrics
-        fputs("\"metrics\":{", f); {
+        writer.writeString("\"metrics\":{"); {
             double yFactor = metrics.yDirection == msdfgen::Y_DOWNWARD ? -1 : 1;
             const msdfgen::FontMetrics &fontMetrics = font.getMetrics();
-            fprintf(f, "\"emSize\":%.17g,", fontMetrics.emSize);
-            fprintf(f, "\"lineHeight\":%.17g,", fontMetrics.lineHeight);
-            fprintf(f, "\"ascender\":%.17g,", yFactor*fontMetrics.ascenderY);
-            fprintf(f, "\"descender\":%.17g,", yFactor*fontMetrics.descenderY);
-            fprintf(f, "\"underlineY\":%.17g,", yFactor*fontMetrics.underlineY);
-            fprintf(f, "\"underlineThickness\":%.17g", fontMetrics.underlineThickness);
-        } fputs("},", f);
+            writer.writeString("\"emSize\":"), writer.writeReal(fontMetrics.emSize), writer.writeChar(',');
+            writer.writeString("\"lineHeight\":"), writer.writeReal(fontMetrics.lineHeight), writer.writeChar(',');
+            writer.writeString("\"ascender\":"), writer.writeReal(yFactor*fontMetrics.ascenderY), writer.writeChar(',');
+            writer.writeString("\"descender\":"), writer.writeReal(yFactor*fontMetrics.descenderY), writer.writeChar(',');
+            writer.writeString("\"underlineY\":"), writer.writeReal(yFactor*fontMetrics.underlineY), writer.writeChar(',');
+            writer.writeString("\"underlineThickness\":"), writer.writeReal(fontMetrics.underlineThickness);
+        } writer.writeString("},");
 
         // Glyph mapping
-        fputs("\"glyphs\":[", f);
+        writer.writeString("\"glyphs\":[");
         bool firstGlyph = true;
         for (const GlyphGeometry &glyph : font.getGlyphs()) {
-            fputs(firstGlyph ? "{" : ",{", f);
+            writer.writeString(firstGlyph ? "{" : ",{");
             switch (font.getPreferredIdentifierType()) {
                 case GlyphIdentifierType::GLYPH_INDEX:
-                    fprintf(f, "\"index\":%d,", glyph.getIndex());
+                    writer.writeString("\"index\":"), writer.writeInteger(glyph.getIndex()), writer.writeChar(',');
                     break;
                 case GlyphIdentifierType::UNICODE_CODEPOINT:
-                    fprintf(f, "\"unicode\":%u,", glyph.getCodepoint());
+                    writer.writeString("\"unicode\":"), writer.writeInteger(glyph.getCodepoint()), writer.writeChar(',');
                     break;
             }
-            fprintf(f, "\"advance\":%.17g", glyph.getAdvance());
+            writer.writeString("\"advance\":"), writer.writeReal(glyph.getAdvance());
             double l, b, r, t;
             glyph.getQuadPlaneBounds(l, b, r, t);
             if (l || b || r || t) {
+                writer.writeString(",\"planeBounds\":");
                 switch (metrics.yDirection) {
                     case msdfgen::Y_UPWARD:
-                        fprintf(f, ",\"planeBounds\":{\"left\":%.17g,\"bottom\":%.17g,\"right\":%.17g,\"top\":%.17g}", l, b, r, t);
+                        WRITE_BOUNDS("bottom", "top", l, b, r, t);
                         break;
                     case msdfgen::Y_DOWNWARD:
-                        fprintf(f, ",\"planeBounds\":{\"left\":%.17g,\"top\":%.17g,\"right\":%.17g,\"bottom\":%.17g}", l, -t, r, -b);
+                        WRITE_BOUNDS("top", "bottom", l, -t, r, -b);
                         break;
                 }
             }
             glyph.getQuadAtlasBounds(l, b, r, t);
             if (l || b || r || t) {
+                writer.writeString(",\"atlasBounds\":");
                 switch (metrics.yDirection) {
                     case msdfgen::Y_UPWARD:
-                        fprintf(f, ",\"atlasBounds\":{\"left\":%.17g,\"bottom\":%.17g,\"right\":%.17g,\"top\":%.17g}", l, b, r, t);
+                        WRITE_BOUNDS("bottom", "top", l, b, r, t);
                         break;
                     case msdfgen::Y_DOWNWARD:
-                        fprintf(f, ",\"atlasBounds\":{\"left\":%.17g,\"top\":%.17g,\"right\":%.17g,\"bottom\":%.17g}", l, metrics.height-t, r, metrics.height-b);
+                        WRITE_BOUNDS("top", "bottom", l, metrics.height-t, r, metrics.height-b);
                         break;
                 }
             }
-            fputs("}", f);
+            if (glyph.isBoxRotated())
+                writer.writeString(",\"rotated\":true");
+            writer.writeChar('}');
             firstGlyph = false;
-        } fputs("]", f);
+        } writer.writeChar(']');
 
         // Kerning pairs
         if (kerning) {
-            fputs(",\"kerning\":[", f);
+            writer.writeString(",\"kerning\":[");
             bool firstPair = true;
             switch (font.getPreferredIdentifierType()) {
                 case GlyphIdentifierType::GLYPH_INDEX:
                     for (const std::pair<std::pair<int, int>, double> &kernPair : font.getKerning()) {
-                        fputs(firstPair ? "{" : ",{", f);
-                        fprintf(f, "\"index1\":%d,", kernPair.first.first);
-                        fprintf(f, "\"index2\":%d,", kernPair.first.second);
-                        fprintf(f, "\"advance\":%.17g", kernPair.second);
-                        fputs("}", f);
+                        writer.writeString(firstPair ? "{\"index1\":" : ",{\"index1\":"), writer.writeInteger(kernPair.first.first);
+                        writer.writeString(",\"index2\":"), writer.writeInteger(kernPair.first.second);
+                        writer.writeString(",\"advance\":"), writer.writeReal(kernPair.second);
+                        writer.writeChar('}');
                         firstPair = false;
                     }
                     break;
@@ -182,27 +190,54 @@ bool exportJSON(const FontGeometry *fonts, int fontCount, ImageType imageType, c
                         const GlyphGeometry *glyph1 = font.getGlyph(msdfgen::GlyphIndex(kernPair.first.first));
                         const GlyphGeometry *glyph2 = font.getGlyph(msdfgen::GlyphIndex(kernPair.first.second));
                         if (glyph1 && glyph2 && glyph1->getCodepoint() && glyph2->getCodepoint()) {
-                            fputs(firstPair ? "{" : ",{", f);
-                            fprintf(f, "\"unicode1\":%u,", glyph1->getCodepoint());
-                            fprintf(f, "\"unicode2\":%u,", glyph2->getCodepoint());
-                            fprintf(f, "\"advance\":%.17g", kernPair.second);
-                            fputs("}", f);
+                            writer.writeString(firstPair ? "{\"unicode1\":" : ",{\"unicode1\":"), writer.writeInteger(glyph1->getCodepoint());
+                            writer.writeString(",\"unicode2\":"), writer.writeInteger(glyph2->getCodepoint());
+                            writer.writeString(",\"advance\":"), writer.writeReal(kernPair.second);
+                            writer.writeChar('}');
                             firstPair = false;
                         }
                     }
                     break;
-            } fputs("]", f);
+            } writer.writeChar(']');
         }
 
         if (fontCount > 1)
-            fputs("}", f);
+            writer.writeChar('}');
     }
     if (fontCount > 1)
-        fputs("]", f);
+        writer.writeChar(']');
 
-    fputs("}\n", f);
-    fclose(f);
-    return true;
+    writer.writeChar('}');
+    #undef WRITE_BOUNDS
+}
+
+bool exportJSON(const FontGeometry *fonts, int fontCount, ImageType imageType, const JsonAtlasMetrics &metrics, const char *filename, bool kerning, bool compactPrecision) {
+    FILE *f = fopen(filename, "w");
+    if (!f)
+        return false;
+    TextFileWriter writer(f);
+    writer.setCompactPrecision(compactPrecision);
+    writeAtlas(writer, fonts, fontCount, imageType, metrics, kerning);
+    writer.writeChar('\n');
+    bool success = writer.flush();
+    return fclose(f) == 0 && success;
+}
+
+bool exportJSONAtlasSet(const JsonAtlasSetEntry *atlases, int atlasCount, ImageType imageType, const char *filename, bool kerning, bool compactPrecision) {
+    FILE *f = fopen(filename, "w");
+    if (!f)
+        return false;
+    TextFileWriter writer(f);
+    writer.setCompactPrecision(compactPrecision);
+    writer.writeString("{\"atlases\":[");
+    for (int i = 0; i < atlasCount; ++i) {
+        if (i)
+            writer.writeChar(',');
+        writeAtlas(writer, atlases[i].fonts, atlases[i].fontCount, imageType, atlases[i].metrics, kerning);
+    }
+    writer.writeString("]}\n");
+    bool success = writer.flush();
+    return fclose(f) == 0 && success;
 }
 
 }
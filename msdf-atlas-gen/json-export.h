@@ -22,7 +22,17 @@ struct JsonAtlasMetrics {
     const GridMetrics *grid;
 };
 
-/// Writes the font and glyph metrics and atlas layout data into a comprehensive JSON file
-bool exportJSON(const FontGeometry *fonts, int fontCount, ImageType imageType, const JsonAtlasMetrics &metrics, const char *filename, bool kerning);
+/// Writes the font and glyph metrics and atlas layout data into a comprehensive JSON file, compactPrecision limits real numbers to single precision
+bool exportJSON(const FontGeometry *fonts, int fontCount, ImageType imageType, const JsonAtlasMetrics &metrics, const char *filename, bool kerning, bool compactPrecision = false);
+
+/// One of multiple atlases written into a single JSON file by exportJSONAtlasSet
+struct JsonAtlasSetEntry {
+    const FontGeometry *fonts;
+    int fontCount;
+    JsonAtlasMetrics metrics;
+};
+
+/// Writes multiple atlases (e.g. of the same glyphs in different sizes) into a single JSON file as an "atlases" array of objects in the format of exportJSON
+bool exportJSONAtlasSet(const JsonAtlasSetEntry *atlases, int atlasCount, ImageType imageType, const char *filename, bool kerning, bool compactPrecision = false);
 
 }
@@ -14,7 +14,12 @@
 #include <cassert>
 #include <vector>
 #include <algorithm>
+#include <string>
+#include <map>
+#include <memory>
 #include <thread>
+#include <mutex>
+#include <chrono>
 
 #include "msdf-atlas-gen.h"
 
@@ -26,8 +31,7 @@ using namespace msdf_atlas;
 #define DEFAULT_PIXEL_RANGE 2.0
 #define SDF_ERROR_ESTIMATE_PRECISION 19
 #define GLYPH_FILL_RULE msdfgen::FILL_NONZERO
-#define LCG_MULTIPLIER 6364136223846793005ull
-#define LCG_INCREMENT 1442695040888963407ull
+#define GLYPH_PROFILE_SUMMARY_LENGTH 10
 
 #define STRINGIZE_(x) #x
 #define STRINGIZE(x) STRINGIZE_(x)
@@ -87,9 +91,9 @@ ATLAS CONFIGURATION
       Selects the type of atlas to be generated.
 )"
 #ifndef MSDFGEN_DISABLE_PNG
-R"(  -format <png / bmp / tiff / rgba / fl32 / text / textfloat / bin / binfloat / binfloatbe>)"
+R"(  -format <png / bmp / tiff / rgba / fl32 / text / textfloat / bin / binfloat / binfloatbe / tiffhalf / binhalf / png16 / tiff16>)"
 #else
-R"(  -format <bmp / tiff / rgba / fl32 / text / textfloat / bin / binfloat / binfloatbe>)"
+R"(  -format <bmp / tiff / rgba / fl32 / text / textfloat / bin / binfloat / binfloatbe / tiffhalf / binhalf / tiff16>)"
 #endif
 R"(
       Selects the format for the atlas image output. Some image formats may be incompatible with embedded output formats.
@@ -98,6 +102,14 @@ R"(
   -pots / -potr / -square / -square2 / -square4
       Picks the minimum atlas dimensions that fit all glyphs and satisfy the selected constraint:
       power of two square / ... rectangle / any square / square with side divisible by 2 / ... 4
+  -packer <guillotine / maxrects / skyline / shelf>
+      Selects the rectangle packing algorithm. Maxrects is the densest but slowest, shelf is the fastest.
+  -rotate
+      Allows glyphs to be rotated by 90 degrees counter-clockwise in the atlas for denser packing.
+  -dedup
+      Glyphs with identical outlines (e.g. multiple characters mapped to the same glyph) share a single box in the atlas.
+  -incremental <cache file>
+      Reuses the atlas stored in the cache file by a previous run and only generates glyphs that were added or changed.
   -uniformgrid
       Lays out the atlas into a uniform grid. Enables following options starting with -uniform:
     -uniformcols <N>
@@ -114,24 +126,36 @@ R"(
 OUTPUT SPECIFICATION - one or more can be specified
   -imageout <filename.*>
       Saves the atlas as an image file with the specified format. Layout data must be stored separately.
+  -typeout <hardmask / softmask / sdf / psdf / msdf / mtsdf> <filename.*>
+      Saves an additional atlas of a different type with the same layout and image format. Can be repeated.
   -json <filename.json>
       Writes the atlas's layout data, as well as other metrics into a structured JSON file.
   -csv <filename.csv>
-      Writes the layout data of the glyphs into a simple CSV file.)"
+      Writes the layout data of the glyphs into a simple CSV file.
+  -binmetrics <filename.bin>
+      Writes the metrics, layout data and kerning into a binary file that can be used in place without parsing.
+  -compactmetrics
+      Writes real numbers into JSON and CSV files with only as many digits as single precision requires.)"
 #ifndef MSDF_ATLAS_NO_ARTERY_FONT
 R"(
   -arfont <filename.arfont>
-      Stores the atlas and its layout data as an Artery Font file. Supported formats: png, bin, binfloat.)"
+      Stores the atlas and its layout data as an Artery Font file. Supported formats: png, png16, bin, binfloat.)"
 #endif
 R"(
   -shadronpreview <filename.shadron> <sample text>
       Generates a Shadron script that uses the generated atlas to draw a sample text as a preview.
+  -glyphprofile <filename.csv>
+      Writes the generation time, error correction time, edge count and box size of each glyph into a CSV file
+      and lists the slowest glyphs.
 
 GLYPH CONFIGURATION
   -size <em size>
       Specifies the size of the glyphs in the atlas bitmap in pixels per em.
   -minsize <em size>
       Specifies the minimum size. The largest possible size that fits the same atlas dimensions will be used.
+  -sizes <em size>,<em size>,...
+      Generates a separate atlas for each size from the same glyph geometry. Output file names get the size appended,
+      except for the JSON file, which lists all atlases. Use -smallsizesfirst to start with the smallest sizes.
   -emrange <em range width>
       Specifies the width of the representable SDF distance range in ems.
   -pxrange <pixel range width>
@@ -184,10 +208,25 @@ R"(
       Disables the scanline pass, which corrects the distance field's signs according to the non-zero fill rule.)"
 #endif
 R"(
+  -adaptive
+      Reduces the scanline pass and error correction of each glyph according to its complexity. Speeds up generation of simple glyphs.
+  -sparse
+      Computes distances only near the glyph's edges and fills the rest of its box with the saturated value. Speeds up large glyphs with small range.
+  -edgeindex
+      Computes the distances in each part of glyphs with many edges from only the nearby edges. Requires overlap support to be disabled.
   -seed <N>
-      Sets the initial seed for the edge coloring heuristic.
+      Sets the initial seed for the edge coloring heuristic. Each glyph's seed is derived from it and the glyph's index.
+  -legacyseed
+      Derives glyph seeds in the order of glyphs like older versions, which reproduces their edge coloring exactly.
+  -coloringcache <cache file>
+      Reuses edge colors of unchanged glyphs stored in the cache file by a previous run and updates it.
   -threads <N>
       Sets the number of threads for the parallel computation. (0 = auto)
+  -batch <jobs file>
+      Runs the jobs listed in the file concurrently, each specified on a separate line by its own arguments.
+      Other arguments apply to all jobs, -threads sets the number of jobs that run at the same time.
+  -stats <filename.json>
+      Writes the time spent in each stage and the numbers of glyphs, edges, pixels and bytes it processed into a JSON file.
 )";
 
 static const char *errorCorrectionHelpText = R"(
@@ -217,17 +256,17 @@ static char toupper(char c) {
 }
 
 static bool parseUnsigned(unsigned &value, const char *arg) {
-    static char c;
+    char c;
     return sscanf(arg, "%u%c", &value, &c) == 1;
 }
 
 static bool parseUnsignedLL(unsigned long long &value, const char *arg) {
-    static char c;
+    char c;
     return sscanf(arg, "%llu%c", &value, &c) == 1;
 }
 
 static bool parseDouble(double &value, const char *arg) {
-    static char c;
+    char c;
     return sscanf(arg, "%lf%c", &value, &c) == 1;
 }
 
@@ -282,6 +321,55 @@ static msdfgen::FontHandle *loadVarFont(msdfgen::FreetypeHandle *library, const
 }
 #endif
 
+/// Keeps the loaded font files open so that each is only loaded once
+class FontHolder {
+
+public:
+    FontHolder() : ft(msdfgen::initializeFreetype()), font(nullptr) { }
+    ~FontHolder() {
+        if (ft) {
+            for (const std::pair<const std::pair<std::string, bool>, msdfgen::FontHandle *> &loadedFont : fonts) {
+                if (loadedFont.second)
+                    msdfgen::destroyFont(loadedFont.second);
+            }
+            msdfgen::deinitializeFreetype(ft);
+        }
+    }
+    /// Selects the font from fontFilename as current, loading it if it hasn't been yet
+    bool load(const char *fontFilename, bool isVarFont) {
+        font = nullptr;
+        if (ft && fontFilename) {
+            msdfgen::FontHandle *&loadedFont = fonts[std::make_pair(std::string(fontFilename), isVarFont)];
+            if (!loadedFont) {
+                loadedFont = (
+                    #ifndef MSDFGEN_DISABLE_VARIABLE_FONTS
+                        isVarFont ? loadVarFont(ft, fontFilename) :
+                    #endif
+                    msdfgen::loadFont(ft, fontFilename)
+                );
+            }
+            font = loadedFont;
+        }
+        return font != nullptr;
+    }
+    operator msdfgen::FontHandle *() const {
+        return font;
+    }
+
+private:
+    msdfgen::FreetypeHandle *ft;
+    std::map<std::pair<std::string, bool>, msdfgen::FontHandle *> fonts;
+    msdfgen::FontHandle *font;
+
+};
+
+/// Resources shared by the jobs of a batch (see -batch)
+struct BatchResources {
+    FontHolder fonts;
+    /// Guards fonts, which must not be used by multiple jobs at once
+    std::mutex fontMutex;
+};
+
 enum class Units {
     /// Value is specified in ems
     EMS,
@@ -299,6 +387,12 @@ struct FontInput {
     const char *fontName;
 };
 
+/// An additional atlas image of a different type with the same layout (see -typeout)
+struct AdditionalAtlasOutput {
+    ImageType imageType;
+    const char *imageFilename;
+};
+
 struct Configuration {
     ImageType imageType;
     ImageFormat imageFormat;
@@ -317,6 +411,8 @@ struct Configuration {
     void (*edgeColoring)(msdfgen::Shape &, double, unsigned long long);
     bool expensiveColoring;
     unsigned long long coloringSeed;
+    /// Chains glyph seeds in the order of glyphs (or derives them from their order for expensive coloring) like older versions
+    bool legacyColoringSeed;
     GeneratorAttributes generatorAttributes;
     bool preprocessGeometry;
     bool kerning;
@@ -325,21 +421,144 @@ struct Configuration {
     const char *imageFilename;
     const char *jsonFilename;
     const char *csvFilename;
+    const char *binaryMetricsFilename;
     const char *shadronPreviewFilename;
     const char *shadronPreviewText;
+    const char *glyphProfileFilename;
+    std::vector<AdditionalAtlasOutput> additionalOutputs;
 };
 
+template <typename T, int N, int M>
+static msdfgen::Bitmap<T, M> extractChannels(const msdfgen::BitmapConstSection<T, N> &bitmap, int firstChannel) {
+    msdfgen::Bitmap<T, M> channels(bitmap.width, bitmap.height, bitmap.yOrientation);
+    for (int y = 0; y < bitmap.height; ++y) {
+        for (int x = 0; x < bitmap.width; ++x) {
+            const T *src = bitmap(x, y)+firstChannel;
+            T *dst = channels(x, y);
+            for (int i = 0; i < M; ++i)
+                dst[i] = src[i];
+        }
+    }
+    return channels;
+}
+
+/// Lists the glyphs that took the longest to generate
+static void printGlyphProfileSummary(std::vector<GlyphProfile> profile) {
+    if (profile.empty())
+        return;
+    double totalTime = 0;
+    for (const GlyphProfile &glyphProfile : profile)
+        totalTime += glyphProfile.time;
+    double averageTime = totalTime/profile.size();
+    size_t listed = std::min(profile.size(), (size_t) GLYPH_PROFILE_SUMMARY_LENGTH);
+    std::partial_sort(profile.begin(), profile.begin()+listed, profile.end(), [](const GlyphProfile &a, const GlyphProfile &b) {
+        return a.time > b.time;
+    });
+    fprintf(stderr, "Generated %d glyphs in %.3f ms (%.3f ms per glyph on average), slowest glyphs:\n", (int) profile.size(), 1e3*totalTime, 1e3*averageTime);
+    for (size_t i = 0; i < listed; ++i) {
+        const GlyphProfile &glyphProfile = profile[i];
+        if (glyphProfile.codepoint)
+            fprintf(stderr, "  U+%04X (index %d): ", glyphProfile.codepoint, glyphProfile.index);
+        else
+            fprintf(stderr, "  index %d: ", glyphProfile.index);
+        fprintf(stderr, "%.3f ms (%.1fx average), error correction %.3f ms, %d edges, %d pixels\n", 1e3*glyphProfile.time, averageTime > 0 ? glyphProfile.time/averageTime : 0, 1e3*glyphProfile.errorCorrectionTime, glyphProfile.edgeCount, glyphProfile.pixelCount);
+    }
+}
+
 template <typename T, typename S, int N, GeneratorFunction<S, N> GEN_FN>
-static bool makeAtlas(const std::vector<GlyphGeometry> &glyphs, const std::vector<FontGeometry> &fonts, const Configuration &config) {
+static bool saveAdditionalAtlas(const std::vector<GlyphGeometry> &glyphs, const Configuration &config, const char *filename) {
     ImmediateAtlasGenerator<S, N, GEN_FN, BitmapAtlasStorage<T, N> > generator(config.width, config.height);
     generator.setAttributes(config.generatorAttributes);
     generator.setThreadCount(config.threadCount);
     generator.generate(glyphs.data(), glyphs.size());
     msdfgen::BitmapConstSection<T, N> bitmap = (msdfgen::BitmapConstSection<T, N>) generator.atlasStorage();
     bitmap.reorient(config.yDirection);
+    return saveImage(bitmap, config.imageFormat, filename);
+}
+
+/// Saves an additional atlas type - split from the channels of the main atlas if they contain it, otherwise generated with the same layout
+template <typename T, int N>
+static bool saveAdditionalAtlas(const msdfgen::BitmapConstSection<T, N> &atlas, const std::vector<GlyphGeometry> &glyphs, const Configuration &config, const AdditionalAtlasOutput &output) {
+    if (output.imageType == config.imageType)
+        return saveImage(atlas, config.imageFormat, output.imageFilename);
+    if (config.imageType == ImageType::MTSDF) {
+        // MTSDF consists of the MSDF channels and the true SDF in alpha
+        if (output.imageType == ImageType::MSDF) {
+            const msdfgen::Bitmap<T, 3> msdf = extractChannels<T, N, 3>(atlas, 0);
+            return saveImage(msdfgen::BitmapConstSection<T, 3>(msdf), config.imageFormat, output.imageFilename);
+        }
+        if (output.imageType == ImageType::SDF) {
+            const msdfgen::Bitmap<T, 1> sdf = extractChannels<T, N, 1>(atlas, 3);
+            return saveImage(msdfgen::BitmapConstSection<T, 1>(sdf), config.imageFormat, output.imageFilename);
+        }
+    }
+    switch (output.imageType) {
+        case ImageType::HARD_MASK:
+            return saveAdditionalAtlas<T, float, 1, scanlineGenerator>(glyphs, config, output.imageFilename);
+        case ImageType::SOFT_MASK:
+            return saveAdditionalAtlas<T, float, 1, softMaskGenerator>(glyphs, config, output.imageFilename);
+        case ImageType::SDF:
+            return saveAdditionalAtlas<T, float, 1, sdfGenerator>(glyphs, config, output.imageFilename);
+        case ImageType::PSDF:
+            return saveAdditionalAtlas<T, float, 1, psdfGenerator>(glyphs, config, output.imageFilename);
+        case ImageType::MSDF:
+            return saveAdditionalAtlas<T, float, 3, msdfGenerator>(glyphs, config, output.imageFilename);
+        case ImageType::MTSDF:
+            return saveAdditionalAtlas<T, float, 4, mtsdfGenerator>(glyphs, config, output.imageFilename);
+    }
+    return false;
+}
+
+struct IncrementalBuild {
+    IncrementalAtlasCache cache;
+    /// If the cached atlas is reused, only changedGlyphs are generated into it
+    bool reuseCache;
+    std::vector<int> changedGlyphs;
+};
+
+template <typename T, typename S, int N, GeneratorFunction<S, N> GEN_FN>
+static bool makeAtlas(const std::vector<GlyphGeometry> &glyphs, const std::vector<FontGeometry> &fonts, const Configuration &config, IncrementalBuild *incremental) {
+    // An incremental build starts from the previous atlas and only generates the changed glyphs
+    bool reuseCache = incremental && incremental->reuseCache && incremental->cache.pixels.size() == sizeof(T)*N*config.width*config.height;
+    msdfgen::BitmapConstSection<T, N> previousAtlas;
+    if (reuseCache)
+        previousAtlas = msdfgen::BitmapConstSection<T, N>(reinterpret_cast<const T *>(incremental->cache.pixels.data()), config.width, config.height);
+    ImmediateAtlasGenerator<S, N, GEN_FN, BitmapAtlasStorage<T, N> > generator(config.width, config.height, previousAtlas);
+    generator.setAttributes(config.generatorAttributes);
+    generator.setThreadCount(config.threadCount);
+    generator.setProfiling(config.glyphProfileFilename != nullptr);
+    if (reuseCache) {
+        std::vector<GlyphGeometry> changedGlyphs;
+        changedGlyphs.reserve(incremental->changedGlyphs.size());
+        for (int i : incremental->changedGlyphs)
+            changedGlyphs.push_back(glyphs[i]);
+        generator.generate(changedGlyphs.data(), changedGlyphs.size());
+    } else
+        generator.generate(glyphs.data(), glyphs.size());
+    msdfgen::BitmapConstSection<T, N> bitmap = (msdfgen::BitmapConstSection<T, N>) generator.atlasStorage();
+    if (incremental) {
+        IncrementalAtlasCache &cache = incremental->cache;
+        size_t rowSize = sizeof(T)*N*bitmap.width;
+        cache.channels = N, cache.channelSize = sizeof(T);
+        cache.pixels.resize(rowSize*bitmap.height);
+        for (int y = 0; y < bitmap.height; ++y)
+            memcpy(cache.pixels.data()+rowSize*y, bitmap(0, y), rowSize);
+    }
+    bitmap.reorient(config.yDirection);
 
     bool success = true;
 
+    if (config.glyphProfileFilename) {
+        const std::vector<GlyphProfile> &profile = generator.getProfile();
+        if (exportGlyphProfileCSV(profile.data(), profile.size(), config.glyphProfileFilename)) {
+            fputs("Glyph generation profile written into CSV file.\n", stderr);
+            printGlyphProfileSummary(profile);
+        } else {
+            success = false;
+            fputs("Failed to write glyph profile file.\n", stderr);
+        }
+    }
+
     if (config.imageFilename) {
         if (saveImage(bitmap, config.imageFormat, config.imageFilename))
             fputs("Atlas image file saved.\n", stderr);
@@ -365,10 +584,69 @@ static bool makeAtlas(const std::vector<GlyphGeometry> &glyphs, const std::vecto
     }
 #endif
 
+    for (const AdditionalAtlasOutput &output : config.additionalOutputs) {
+        if (saveAdditionalAtlas(bitmap, glyphs, config, output))
+            fputs("Additional atlas image file saved.\n", stderr);
+        else {
+            success = false;
+            fputs("Failed to save an additional atlas as an image file.\n", stderr);
+        }
+    }
+
     return success;
 }
 
-int main(int argc, const char *const *argv) {
+/// Generates the atlas of config.imageType with atlas pixels of type T and saves its image outputs
+template <typename T>
+static bool makeAtlasOfPixelType(const std::vector<GlyphGeometry> &glyphs, const std::vector<FontGeometry> &fonts, const Configuration &config, IncrementalBuild *incremental) {
+    switch (config.imageType) {
+        case ImageType::HARD_MASK:
+            return makeAtlas<T, float, 1, scanlineGenerator>(glyphs, fonts, config, incremental);
+        case ImageType::SOFT_MASK:
+            return makeAtlas<T, float, 1, softMaskGenerator>(glyphs, fonts, config, incremental);
+        case ImageType::SDF:
+            return makeAtlas<T, float, 1, sdfGenerator>(glyphs, fonts, config, incremental);
+        case ImageType::PSDF:
+            return makeAtlas<T, float, 1, psdfGenerator>(glyphs, fonts, config, incremental);
+        case ImageType::MSDF:
+            return makeAtlas<T, float, 3, msdfGenerator>(glyphs, fonts, config, incremental);
+        case ImageType::MTSDF:
+            return makeAtlas<T, float, 4, mtsdfGenerator>(glyphs, fonts, config, incremental);
+    }
+    return false;
+}
+
+/// Generates the atlas of config.imageType and saves its image outputs, floatingPointFormat selects floating-point pixel storage, halfFormat half-precision, uint16Format 16-bit integer
+static bool makeAtlas(const std::vector<GlyphGeometry> &glyphs, const std::vector<FontGeometry> &fonts, const Configuration &config, bool floatingPointFormat, bool halfFormat, bool uint16Format, IncrementalBuild *incremental) {
+    if (halfFormat)
+        return makeAtlasOfPixelType<half>(glyphs, fonts, config, incremental);
+    if (uint16Format)
+        return makeAtlasOfPixelType<uint16_t>(glyphs, fonts, config, incremental);
+    if (floatingPointFormat)
+        return makeAtlasOfPixelType<float>(glyphs, fonts, config, incremental);
+    return makeAtlasOfPixelType<byte>(glyphs, fonts, config, incremental);
+}
+
+/// Inserts the em size before the file name's extension, e.g. atlas.png -> atlas-32.png
+static std::string sizeFilename(const char *filename, double emSize) {
+    const char *extension = nullptr;
+    for (const char *c = filename; *c; ++c) {
+        if (*c == '.')
+            extension = c;
+        else if (*c == '/' || *c == '\\')
+            extension = nullptr;
+    }
+    char sizeString[32];
+    sprintf(sizeString, "-%.9g", emSize);
+    std::string sizedFilename(filename, extension ? extension-filename : strlen(filename));
+    sizedFilename += sizeString;
+    if (extension)
+        sizedFilename += extension;
+    return sizedFilename;
+}
+
+/// Runs a single job specified by command line arguments, batch is null unless the job is part of a batch
+static int runJob(int argc, const char *const *argv, BatchResources *batch) {
     #define ABORT(msg) do { fputs(msg "\n", stderr); return 1; } while (false)
 
     int result = 0;
@@ -396,6 +674,8 @@ int main(int argc, const char *const *argv) {
     config.generatorAttributes.config.overlapSupport = !config.preprocessGeometry;
     config.generatorAttributes.scanlinePass = !config.preprocessGeometry;
     double minEmSize = 0;
+    std::vector<double> emSizes;
+    bool smallSizesFirst = false;
     Units rangeUnits = Units::PIXELS;
     msdfgen::Range rangeValue = 0;
     Padding innerPadding;
@@ -404,11 +684,18 @@ int main(int argc, const char *const *argv) {
     Units outerPaddingUnits = Units::EMS;
     PackingStyle packingStyle = PackingStyle::TIGHT;
     DimensionsConstraint atlasSizeConstraint = DimensionsConstraint::NONE;
+    PackingAlgorithm packingAlgorithm = PackingAlgorithm::GUILLOTINE;
+    bool allowRotation = false;
+    bool deduplicateGlyphs = false;
+    const char *incrementalCacheFilename = nullptr;
+    const char *coloringCacheFilename = nullptr;
+    bool compactMetrics = false;
     DimensionsConstraint cellSizeConstraint = DimensionsConstraint::NONE;
     config.angleThreshold = DEFAULT_ANGLE_THRESHOLD;
     config.miterLimit = DEFAULT_MITER_LIMIT;
     config.pxAlignOriginX = false, config.pxAlignOriginY = true;
-    config.threadCount = 0;
+    // Jobs of a batch run concurrently, so each is single-threaded by default
+    config.threadCount = batch ? 1 : 0;
 
     // Parse command line
     int argPos = 1;
@@ -447,6 +734,8 @@ int main(int argc, const char *const *argv) {
             #ifndef MSDFGEN_DISABLE_PNG
                 if (ARG_IS("png"))
                     config.imageFormat = ImageFormat::PNG;
+                else if (ARG_IS("png16"))
+                    config.imageFormat = ImageFormat::PNG16;
                 else
             #endif
             if (ARG_IS("bmp"))
@@ -467,11 +756,17 @@ int main(int argc, const char *const *argv) {
                 config.imageFormat = ImageFormat::BINARY_FLOAT;
             else if (ARG_IS("binfloatbe"))
                 config.imageFormat = ImageFormat::BINARY_FLOAT_BE;
+            else if (ARG_IS("tiffhalf") || ARG_IS("tifhalf"))
+                config.imageFormat = ImageFormat::TIFF_HALF;
+            else if (ARG_IS("binhalf"))
+                config.imageFormat = ImageFormat::BINARY_HALF;
+            else if (ARG_IS("tiff16") || ARG_IS("tif16"))
+                config.imageFormat = ImageFormat::TIFF16;
             else {
                 #ifndef MSDFGEN_DISABLE_PNG
-                    ABORT("Invalid image format. Valid formats are: png, bmp, tiff, rgba, fl32, text, textfloat, bin, binfloat, binfloatbe");
+                    ABORT("Invalid image format. Valid formats are: png, bmp, tiff, rgba, fl32, text, textfloat, bin, binfloat, binfloatbe, tiffhalf, binhalf, png16, tiff16");
                 #else
-                    ABORT("Invalid image format. Valid formats are: bmp, tiff, rgba, fl32, text, textfloat, bin, binfloat, binfloatbe");
+                    ABORT("Invalid image format. Valid formats are: bmp, tiff, rgba, fl32, text, textfloat, bin, binfloat, binfloatbe, tiffhalf, binhalf, tiff16");
                 #endif
             }
             imageFormatName = arg;
@@ -550,6 +845,27 @@ int main(int argc, const char *const *argv) {
             config.imageFilename = argv[argPos++];
             continue;
         }
+        ARG_CASE("-typeout", 2) {
+            AdditionalAtlasOutput output = { };
+            if (ARG_IS("hardmask"))
+                output.imageType = ImageType::HARD_MASK;
+            else if (ARG_IS("softmask"))
+                output.imageType = ImageType::SOFT_MASK;
+            else if (ARG_IS("sdf"))
+                output.imageType = ImageType::SDF;
+            else if (ARG_IS("psdf"))
+                output.imageType = ImageType::PSDF;
+            else if (ARG_IS("msdf"))
+                output.imageType = ImageType::MSDF;
+            else if (ARG_IS("mtsdf"))
+                output.imageType = ImageType::MTSDF;
+            else
+                ABORT("Invalid additional atlas type. Valid types are: hardmask, softmask, sdf, psdf, msdf, mtsdf");
+            output.imageFilename = argv[argPos+1];
+            config.additionalOutputs.push_back(output);
+            argPos += 2;
+            continue;
+        }
         ARG_CASE("-json", 1) {
             config.jsonFilename = argv[argPos++];
             continue;
@@ -558,11 +874,23 @@ int main(int argc, const char *const *argv) {
             config.csvFilename = argv[argPos++];
             continue;
         }
+        ARG_CASE("-binmetrics", 1) {
+            config.binaryMetricsFilename = argv[argPos++];
+            continue;
+        }
+        ARG_CASE("-compactmetrics", 0) {
+            compactMetrics = true;
+            continue;
+        }
         ARG_CASE("-shadronpreview", 2) {
             config.shadronPreviewFilename = argv[argPos++];
             config.shadronPreviewText = argv[argPos++];
             continue;
         }
+        ARG_CASE("-glyphprofile", 1) {
+            config.glyphProfileFilename = argv[argPos++];
+            continue;
+        }
         ARG_CASE("-dimensions", 2) {
             unsigned w, h;
             if (!(parseUnsigned(w, argv[argPos++]) && parseUnsigned(h, argv[argPos++]) && w && h))
@@ -595,6 +923,32 @@ int main(int argc, const char *const *argv) {
             fixedWidth = -1, fixedHeight = -1;
             continue;
         }
+        ARG_CASE("-packer", 1) {
+            if (ARG_IS("guillotine"))
+                packingAlgorithm = PackingAlgorithm::GUILLOTINE;
+            else if (ARG_IS("maxrects"))
+                packingAlgorithm = PackingAlgorithm::MAX_RECTS;
+            else if (ARG_IS("skyline"))
+                packingAlgorithm = PackingAlgorithm::SKYLINE;
+            else if (ARG_IS("shelf"))
+                packingAlgorithm = PackingAlgorithm::SHELF;
+            else
+                ABORT("Unknown packing algorithm. Use -packer with one of: guillotine, maxrects, skyline, or shelf.");
+            ++argPos;
+            continue;
+        }
+        ARG_CASE("-rotate", 0) {
+            allowRotation = true;
+            continue;
+        }
+        ARG_CASE("-dedup", 0) {
+            deduplicateGlyphs = true;
+            continue;
+        }
+        ARG_CASE("-incremental", 1) {
+            incrementalCacheFilename = argv[argPos++];
+            continue;
+        }
         ARG_CASE("-yorigin", 1) {
             if (ARG_IS("bottom"))
                 config.yDirection = msdfgen::Y_UPWARD;
@@ -612,6 +966,24 @@ int main(int argc, const char *const *argv) {
             config.emSize = s;
             continue;
         }
+        ARG_CASE("-sizes", 1) {
+            emSizes.clear();
+            for (const char *sizeList = argv[argPos++]; *sizeList;) {
+                double s;
+                int skip = 0;
+                if (!(sscanf(sizeList, "%lf%n", &s, &skip) == 1 && s > 0 && (sizeList[skip] == ',' || !sizeList[skip])))
+                    ABORT("Invalid em size list. Use -sizes <em size>,<em size>,... with positive real numbers.");
+                emSizes.push_back(s);
+                sizeList += skip+(sizeList[skip] == ',');
+            }
+            if (emSizes.empty())
+                ABORT("Invalid em size list. Use -sizes <em size>,<em size>,... with positive real numbers.");
+            continue;
+        }
+        ARG_CASE("-smallsizesfirst", 0) {
+            smallSizesFirst = true;
+            continue;
+        }
         ARG_CASE("-minsize", 1) {
             double s;
             if (!(parseDouble(s, argv[argPos++]) && s > 0))
@@ -894,11 +1266,31 @@ int main(int argc, const char *const *argv) {
             config.generatorAttributes.scanlinePass = true;
             continue;
         }
+        ARG_CASE("-adaptive", 0) {
+            config.generatorAttributes.adaptiveQuality = true;
+            continue;
+        }
+        ARG_CASE("-sparse", 0) {
+            config.generatorAttributes.sparse = true;
+            continue;
+        }
+        ARG_CASE("-edgeindex", 0) {
+            config.generatorAttributes.edgeIndex = true;
+            continue;
+        }
         ARG_CASE("-seed", 1) {
             if (!parseUnsignedLL(config.coloringSeed, argv[argPos++]))
                 ABORT("Invalid seed. Use -seed <N> with N being a non-negative integer.");
             continue;
         }
+        ARG_CASE("-legacyseed", 0) {
+            config.legacyColoringSeed = true;
+            continue;
+        }
+        ARG_CASE("-coloringcache", 1) {
+            coloringCacheFilename = argv[argPos++];
+            continue;
+        }
         ARG_CASE("-threads", 1) {
             unsigned tc;
             if (!(parseUnsigned(tc, argv[argPos++]) && (int) tc >= 0))
@@ -906,6 +1298,12 @@ int main(int argc, const char *const *argv) {
             config.threadCount = (int) tc;
             continue;
         }
+        ARG_CASE("-stats", 1) {
+            // Only reached from a batch job, since main handles -stats for the whole run
+            fputs("Warning: -stats is ignored in batch jobs, specify it along with -batch to cover the whole batch.\n", stderr);
+            ++argPos;
+            continue;
+        }
         ARG_CASE("-version", 0) {
             puts(versionText);
             return 0;
@@ -935,11 +1333,11 @@ int main(int argc, const char *const *argv) {
     }
     if (!fontInput.fontFilename)
         ABORT("No font specified.");
-    if (!(config.arteryFontFilename || config.imageFilename || config.jsonFilename || config.csvFilename || config.shadronPreviewFilename)) {
+    if (!(config.arteryFontFilename || config.imageFilename || !config.additionalOutputs.empty() || config.jsonFilename || config.csvFilename || config.binaryMetricsFilename || config.shadronPreviewFilename || config.glyphProfileFilename)) {
         fputs("No output specified.\n", stderr);
         return 0;
     }
-    bool layoutOnly = !(config.arteryFontFilename || config.imageFilename);
+    bool layoutOnly = !(config.arteryFontFilename || config.imageFilename || !config.additionalOutputs.empty() || config.glyphProfileFilename);
 
     // Finalize font inputs
     const FontInput *nextFontInput = &fontInput;
@@ -961,22 +1359,49 @@ int main(int argc, const char *const *argv) {
     // Fix up configuration based on related values
     if (packingStyle == PackingStyle::TIGHT && atlasSizeConstraint == DimensionsConstraint::NONE)
         atlasSizeConstraint = DimensionsConstraint::MULTIPLE_OF_FOUR_SQUARE;
-    if (!(config.imageType == ImageType::PSDF || config.imageType == ImageType::MSDF || config.imageType == ImageType::MTSDF))
+    // The layout is shared by additional atlas types, so it must suit all of them
+    bool anyMultiChannel = config.imageType == ImageType::MSDF || config.imageType == ImageType::MTSDF;
+    bool anyPseudoDistance = config.imageType == ImageType::PSDF || anyMultiChannel;
+    for (const AdditionalAtlasOutput &output : config.additionalOutputs) {
+        anyMultiChannel |= output.imageType == ImageType::MSDF || output.imageType == ImageType::MTSDF;
+        anyPseudoDistance |= output.imageType == ImageType::PSDF || output.imageType == ImageType::MSDF || output.imageType == ImageType::MTSDF;
+    }
+    if (!anyPseudoDistance)
         config.miterLimit = 0;
+    if (config.generatorAttributes.edgeIndex && config.generatorAttributes.config.overlapSupport) {
+        fputs("Warning: Edge index is not available with overlap support, ignoring.\n", stderr);
+        config.generatorAttributes.edgeIndex = false;
+    }
     if (config.emSize > minEmSize)
         minEmSize = config.emSize;
-    if (!(fixedWidth > 0 && fixedHeight > 0) && !(fixedCellWidth > 0 && fixedCellHeight > 0) && !(minEmSize > 0)) {
+    if (!emSizes.empty()) {
+        if (packingStyle != PackingStyle::TIGHT)
+            ABORT("Atlas sets (-sizes) are only available for tight packing.");
+        if (incrementalCacheFilename) {
+            fputs("Warning: Incremental build is not available for atlas sets (-sizes), ignoring.\n", stderr);
+            incrementalCacheFilename = nullptr;
+        }
+        if (config.shadronPreviewFilename) {
+            fputs("Warning: Shadron preview is not available for atlas sets (-sizes), ignoring.\n", stderr);
+            config.shadronPreviewFilename = nullptr;
+        }
+    } else if (!(fixedWidth > 0 && fixedHeight > 0) && !(fixedCellWidth > 0 && fixedCellHeight > 0) && !(minEmSize > 0)) {
         fputs("Neither atlas size nor glyph size selected, using default...\n", stderr);
         minEmSize = DEFAULT_SIZE;
     }
     if (config.imageType == ImageType::HARD_MASK || config.imageType == ImageType::SOFT_MASK) {
+        // The range of mask types is fixed and shared by additional atlas types, which would make distance fields useless
+        for (const AdditionalAtlasOutput &output : config.additionalOutputs) {
+            if (!(output.imageType == ImageType::HARD_MASK || output.imageType == ImageType::SOFT_MASK))
+                ABORT("Distance field types cannot be added with -typeout to a hardmask or softmask atlas. Select the distance field type with -type and the mask with -typeout instead.");
+        }
         rangeUnits = Units::PIXELS;
         rangeValue = 1;
     } else if (rangeValue.lower == rangeValue.upper) {
         rangeUnits = Units::PIXELS;
         rangeValue = DEFAULT_PIXEL_RANGE;
     }
-    if (config.kerning && !(config.arteryFontFilename || config.jsonFilename || config.shadronPreviewFilename))
+    if (config.kerning && !(config.arteryFontFilename || config.jsonFilename || config.binaryMetricsFilename || config.shadronPreviewFilename))
         config.kerning = false;
     if (config.threadCount <= 0)
         config.threadCount = std::max((int) std::thread::hardware_concurrency(), 1);
@@ -1027,14 +1452,14 @@ int main(int argc, const char *const *argv) {
         }
     }
 #ifndef MSDF_ATLAS_NO_ARTERY_FONT
-    if (config.arteryFontFilename && !(config.imageFormat == ImageFormat::PNG || config.imageFormat == ImageFormat::BINARY || config.imageFormat == ImageFormat::BINARY_FLOAT)) {
+    if (config.arteryFontFilename && !(config.imageFormat == ImageFormat::PNG || config.imageFormat == ImageFormat::PNG16 || config.imageFormat == ImageFormat::BINARY || config.imageFormat == ImageFormat::BINARY_FLOAT)) {
         config.arteryFontFilename = nullptr;
         result = 1;
         fputs("Error: Unable to create an Artery Font file with the specified image format!\n", stderr);
         // Recheck whether there is anything else to do
-        if (!(config.arteryFontFilename || config.imageFilename || config.jsonFilename || config.csvFilename || config.shadronPreviewFilename))
+        if (!(config.arteryFontFilename || config.imageFilename || !config.additionalOutputs.empty() || config.jsonFilename || config.csvFilename || config.binaryMetricsFilename || config.shadronPreviewFilename || config.glyphProfileFilename))
             return result;
-        layoutOnly = !(config.arteryFontFilename || config.imageFilename);
+        layoutOnly = !(config.arteryFontFilename || config.imageFilename || !config.additionalOutputs.empty() || config.glyphProfileFilename);
     }
 #endif
     if (imageExtension != ImageFormat::UNSPECIFIED) {
@@ -1044,7 +1469,13 @@ int main(int argc, const char *const *argv) {
             case ImageFormat::TEXT: case ImageFormat::TEXT_FLOAT:
                 mismatch = imageExtension != ImageFormat::TEXT;
                 break;
-            case ImageFormat::BINARY: case ImageFormat::BINARY_FLOAT: case ImageFormat::BINARY_FLOAT_BE:
+            case ImageFormat::PNG16:
+                mismatch = imageExtension != ImageFormat::PNG;
+                break;
+            case ImageFormat::TIFF_HALF: case ImageFormat::TIFF16:
+                mismatch = imageExtension != ImageFormat::TIFF;
+                break;
+            case ImageFormat::BINARY: case ImageFormat::BINARY_FLOAT: case ImageFormat::BINARY_FLOAT_BE: case ImageFormat::BINARY_HALF:
                 mismatch = imageExtension != ImageFormat::BINARY;
                 break;
             default:
@@ -1059,10 +1490,14 @@ int main(int argc, const char *const *argv) {
         config.imageFormat == ImageFormat::FL32 ||
         config.imageFormat == ImageFormat::TEXT_FLOAT ||
         config.imageFormat == ImageFormat::BINARY_FLOAT ||
-        config.imageFormat == ImageFormat::BINARY_FLOAT_BE
+        config.imageFormat == ImageFormat::BINARY_FLOAT_BE ||
+        config.imageFormat == ImageFormat::TIFF_HALF ||
+        config.imageFormat == ImageFormat::BINARY_HALF
     );
+    bool halfFormat = config.imageFormat == ImageFormat::TIFF_HALF || config.imageFormat == ImageFormat::BINARY_HALF;
+    bool uint16Format = config.imageFormat == ImageFormat::PNG16 || config.imageFormat == ImageFormat::TIFF16;
     // TODO: In this case (if spacing is -1), the border pixels of each glyph are black, but still computed. For floating-point output, this may play a role.
-    int spacing = config.imageType == ImageType::MSDF || config.imageType == ImageType::MTSDF ? 0 : -1;
+    int spacing = anyMultiChannel ? 0 : -1;
     double uniformOriginX, uniformOriginY;
 
     // Load fonts
@@ -1070,42 +1505,14 @@ int main(int argc, const char *const *argv) {
     std::vector<FontGeometry> fonts;
     bool anyCodepointsAvailable = false;
     {
-        class FontHolder {
-            msdfgen::FreetypeHandle *ft;
-            msdfgen::FontHandle *font;
-            const char *fontFilename;
-        public:
-            FontHolder() : ft(msdfgen::initializeFreetype()), font(nullptr), fontFilename(nullptr) { }
-            ~FontHolder() {
-                if (ft) {
-                    if (font)
-                        msdfgen::destroyFont(font);
-                    msdfgen::deinitializeFreetype(ft);
-                }
-            }
-            bool load(const char *fontFilename, bool isVarFont) {
-                if (ft && fontFilename) {
-                    if (this->fontFilename && !strcmp(this->fontFilename, fontFilename))
-                        return true;
-                    if (font)
-                        msdfgen::destroyFont(font);
-                    if ((font = (
-                        #ifndef MSDFGEN_DISABLE_VARIABLE_FONTS
-                            isVarFont ? loadVarFont(ft, fontFilename) :
-                        #endif
-                        msdfgen::loadFont(ft, fontFilename)
-                    ))) {
-                        this->fontFilename = fontFilename;
-                        return true;
-                    }
-                    this->fontFilename = nullptr;
-                }
-                return false;
-            }
-            operator msdfgen::FontHandle *() const {
-                return font;
-            }
-        } font;
+        // Fonts shared by batch jobs are accessed by one job at a time
+        std::unique_ptr<FontHolder> localFonts;
+        std::unique_lock<std::mutex> fontLock;
+        if (batch)
+            fontLock = std::unique_lock<std::mutex>(batch->fontMutex);
+        else
+            localFonts.reset(new FontHolder);
+        FontHolder &font = batch ? batch->fonts : *localFonts;
 
         for (FontInput &fontInput : fontInputs) {
             if (!font.load(fontInput.fontFilename, fontInput.variableFont))
@@ -1183,38 +1590,312 @@ int main(int argc, const char *const *argv) {
     if (glyphs.empty())
         ABORT("No glyphs loaded.");
 
-    // Determine final atlas dimensions, scale and range, pack glyphs
-    {
-        msdfgen::Range emRange = 0, pxRange = 0;
-        switch (rangeUnits) {
-            case Units::EMS:
-                emRange = rangeValue;
-                break;
-            case Units::PIXELS:
-                pxRange = rangeValue;
-                break;
+    // Edge coloring - done before packing so that incremental builds can detect changed colors
+    if (!layoutOnly && anyMultiChannel) {
+        // Glyph seeds depend only on the glyph's index, so that its colors don't change when other glyphs are added or removed
+        std::vector<unsigned long long> glyphSeeds(glyphs.size());
+        if (config.legacyColoringSeed && !config.expensiveColoring) {
+            unsigned long long glyphSeed = config.coloringSeed;
+            for (unsigned long long &seed : glyphSeeds)
+                seed = glyphSeed = nextLegacyColoringSeed(glyphSeed);
+        } else {
+            for (size_t i = 0; i < glyphs.size(); ++i) {
+                unsigned long long key = config.legacyColoringSeed ? (unsigned long long) i : (unsigned long long) glyphs[i].getIndex();
+                glyphSeeds[i] = glyphColoringSeed(config.coloringSeed, key);
+            }
         }
-        Padding innerEmPadding, outerEmPadding;
-        Padding innerPxPadding, outerPxPadding;
-        switch (innerPaddingUnits) {
-            case Units::EMS:
-                innerEmPadding = innerPadding;
-                break;
-            case Units::PIXELS:
-                innerPxPadding = innerPadding;
-                break;
+
+        EdgeColoringCache coloringCache = { };
+        std::vector<unsigned long long> coloringKeys;
+        bool reuseColoringCache = false;
+        if (coloringCacheFilename) {
+            unsigned long long settingsHash = 0;
+            int coloringStrategy = config.edgeColoring == &msdfgen::edgeColoringSimple ? 0 : config.edgeColoring == &msdfgen::edgeColoringInkTrap ? 1 : 2;
+            hashAtlasSettings(settingsHash, &coloringStrategy, sizeof(coloringStrategy));
+            hashAtlasSettings(settingsHash, &config.angleThreshold, sizeof(config.angleThreshold));
+            reuseColoringCache = loadEdgeColoringCache(coloringCache, coloringCacheFilename) && coloringCache.settingsHash == settingsHash;
+            coloringCache.settingsHash = settingsHash;
+            coloringKeys.resize(glyphs.size());
         }
-        switch (outerPaddingUnits) {
-            case Units::EMS:
-                outerEmPadding = outerPadding;
-                break;
-            case Units::PIXELS:
-                outerPxPadding = outerPadding;
-                break;
+
+        Workload([&glyphs, &config, &glyphSeeds, &coloringCache, &coloringKeys, reuseColoringCache](int i, int) -> bool {
+            if (!coloringKeys.empty()) {
+                coloringKeys[i] = edgeColoringKey(glyphs[i], glyphSeeds[i]);
+                if (reuseColoringCache) {
+                    std::unordered_map<unsigned long long, std::vector<byte> >::const_iterator it = coloringCache.glyphs.find(coloringKeys[i]);
+                    if (it != coloringCache.glyphs.end() && glyphs[i].setEdgeColors(it->second.data(), (int) it->second.size()))
+                        return true;
+                }
+            }
+            glyphs[i].edgeColoring(config.edgeColoring, config.angleThreshold, glyphSeeds[i]);
+            return true;
+        }, glyphs.size()).finish(config.threadCount);
+
+        if (coloringCacheFilename) {
+            coloringCache.glyphs.clear();
+            for (size_t i = 0; i < glyphs.size(); ++i) {
+                std::vector<byte> &colors = coloringCache.glyphs[coloringKeys[i]];
+                colors.clear();
+                for (const msdfgen::Contour &contour : glyphs[i].getShape().contours) {
+                    for (const msdfgen::EdgeHolder &edge : contour.edges)
+                        colors.push_back((byte) edge->color);
+                }
+            }
+            if (!saveEdgeColoringCache(coloringCache, coloringCacheFilename))
+                fputs("Failed to save edge coloring cache.\n", stderr);
         }
-        bool fixedDimensions = fixedWidth >= 0 && fixedHeight >= 0;
+    }
+
+    // Range and padding in their respective units
+    msdfgen::Range emRange = 0, pxRange = 0;
+    switch (rangeUnits) {
+        case Units::EMS:
+            emRange = rangeValue;
+            break;
+        case Units::PIXELS:
+            pxRange = rangeValue;
+            break;
+    }
+    Padding innerEmPadding, outerEmPadding;
+    Padding innerPxPadding, outerPxPadding;
+    switch (innerPaddingUnits) {
+        case Units::EMS:
+            innerEmPadding = innerPadding;
+            break;
+        case Units::PIXELS:
+            innerPxPadding = innerPadding;
+            break;
+    }
+    switch (outerPaddingUnits) {
+        case Units::EMS:
+            outerEmPadding = outerPadding;
+            break;
+        case Units::PIXELS:
+            outerPxPadding = outerPadding;
+            break;
+    }
+    bool fixedDimensions = fixedWidth >= 0 && fixedHeight >= 0;
+
+    // Atlas set - each size packs, generates and saves its own copy of the shared glyph geometry, with multiple sizes processed concurrently
+    if (!emSizes.empty()) {
+        struct SizeAtlas {
+            double emSize;
+            std::vector<GlyphGeometry> glyphs;
+            std::vector<FontGeometry> fonts;
+            Configuration config;
+            std::string imageFilename, arteryFontFilename, csvFilename, binaryMetricsFilename, glyphProfileFilename;
+            std::vector<std::string> additionalImageFilenames;
+            bool packed, success;
+        };
+        std::vector<SizeAtlas> atlases(emSizes.size());
+        std::vector<int> schedule(emSizes.size());
+        for (size_t i = 0; i < emSizes.size(); ++i) {
+            atlases[i].emSize = emSizes[i];
+            atlases[i].packed = false, atlases[i].success = false;
+            schedule[i] = (int) i;
+        }
+        // Larger sizes take longer, so starting with them balances the load, unless feedback from the small sizes is preferred
+        std::stable_sort(schedule.begin(), schedule.end(), [&emSizes, smallSizesFirst](int a, int b) -> bool {
+            return smallSizesFirst ? emSizes[a] < emSizes[b] : emSizes[a] > emSizes[b];
+        });
+        int concurrentSizes = std::min(config.threadCount, (int) emSizes.size());
+        int threadsPerSize = std::max(config.threadCount/concurrentSizes, 1);
+        Workload([&](int i, int) -> bool {
+            SizeAtlas &atlas = atlases[schedule[i]];
+            atlas.glyphs = glyphs;
+            atlas.fonts.reserve(fonts.size());
+            for (const FontGeometry &font : fonts)
+                atlas.fonts.push_back(FontGeometry(font, &atlas.glyphs));
+
+            TightAtlasPacker atlasPacker;
+            if (fixedDimensions)
+                atlasPacker.setDimensions(fixedWidth, fixedHeight);
+            else
+                atlasPacker.setDimensionsConstraint(atlasSizeConstraint);
+            atlasPacker.setPackingAlgorithm(packingAlgorithm);
+            atlasPacker.setRotation(allowRotation);
+            atlasPacker.setDeduplication(deduplicateGlyphs);
+            atlasPacker.setSpacing(spacing);
+            atlasPacker.setScale(atlas.emSize);
+            atlasPacker.setPixelRange(pxRange);
+            atlasPacker.setUnitRange(emRange);
+            atlasPacker.setMiterLimit(config.miterLimit);
+            atlasPacker.setOriginPixelAlignment(config.pxAlignOriginX, config.pxAlignOriginY);
+            atlasPacker.setInnerUnitPadding(innerEmPadding);
+            atlasPacker.setOuterUnitPadding(outerEmPadding);
+            atlasPacker.setInnerPixelPadding(innerPxPadding);
+            atlasPacker.setOuterPixelPadding(outerPxPadding);
+            if (int remaining = atlasPacker.pack(atlas.glyphs.data(), atlas.glyphs.size())) {
+                if (remaining < 0)
+                    fprintf(stderr, "Failed to pack glyphs into atlas of size %.9g.\n", atlas.emSize);
+                else
+                    fprintf(stderr, "Error: Could not fit %d out of %d glyphs into the atlas of size %.9g.\n", remaining, (int) atlas.glyphs.size(), atlas.emSize);
+                return true;
+            }
+            atlas.config = config;
+            atlasPacker.getDimensions(atlas.config.width, atlas.config.height);
+            atlas.config.emSize = atlasPacker.getScale();
+            atlas.config.pxRange = atlasPacker.getPixelRange();
+            atlas.config.threadCount = threadsPerSize;
+            atlas.packed = true;
+            printf("Atlas dimensions for size %.9g pixels/em: %d x %d\n", atlas.emSize, atlas.config.width, atlas.config.height);
+
+            // Output file names are distinguished by the size
+            if (config.imageFilename)
+                atlas.config.imageFilename = (atlas.imageFilename = sizeFilename(config.imageFilename, atlas.emSize)).c_str();
+            if (config.arteryFontFilename)
+                atlas.config.arteryFontFilename = (atlas.arteryFontFilename = sizeFilename(config.arteryFontFilename, atlas.emSize)).c_str();
+            if (config.csvFilename)
+                atlas.config.csvFilename = (atlas.csvFilename = sizeFilename(config.csvFilename, atlas.emSize)).c_str();
+            if (config.binaryMetricsFilename)
+                atlas.config.binaryMetricsFilename = (atlas.binaryMetricsFilename = sizeFilename(config.binaryMetricsFilename, atlas.emSize)).c_str();
+            if (config.glyphProfileFilename)
+                atlas.config.glyphProfileFilename = (atlas.glyphProfileFilename = sizeFilename(config.glyphProfileFilename, atlas.emSize)).c_str();
+            atlas.additionalImageFilenames.resize(config.additionalOutputs.size());
+            for (size_t j = 0; j < config.additionalOutputs.size(); ++j)
+                atlas.config.additionalOutputs[j].imageFilename = (atlas.additionalImageFilenames[j] = sizeFilename(config.additionalOutputs[j].imageFilename, atlas.emSize)).c_str();
+
+            atlas.success = layoutOnly || makeAtlas(atlas.glyphs, atlas.fonts, atlas.config, floatingPointFormat, halfFormat, uint16Format, nullptr);
+            if (atlas.config.csvFilename) {
+                if (exportCSV(atlas.fonts.data(), atlas.fonts.size(), atlas.config.width, atlas.config.height, atlas.config.yDirection, atlas.config.csvFilename, compactMetrics))
+                    fputs("Glyph layout written into CSV file.\n", stderr);
+                else {
+                    atlas.success = false;
+                    fputs("Failed to write CSV output file.\n", stderr);
+                }
+            }
+            if (atlas.config.binaryMetricsFilename) {
+                BinaryMetricsExportProperties binaryMetricsProps = { };
+                binaryMetricsProps.imageType = atlas.config.imageType;
+                binaryMetricsProps.distanceRange = atlas.config.pxRange;
+                binaryMetricsProps.size = atlas.config.emSize;
+                binaryMetricsProps.width = atlas.config.width, binaryMetricsProps.height = atlas.config.height;
+                binaryMetricsProps.yDirection = atlas.config.yDirection;
+                binaryMetricsProps.kerning = atlas.config.kerning;
+                if (exportBinaryMetrics(atlas.fonts.data(), atlas.fonts.size(), atlas.config.binaryMetricsFilename, binaryMetricsProps))
+                    fputs("Glyph layout and metadata written into binary metrics file.\n", stderr);
+                else {
+                    atlas.success = false;
+                    fputs("Failed to write binary metrics output file.\n", stderr);
+                }
+            }
+            return true;
+        }, (int) emSizes.size()).finish(concurrentSizes);
+
+        for (const SizeAtlas &atlas : atlases) {
+            if (!atlas.success)
+                result = 1;
+        }
+        if (config.jsonFilename) {
+            std::vector<JsonAtlasSetEntry> jsonAtlases;
+            for (const SizeAtlas &atlas : atlases) {
+                if (atlas.packed) {
+                    JsonAtlasSetEntry jsonAtlas = { };
+                    jsonAtlas.fonts = atlas.fonts.data();
+                    jsonAtlas.fontCount = (int) atlas.fonts.size();
+                    jsonAtlas.metrics.distanceRange = atlas.config.pxRange;
+                    jsonAtlas.metrics.size = atlas.config.emSize;
+                    jsonAtlas.metrics.width = atlas.config.width, jsonAtlas.metrics.height = atlas.config.height;
+                    jsonAtlas.metrics.yDirection = atlas.config.yDirection;
+                    jsonAtlases.push_back(jsonAtlas);
+                }
+            }
+            if (exportJSONAtlasSet(jsonAtlases.data(), jsonAtlases.size(), config.imageType, config.jsonFilename, config.kerning, compactMetrics))
+                fputs("Glyph layouts and metadata of all sizes written into JSON file.\n", stderr);
+            else {
+                result = 1;
+                fputs("Failed to write JSON output file.\n", stderr);
+            }
+        }
+        return result;
+    }
+
+    // Incremental build - identify each glyph by its font, index, codepoint, geometry and edge colors
+    IncrementalBuild incremental = { };
+    IncrementalBuild *incrementalBuild = nullptr;
+    std::vector<IncrementalAtlasCache::Glyph> glyphKeys;
+    unsigned long long settingsHash = 0;
+    if (incrementalCacheFilename) {
+        if (layoutOnly || packingStyle != PackingStyle::TIGHT)
+            fputs("Warning: Incremental build is only available for tight packing with atlas image or Artery Font output, ignoring.\n", stderr);
+        else {
+            incrementalBuild = &incremental;
+            #define HASH_SETTING(value) hashAtlasSettings(settingsHash, &(value), sizeof(value))
+            HASH_SETTING(config.imageType);
+            HASH_SETTING(floatingPointFormat);
+            HASH_SETTING(halfFormat);
+            HASH_SETTING(uint16Format);
+            HASH_SETTING(config.emSize);
+            HASH_SETTING(minEmSize);
+            HASH_SETTING(fixedWidth), HASH_SETTING(fixedHeight);
+            HASH_SETTING(atlasSizeConstraint);
+            HASH_SETTING(rangeUnits);
+            HASH_SETTING(rangeValue.lower), HASH_SETTING(rangeValue.upper);
+            HASH_SETTING(innerPaddingUnits);
+            HASH_SETTING(innerPadding.l), HASH_SETTING(innerPadding.b), HASH_SETTING(innerPadding.r), HASH_SETTING(innerPadding.t);
+            HASH_SETTING(outerPaddingUnits);
+            HASH_SETTING(outerPadding.l), HASH_SETTING(outerPadding.b), HASH_SETTING(outerPadding.r), HASH_SETTING(outerPadding.t);
+            HASH_SETTING(config.miterLimit);
+            HASH_SETTING(config.pxAlignOriginX), HASH_SETTING(config.pxAlignOriginY);
+            HASH_SETTING(spacing);
+            HASH_SETTING(config.generatorAttributes.config.overlapSupport);
+            HASH_SETTING(config.generatorAttributes.config.errorCorrection.mode);
+            HASH_SETTING(config.generatorAttributes.config.errorCorrection.distanceCheckMode);
+            HASH_SETTING(config.generatorAttributes.config.errorCorrection.minDeviationRatio);
+            HASH_SETTING(config.generatorAttributes.config.errorCorrection.minImproveRatio);
+            HASH_SETTING(config.generatorAttributes.scanlinePass);
+            HASH_SETTING(config.generatorAttributes.adaptiveQuality);
+            HASH_SETTING(config.generatorAttributes.sparse);
+            #undef HASH_SETTING
+            glyphKeys.resize(glyphs.size());
+            for (int i = 0; i < (int) fonts.size(); ++i) {
+                for (const GlyphGeometry &glyph : fonts[i].getGlyphs()) {
+                    IncrementalAtlasCache::Glyph &key = glyphKeys[&glyph-glyphs.data()];
+                    key.font = i;
+                    key.index = glyph.getIndex();
+                    key.codepoint = glyph.getCodepoint();
+                    key.hash = hashGlyphGeometry(glyph, true);
+                }
+            }
+            incremental.reuseCache = loadIncrementalAtlasCache(incremental.cache, incrementalCacheFilename) && incremental.cache.settingsHash == settingsHash;
+        }
+    }
+
+    // Determine final atlas dimensions, scale and range, pack glyphs
+    {
         bool fixedScale = config.emSize > 0;
-        switch (packingStyle) {
+        if (incremental.reuseCache) {
+            // Keep the previous scale, range and dimensions and only pack added or changed glyphs into the free space
+            const IncrementalAtlasCache &cache = incremental.cache;
+            GlyphGeometry::GlyphAttributes attribs = { };
+            attribs.scale = cache.emSize;
+            attribs.range = emRange+pxRange/cache.emSize;
+            attribs.innerPadding = innerEmPadding+innerPxPadding/cache.emSize;
+            attribs.outerPadding = outerEmPadding+outerPxPadding/cache.emSize;
+            attribs.miterLimit = config.miterLimit;
+            attribs.pxAlignOriginX = config.pxAlignOriginX;
+            attribs.pxAlignOriginY = config.pxAlignOriginY;
+            for (GlyphGeometry &glyph : glyphs) {
+                if (!glyph.isWhitespace())
+                    glyph.wrapBox(attribs);
+            }
+            std::vector<int> duplicateOf;
+            if (deduplicateGlyphs) {
+                duplicateOf.resize(glyphs.size());
+                if (!findDuplicateGlyphs(duplicateOf.data(), glyphs.data(), glyphs.size()))
+                    duplicateOf.clear();
+            }
+            if (!packIncrementally(incremental.changedGlyphs, glyphs.data(), glyphKeys.data(), duplicateOf.empty() ? nullptr : duplicateOf.data(), glyphs.size(), cache, spacing, packingAlgorithm, allowRotation)) {
+                config.width = cache.width, config.height = cache.height;
+                config.emSize = cache.emSize;
+                config.pxRange = cache.pxRange;
+                printf("Incremental build: %d glyphs added or changed\n", (int) incremental.changedGlyphs.size());
+            } else {
+                fputs("Added glyphs do not fit into the previous atlas, performing full build.\n", stderr);
+                incremental.reuseCache = false;
+            }
+        }
+        if (!incremental.reuseCache) switch (packingStyle) {
 
             case PackingStyle::TIGHT: {
                 TightAtlasPacker atlasPacker;
@@ -1222,6 +1903,9 @@ int main(int argc, const char *const *argv) {
                     atlasPacker.setDimensions(fixedWidth, fixedHeight);
                 else
                     atlasPacker.setDimensionsConstraint(atlasSizeConstraint);
+                atlasPacker.setPackingAlgorithm(packingAlgorithm);
+                atlasPacker.setRotation(allowRotation);
+                atlasPacker.setDeduplication(deduplicateGlyphs);
                 atlasPacker.setSpacing(spacing);
                 if (fixedScale)
                     atlasPacker.setScale(config.emSize);
@@ -1281,6 +1965,7 @@ int main(int argc, const char *const *argv) {
                 atlasPacker.setOuterUnitPadding(outerEmPadding);
                 atlasPacker.setInnerPixelPadding(innerPxPadding);
                 atlasPacker.setOuterPixelPadding(outerPxPadding);
+                atlasPacker.setThreadCount(config.threadCount);
                 if (int remaining = atlasPacker.pack(glyphs.data(), glyphs.size())) {
                     if (remaining < 0) {
                         ABORT("Failed to pack glyphs into atlas.");
@@ -1328,66 +2013,44 @@ int main(int argc, const char *const *argv) {
         }
     }
 
-    // Generate atlas bitmap
-    if (!layoutOnly) {
-
-        // Edge coloring
-        if (config.imageType == ImageType::MSDF || config.imageType == ImageType::MTSDF) {
-            if (config.expensiveColoring) {
-                Workload([&glyphs, &config](int i, int threadNo) -> bool {
-                    unsigned long long glyphSeed = (LCG_MULTIPLIER*(config.coloringSeed^i)+LCG_INCREMENT)*!!config.coloringSeed;
-                    glyphs[i].edgeColoring(config.edgeColoring, config.angleThreshold, glyphSeed);
-                    return true;
-                }, glyphs.size()).finish(config.threadCount);
-            } else {
-                unsigned long long glyphSeed = config.coloringSeed;
-                for (GlyphGeometry &glyph : glyphs) {
-                    glyphSeed *= LCG_MULTIPLIER;
-                    glyph.edgeColoring(config.edgeColoring, config.angleThreshold, glyphSeed);
-                }
+    // Record the layout for the next incremental build
+    if (incrementalBuild) {
+        IncrementalAtlasCache &cache = incremental.cache;
+        cache.settingsHash = settingsHash;
+        cache.emSize = config.emSize;
+        cache.pxRange = config.pxRange;
+        cache.width = config.width, cache.height = config.height;
+        cache.glyphs.clear();
+        for (size_t i = 0; i < glyphs.size(); ++i) {
+            if (!glyphs[i].isWhitespace()) {
+                IncrementalAtlasCache::Glyph record = glyphKeys[i];
+                Rectangle rect = glyphs[i].getBoxRect();
+                record.x = rect.x, record.y = rect.y;
+                glyphs[i].getBoxSize(record.w, record.h);
+                record.rotated = glyphs[i].isBoxRotated();
+                cache.glyphs.push_back(record);
             }
         }
+    }
 
-        bool success = false;
-        switch (config.imageType) {
-            case ImageType::HARD_MASK:
-                if (floatingPointFormat)
-                    success = makeAtlas<float, float, 1, scanlineGenerator>(glyphs, fonts, config);
-                else
-                    success = makeAtlas<byte, float, 1, scanlineGenerator>(glyphs, fonts, config);
-                break;
-            case ImageType::SOFT_MASK:
-            case ImageType::SDF:
-                if (floatingPointFormat)
-                    success = makeAtlas<float, float, 1, sdfGenerator>(glyphs, fonts, config);
-                else
-                    success = makeAtlas<byte, float, 1, sdfGenerator>(glyphs, fonts, config);
-                break;
-            case ImageType::PSDF:
-                if (floatingPointFormat)
-                    success = makeAtlas<float, float, 1, psdfGenerator>(glyphs, fonts, config);
-                else
-                    success = makeAtlas<byte, float, 1, psdfGenerator>(glyphs, fonts, config);
-                break;
-            case ImageType::MSDF:
-                if (floatingPointFormat)
-                    success = makeAtlas<float, float, 3, msdfGenerator>(glyphs, fonts, config);
-                else
-                    success = makeAtlas<byte, float, 3, msdfGenerator>(glyphs, fonts, config);
-                break;
-            case ImageType::MTSDF:
-                if (floatingPointFormat)
-                    success = makeAtlas<float, float, 4, mtsdfGenerator>(glyphs, fonts, config);
-                else
-                    success = makeAtlas<byte, float, 4, mtsdfGenerator>(glyphs, fonts, config);
-                break;
-        }
+    // Generate atlas bitmap
+    if (!layoutOnly) {
+
+        bool success = makeAtlas(glyphs, fonts, config, floatingPointFormat, halfFormat, uint16Format, incrementalBuild);
         if (!success)
             result = 1;
+        else if (incrementalBuild) {
+            if (saveIncrementalAtlasCache(incremental.cache, incrementalCacheFilename))
+                fputs("Incremental build cache saved.\n", stderr);
+            else {
+                result = 1;
+                fputs("Failed to save incremental build cache.\n", stderr);
+            }
+        }
     }
 
     if (config.csvFilename) {
-        if (exportCSV(fonts.data(), fonts.size(), config.width, config.height, config.yDirection, config.csvFilename))
+        if (exportCSV(fonts.data(), fonts.size(), config.width, config.height, config.yDirection, config.csvFilename, compactMetrics))
             fputs("Glyph layout written into CSV file.\n", stderr);
         else {
             result = 1;
@@ -1412,7 +2075,7 @@ int main(int argc, const char *const *argv) {
             gridMetrics.spacing = spacing;
             jsonMetrics.grid = &gridMetrics;
         }
-        if (exportJSON(fonts.data(), fonts.size(), config.imageType, jsonMetrics, config.jsonFilename, config.kerning))
+        if (exportJSON(fonts.data(), fonts.size(), config.imageType, jsonMetrics, config.jsonFilename, config.kerning, compactMetrics))
             fputs("Glyph layout and metadata written into JSON file.\n", stderr);
         else {
             result = 1;
@@ -1420,6 +2083,22 @@ int main(int argc, const char *const *argv) {
         }
     }
 
+    if (config.binaryMetricsFilename) {
+        BinaryMetricsExportProperties binaryMetricsProps = { };
+        binaryMetricsProps.imageType = config.imageType;
+        binaryMetricsProps.distanceRange = config.pxRange;
+        binaryMetricsProps.size = config.emSize;
+        binaryMetricsProps.width = config.width, binaryMetricsProps.height = config.height;
+        binaryMetricsProps.yDirection = config.yDirection;
+        binaryMetricsProps.kerning = config.kerning;
+        if (exportBinaryMetrics(fonts.data(), fonts.size(), config.binaryMetricsFilename, binaryMetricsProps))
+            fputs("Glyph layout and metadata written into binary metrics file.\n", stderr);
+        else {
+            result = 1;
+            fputs("Failed to write binary metrics output file.\n", stderr);
+        }
+    }
+
     if (config.shadronPreviewFilename && config.shadronPreviewText) {
         if (anyCodepointsAvailable) {
             std::vector<unicode_t> previewText;
@@ -1438,6 +2117,145 @@ int main(int argc, const char *const *argv) {
     }
 
     return result;
+    #undef ABORT
+}
+
+/// Splits a line of the jobs file into arguments separated by whitespace, which may be enclosed in double quotes (with \" and \\ escapes)
+static void splitJobArguments(std::vector<std::string> &args, const char *line) {
+    while (true) {
+        while (*line == ' ' || *line == '\t' || *line == '\r' || *line == '\n')
+            ++line;
+        if (!*line)
+            break;
+        std::string arg;
+        bool quoted = false;
+        for (; *line && (quoted || !(*line == ' ' || *line == '\t' || *line == '\r' || *line == '\n')); ++line) {
+            if (*line == '"')
+                quoted = !quoted;
+            else if (quoted && *line == '\\' && (line[1] == '"' || line[1] == '\\'))
+                arg.push_back(*++line);
+            else
+                arg.push_back(*line);
+        }
+        args.push_back((std::string &&) arg);
+    }
+}
+
+/// Runs the jobs from jobsFilename, commonArgs (starting with the program name) are prepended to the arguments of each job
+static int runBatch(const char *jobsFilename, std::vector<const char *> commonArgs) {
+    struct Job {
+        int line;
+        std::vector<std::string> args;
+        int result;
+        double time;
+    };
+
+    // The thread count of the batch determines how many jobs run at the same time
+    int threadCount = 0;
+    for (size_t i = 1; i+1 < commonArgs.size(); ++i) {
+        if (!strcmp(commonArgs[i], "-threads") || !strcmp(commonArgs[i], "--threads")) {
+            unsigned tc;
+            if (!parseUnsigned(tc, commonArgs[i+1])) {
+                fputs("Invalid thread count. Use -threads <N> with N being a non-negative integer.\n", stderr);
+                return 1;
+            }
+            threadCount = (int) tc;
+            commonArgs.erase(commonArgs.begin()+i, commonArgs.begin()+i+2);
+            break;
+        }
+    }
+    if (threadCount <= 0)
+        threadCount = std::max((int) std::thread::hardware_concurrency(), 1);
+
+    // Read jobs file - each non-empty line not starting with # is a job
+    std::vector<Job> jobs;
+    {
+        FILE *f = fopen(jobsFilename, "r");
+        if (!f) {
+            fputs("Failed to open batch jobs file.\n", stderr);
+            return 1;
+        }
+        std::string line;
+        int lineNo = 0;
+        for (int c = 0; c != EOF;) {
+            line.clear();
+            while ((c = fgetc(f)) != EOF && c != '\n')
+                line.push_back((char) c);
+            ++lineNo;
+            Job job = { };
+            job.line = lineNo;
+            splitJobArguments(job.args, line.c_str());
+            if (!job.args.empty() && job.args.front()[0] != '#')
+                jobs.push_back((Job &&) job);
+        }
+        fclose(f);
+    }
+    if (jobs.empty()) {
+        fputs("No jobs in batch jobs file.\n", stderr);
+        return 1;
+    }
+
+    // Jobs are picked up by whichever worker becomes idle first, so small jobs fill the gaps while large ones run
+    BatchResources resources;
+    std::chrono::steady_clock::time_point batchStart = std::chrono::steady_clock::now();
+    Workload([&jobs, &commonArgs, &resources](int i, int) -> bool {
+        Job &job = jobs[i];
+        std::vector<const char *> argv(commonArgs);
+        for (const std::string &arg : job.args)
+            argv.push_back(arg.c_str());
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        job.result = runJob((int) argv.size(), argv.data(), &resources);
+        job.time = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+        fprintf(stderr, "Job on line %d %s in %.3f s.\n", job.line, job.result ? "failed" : "finished", job.time);
+        return true;
+    }, (int) jobs.size()).finish(threadCount);
+    double batchTime = std::chrono::duration<double>(std::chrono::steady_clock::now()-batchStart).count();
+
+    int failedJobs = 0;
+    for (const Job &job : jobs)
+        failedJobs += job.result != 0;
+    printf("Batch of %d jobs finished in %.3f s", (int) jobs.size(), batchTime);
+    if (failedJobs)
+        printf(", %d failed", failedJobs);
+    printf(".\n");
+    return failedJobs ? 1 : 0;
+}
+
+static int run(const std::vector<const char *> &args) {
+    for (size_t i = 1; i+1 < args.size(); ++i) {
+        if (!strcmp(args[i], "-batch") || !strcmp(args[i], "--batch")) {
+            std::vector<const char *> commonArgs(args);
+            commonArgs.erase(commonArgs.begin()+i, commonArgs.begin()+i+2);
+            return runBatch(args[i+1], (std::vector<const char *> &&) commonArgs);
+        }
+    }
+    return runJob((int) args.size(), args.data(), nullptr);
+}
+
+int main(int argc, const char *const *argv) {
+    // Statistics are collected for the whole run, which may be a batch of jobs
+    std::vector<const char *> args(argv, argv+argc);
+    const char *statsFilename = nullptr;
+    for (size_t i = 1; i+1 < args.size(); ++i) {
+        if (!strcmp(args[i], "-stats") || !strcmp(args[i], "--stats")) {
+            statsFilename = args[i+1];
+            args.erase(args.begin()+i, args.begin()+i+2);
+            break;
+        }
+    }
+    if (!statsFilename)
+        return run(args);
+    Instrumentation::setEnabled(true);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    int result = run(args);
+    double wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+    if (Instrumentation::exportJSON(statsFilename, wallTime))
+        fputs("Statistics written into JSON file.\n", stderr);
+    else {
+        result = 1;
+        fputs("Failed to write statistics file.\n", stderr);
+    }
+    return result;
 }
 
 #endif
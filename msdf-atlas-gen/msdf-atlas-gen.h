@@ -12,16 +12,21 @@
 #include <msdfgen-ext.h>
 
 #include "types.h"
+#include "half-float.h"
+#include "uint16-pixels.h"
 #include "utf8.h"
 #include "Rectangle.h"
 #include "Padding.h"
 #include "Charset.h"
 #include "GlyphBox.h"
 #include "GlyphGeometry.h"
+#include "GlyphEdgeIndex.h"
 #include "FontGeometry.h"
+#include "glyph-deduplication.h"
 #include "RectanglePacker.h"
 #include "rectangle-packing.h"
 #include "Workload.h"
+#include "Instrumentation.h"
 #include "size-selectors.h"
 #include "bitmap-blit.h"
 #include "AtlasStorage.h"
@@ -30,11 +35,21 @@
 #include "GridAtlasPacker.h"
 #include "AtlasGenerator.h"
 #include "ImmediateAtlasGenerator.h"
+#include "AsyncAtlasGenerator.h"
 #include "DynamicAtlas.h"
+#include "DynamicAtlasBatcher.h"
+#include "LazyFontAtlas.h"
 #include "glyph-generators.h"
+#include "glyph-complexity.h"
 #include "image-encode.h"
 #include "image-save.h"
+#include "TextFileWriter.h"
 #include "artery-font-export.h"
 #include "csv-export.h"
 #include "json-export.h"
+#include "binary-metrics.h"
+#include "binary-metrics-export.h"
+#include "incremental-atlas.h"
+#include "edge-coloring-cache.h"
+#include "edge-coloring-seed.h"
 #include "shadron-preview-generator.h"
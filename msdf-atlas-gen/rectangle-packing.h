@@ -2,17 +2,18 @@
 #pragma once
 
 #include <utility>
+#include "types.h"
 #include "Rectangle.h"
 
 namespace msdf_atlas {
 
 /// Packs the rectangle array into an atlas with fixed dimensions, returns how many didn't fit (0 on success)
 template <typename RectangleType>
-int packRectangles(RectangleType *rectangles, int count, int width, int height, int spacing = 0);
+int packRectangles(RectangleType *rectangles, int count, int width, int height, int spacing = 0, PackingAlgorithm algorithm = PackingAlgorithm::GUILLOTINE);
 
 /// Packs the rectangle array into an atlas of unknown size, returns the minimum required dimensions constrained by SizeSelector
 template <class SizeSelector, typename RectangleType>
-std::pair<int, int> packRectangles(RectangleType *rectangles, int count, int spacing = 0);
+std::pair<int, int> packRectangles(RectangleType *rectangles, int count, int spacing = 0, PackingAlgorithm algorithm = PackingAlgorithm::GUILLOTINE);
 
 }
 
@@ -18,13 +18,13 @@ static void copyRectanglePlacement(OrientedRectangle &dst, const OrientedRectang
 }
 
 template <typename RectangleType>
-int packRectangles(RectangleType *rectangles, int count, int width, int height, int spacing) {
+int packRectangles(RectangleType *rectangles, int count, int width, int height, int spacing, PackingAlgorithm algorithm) {
     if (spacing)
         for (int i = 0; i < count; ++i) {
             rectangles[i].w += spacing;
             rectangles[i].h += spacing;
         }
-    int result = RectanglePacker(width+spacing, height+spacing).pack(rectangles, count);
+    int result = RectanglePacker(width+spacing, height+spacing, algorithm).pack(rectangles, count);
     if (spacing)
         for (int i = 0; i < count; ++i) {
             rectangles[i].w -= spacing;
@@ -34,7 +34,7 @@ int packRectangles(RectangleType *rectangles, int count, int width, int height,
 }
 
 template <class SizeSelector, typename RectangleType>
-std::pair<int, int> packRectangles(RectangleType *rectangles, int count, int spacing) {
+std::pair<int, int> packRectangles(RectangleType *rectangles, int count, int spacing, PackingAlgorithm algorithm) {
     std::vector<RectangleType> rectanglesCopy(count);
     int totalArea = 0;
     for (int i = 0; i < count; ++i) {
@@ -46,7 +46,7 @@ std::pair<int, int> packRectangles(RectangleType *rectangles, int count, int spa
     SizeSelector sizeSelector(totalArea);
     int width, height;
     while (sizeSelector(width, height)) {
-        if (!RectanglePacker(width+spacing, height+spacing).pack(rectanglesCopy.data(), count)) {
+        if (!RectanglePacker(width+spacing, height+spacing, algorithm).pack(rectanglesCopy.data(), count)) {
             dimensions.first = width;
             dimensions.second = height;
             for (int i = 0; i < count; ++i)
@@ -142,14 +142,25 @@ bool generateShadronPreview(const FontGeometry *fonts, int fontCount, ImageType
                         pl *= fsScale, pb *= fsScale, pr *= fsScale, pt *= fsScale;
                         pl += x, pb += y, pr += x, pt += y;
                         il *= texelWidth, ib *= texelHeight, ir *= texelWidth, it *= texelHeight;
-                        fprintf(file, "    %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g,\n",
-                            pl, pb, il, ib,
-                            pr, pb, ir, ib,
-                            pl, pt, il, it,
-                            pr, pt, ir, it,
-                            pl, pt, il, it,
-                            pr, pb, ir, ib
-                        );
+                        if (glyph->isBoxRotated()) {
+                            fprintf(file, "    %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g,\n",
+                                pl, pb, ir, ib,
+                                pr, pb, ir, it,
+                                pl, pt, il, ib,
+                                pr, pt, il, it,
+                                pl, pt, il, ib,
+                                pr, pb, ir, it
+                            );
+                        } else {
+                            fprintf(file, "    %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g,\n",
+                                pl, pb, il, ib,
+                                pr, pb, ir, ib,
+                                pl, pt, il, it,
+                                pr, pt, ir, it,
+                                pl, pt, il, it,
+                                pr, pb, ir, ib
+                            );
+                        }
                     }
                     double advance = glyph->getAdvance();
                     fonts[i].getAdvance(advance, cp[0], cp[1]);
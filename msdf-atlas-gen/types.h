@@ -3,11 +3,27 @@
 
 #include <cstdint>
 
+/// Nonzero if the host stores multi-byte values with the most significant byte first
+#ifndef MSDF_ATLAS_BIG_ENDIAN
+    #if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__)
+        #define MSDF_ATLAS_BIG_ENDIAN (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    #elif defined(__BIG_ENDIAN__)
+        #define MSDF_ATLAS_BIG_ENDIAN 1
+    #else
+        #define MSDF_ATLAS_BIG_ENDIAN 0
+    #endif
+#endif
+
 namespace msdf_atlas {
 
 typedef unsigned char byte;
 typedef uint32_t unicode_t;
 
+/// IEEE 754 half-precision floating-point pixel value stored as its bit pattern
+struct half {
+    uint16_t bits;
+};
+
 /// Type of atlas image contents
 enum class ImageType {
     /// Rendered glyphs without anti-aliasing (two colors only)
@@ -36,7 +52,15 @@ enum class ImageFormat {
     TEXT_FLOAT,
     BINARY,
     BINARY_FLOAT,
-    BINARY_FLOAT_BE
+    BINARY_FLOAT_BE,
+    /// Half-precision floating-point TIFF
+    TIFF_HALF,
+    /// Raw half-precision floating-point values in native byte order
+    BINARY_HALF,
+    /// PNG with 16 bits per sample
+    PNG16,
+    /// TIFF with 16-bit unsigned integer samples
+    TIFF16
 };
 
 /// Glyph identification
@@ -51,6 +75,28 @@ enum class PackingStyle {
     GRID
 };
 
+/// The algorithm used to pack glyph boxes into the atlas
+enum class PackingAlgorithm {
+    /// Guillotine splitting of free space, best short side fit among all remaining boxes
+    GUILLOTINE,
+    /// Maximal free rectangles, best short side fit - densest but slowest
+    MAX_RECTS,
+    /// Skyline, bottom-left placement
+    SKYLINE,
+    /// Shelves, next fit - fastest, suitable for online packing
+    SHELF
+};
+
+/// Complexity of a glyph's shape, which determines how much post-processing of its distance field is necessary (see classifyGlyphComplexity)
+enum class GlyphComplexity {
+    /// A single convex contour - needs neither error correction nor the scanline pass
+    SIMPLE,
+    /// No intersecting edges and few edges and corners - needs no scanline pass and only fast error correction
+    MODERATE,
+    /// Generated with the full configured quality
+    COMPLEX
+};
+
 /// Constraints for the atlas's dimensions - see size selectors for more info
 enum class DimensionsConstraint {
     NONE,
@@ -0,0 +1,40 @@
+
+#include "uint16-pixels.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace msdf_atlas {
+
+uint16_t pixelFloatToUint16(float x) {
+    // Also maps NaN to zero
+    x = x > 0.f ? (x < 1.f ? x : 1.f) : 0.f;
+    return uint16_t(65535.f*x+.5f);
+}
+
+float pixelUint16ToFloat(uint16_t x) {
+    return 1.f/65535.f*float(x);
+}
+
+void convertFloatToUint16(uint16_t *dst, const float *src, size_t count) {
+    size_t i = 0;
+#ifdef __SSE2__
+    const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.f), scale = _mm_set1_ps(65535.f), half = _mm_set1_ps(.5f);
+    const __m128i bias = _mm_set1_epi32(32768), signBit = _mm_set1_epi16(-32768);
+    for (; i+8 <= count; i += 8) {
+        // max returns its second operand (zero) for NaN
+        __m128 a = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src+i), zero), one);
+        __m128 b = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src+i+4), zero), one);
+        __m128i qa = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(a, scale), half));
+        __m128i qb = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(b, scale), half));
+        // SSE2 only has a signed saturating pack - shift the values into the signed range and back
+        __m128i packed = _mm_packs_epi32(_mm_sub_epi32(qa, bias), _mm_sub_epi32(qb, bias));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst+i), _mm_xor_si128(packed, signBit));
+    }
+#endif
+    for (; i < count; ++i)
+        dst[i] = pixelFloatToUint16(src[i]);
+}
+
+}
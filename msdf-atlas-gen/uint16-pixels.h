@@ -0,0 +1,17 @@
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace msdf_atlas {
+
+/// Quantizes a floating-point pixel value in the range [0, 1] to a 16-bit integer, clamping values out of range
+uint16_t pixelFloatToUint16(float x);
+/// Converts a 16-bit integer pixel value to floating-point in the range [0, 1]
+float pixelUint16ToFloat(uint16_t x);
+
+/// Quantizes an array of floating-point values to 16-bit integers, using SSE2 if available
+void convertFloatToUint16(uint16_t *dst, const float *src, size_t count);
+
+}